@@ -105,7 +105,7 @@ void BVH::linearize(LinearNode *list, int p, BVHNode *node) {
     list[p].lr = {GLfloat(l), GLfloat(r), 0};
 }
 
-GLuint *BVH::getLinearBVH(GLsizei &size) {
+LinearNode *BVH::getLinearBVH(GLsizei &size) {
     if (bvh == nullptr) {
         size = 0;
         return nullptr;
@@ -125,6 +125,37 @@ GLuint *BVH::getLinearBVH(GLsizei &size) {
 //    exit(0);
 
     size = (GLsizei)(bvh->size * sizeof(LinearNode));
-    return (GLuint *)buf;
+    return buf;
 }
 
+bool BVH::hit(const LinearNode *list, const Patch *patches, const Ray &r, HitInfo &hit) {
+    return hitBVH(list, patches, r, hit);
+}
+
+QuadBlock *BVH::packLeaves(LinearNode *list, GLsizei num, const Patch *patches, int &block_num) {
+    block_num = 0;
+    for (int i = 0; i < num; i++) {
+        int n = (int)list[i].ni.x;
+        if (n > 0) block_num += (n + KERNEL_WIDTH - 1) / KERNEL_WIDTH;
+    }
+
+    auto blocks = new QuadBlock[block_num];
+    int k = 0;
+    for (int i = 0; i < num; i++) {
+        int n = (int)list[i].ni.x, m = (int)list[i].ni.y;
+        if (n <= 0) continue;
+        list[i].ni.z = GLfloat(k);
+        //面片数多于块宽度时拆分为连续的多个块
+        for (int j = 0; j < n; j += KERNEL_WIDTH)
+            blocks[k++].set(patches + m + j, std::min(n - j, KERNEL_WIDTH));
+    }
+    return blocks;
+}
+
+bool BVH::hitBlocks(const LinearNode *list, const QuadBlock *blocks, const Ray &r, HitInfo &hit) {
+    return hitBVHBlocks(list, blocks, r, hit);
+}
+
+int BVH::hit4(const LinearNode *list, const Patch *patches, const RayPacket &p, __m128 &t, __m128i &idx) {
+    return hitBVH4(list, patches, p, t, idx);
+}
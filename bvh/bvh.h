@@ -3,6 +3,8 @@
 #include <vector>
 
 #include "config/config.h"
+#include "simd/simd.h"
+#include "simd/kernel.h"
 
 struct BVHNode {
     BVHNode *left = nullptr;
@@ -18,7 +20,7 @@ struct LinearNode {
     Vector3f AA{};
     Vector3f BB{};
     Vector3f lr{};
-    Vector3f ni{};
+    Vector3f ni{}; //面片数、首个面片编号、首个叶子块编号（仅CPU端打包后使用）
 };
 
 class BVH {
@@ -37,5 +39,15 @@ private:
 
 public:
     BVH(std::vector<Patch> &patches, GLsizei num, int max_node);
-    GLuint *getLinearBVH(GLsizei &size);
+    LinearNode *getLinearBVH(GLsizei &size);
+
+    //在线性化的BVH树中求最近交点，遍历方式与tracer.frag一致
+    //三种遍历均按当前指令集调用simd/kernel_impl.h中的实现
+    static bool hit(const LinearNode *list, const Patch *patches, const Ray &r, HitInfo &hit);
+    //将每个叶子的面片打包为SoA叶子块，块编号写入ni.z，num为结点数
+    static QuadBlock *packLeaves(LinearNode *list, GLsizei num, const Patch *patches, int &block_num);
+    //使用叶子块遍历BVH树，结果与hit一致
+    static bool hitBlocks(const LinearNode *list, const QuadBlock *blocks, const Ray &r, HitInfo &hit);
+    //光线包整包遍历BVH树，t与idx按光线记录最近交点及面片编号，返回更新的光线掩码
+    static int hit4(const LinearNode *list, const Patch *patches, const RayPacket &p, __m128 &t, __m128i &idx);
 };
\ No newline at end of file
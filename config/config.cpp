@@ -2,105 +2,48 @@
 
 #include <cmath>
 
-GLfloat degToRad(GLfloat deg) {
-    return PI * deg / 180.0f;
-}
-
-GLfloat radToDeg(GLfloat rad) {
-    return rad / PI * 180.0f;
-}
-
-Vector3f normalize(const Vector3f &src) {
-    float len = std::sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-    return {src.x / len, src.y / len, src.z / len};
-}
-
-Vector2f normalize(const Vector2f &src) {
-    float len = std::sqrt(src.x * src.x + src.y * src.y);
-    return {src.x / len, src.y / len};
-}
-
-GLfloat length(const Vector3f &src) {
-    return std::sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-}
-
-GLfloat length(const Vector2f &src) {
-    return std::sqrt(src.x * src.x + src.y * src.y);
-}
-
-Vector2f operator+(const Vector2f &a, const Vector2f &b) {
-    return {a.x + b.x, a.y + b.y};
-}
-
-Vector3f operator+(const Vector3f &a, const Vector3f &b) {
-    return {a.x + b.x, a.y + b.y, a.z + b.z};
-}
-
-void operator+=(Vector2f &dst, const Vector2f &src) {
-    dst.x += src.x;
-    dst.y += src.y;
-}
-
-void operator+=(Vector3f &dst, const Vector3f &src) {
-    dst.x += src.x;
-    dst.y += src.y;
-    dst.z += src.z;
-}
-
-Vector2f operator-(const Vector2f &a, const Vector2f &b) {
-    return {a.x - b.x, a.y - b.y};
-}
-
-Vector3f operator-(const Vector3f &a, const Vector3f &b) {
-    return {a.x - b.x, a.y - b.y, a.z - b.z};
-}
-
-void operator-=(Vector2f &dst, const Vector2f &src) {
-    dst.x -= src.x;
-    dst.y -= src.y;
-}
-
-void operator-=(Vector3f &dst, const Vector3f &src) {
-    dst.x -= src.x;
-    dst.y -= src.y;
-    dst.z -= src.z;
-}
-
-Vector2f operator*(const Vector2f &a, GLfloat b) {
-    return {a.x * b, a.y * b};
-}
-
-Vector3f operator*(const Vector3f &a, GLfloat b) {
-    return {a.x * b, a.y * b, a.z * b};
-}
-
-void operator*=(Vector2f &dst, GLfloat src) {
-    dst.x *= src;
-    dst.y *= src;
-}
-
-void operator*=(Vector3f &dst, GLfloat src) {
-    dst.x *= src;
-    dst.y *= src;
-    dst.z *= src;
-}
-
-bool operator==(const Vector2f &a, const Vector2f &b) {
-    return (a.x == b.x && a.y == b.y);
-}
-
-bool operator==(const Vector3f &a, const Vector3f &b) {
-    return (a.x == b.x && a.y == b.y && a.z == b.z);
-}
-
-GLfloat operator*(const Vector3f &a, const Vector3f &b) {
-    return a.x * b.x + a.y * b.y + a.z * b.z;
+bool hitQuad(const Ray &r, const Vector3f *samples, HitInfo &hit) {
+    //求光线与平面交点
+    Vector3f n1 = samples[1] - samples[0];
+    Vector3f n2 = samples[2] - samples[0];
+    Vector3f normal = normalize(n1 & n2);
+    GLfloat d = -(samples[0] * normal);
+    GLfloat m = r.direction * normal;
+    if (m >= -ERR) return false; //剔除背向面
+    GLfloat t = -(d + r.startPoint * normal) / m;
+    if (t <= ERR) return false; //剔除与自身相交的情况
+    Vector3f P = r.startPoint + r.direction * t;
+
+    //根据叉乘与法矢量的方向关系判断是否在四边形内
+    Vector3f n3 = P - samples[0];
+    Vector3f n4 = P - samples[1];
+    Vector3f n5 = P - samples[2];
+    GLfloat f1 = (n1 & n3) * normal;
+    GLfloat f2 = (n3 & n2) * normal;
+    GLfloat f3 = (n5 & n1) * normal;
+    GLfloat f4 = (n2 & n4) * normal;
+
+    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {
+        hit.distance = t;
+        hit.hitPoint = P;
+        hit.normal = normal;
+        return true;
+    }
+    return false;
 }
 
-Vector3f operator&(const Vector3f &src, const Vector3f &dst) {
-    return {src.y * dst.z - src.z * dst.y,
-            src.z * dst.x - src.x * dst.z,
-            src.x * dst.y - src.y * dst.x};
+GLfloat hitAABB(const Ray &r, const Vector3f &AA, const Vector3f &BB) {
+    GLfloat t1 = INF, t2 = -INF;
+    const GLfloat *o = &r.startPoint.x, *d = &r.direction.x, *a = &AA.x, *b = &BB.x;
+    for (int i = 0; i < 3; i++) {
+        GLfloat m = (b[i] - o[i]) / d[i];
+        GLfloat n = (a[i] - o[i]) / d[i];
+        t1 = std::fmin(t1, std::fmax(m, n));
+        t2 = std::fmax(t2, std::fmin(m, n));
+    }
+    //起点位于盒内时进入距离记为0
+    if (t1 < t2 || t1 <= ERR) return -1.0f;
+    return t2 > 0.0f ? t2 : 0.0f;
 }
 
 std::ostream &operator<<(std::ostream &out, const Vector3f &src) {
@@ -108,15 +51,7 @@ std::ostream &operator<<(std::ostream &out, const Vector3f &src) {
     return out;
 }
 
-Matrix4f operator*(Matrix4f &a, Matrix4f &b) {
-    Matrix4f ret{};
-    for (int i = 0; i < 4; i++)
-        for (int j = 0; j < 4; j++)
-            ret[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
-    return ret;
-}
-
-std::ostream &operator<<(std::ostream &out, Matrix4f &mat) {
+std::ostream &operator<<(std::ostream &out, const Matrix4f &mat) {
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++)
             out << mat[i][j] << " ";
@@ -8,30 +8,15 @@
 #include <cmath>
 #include "GL/glew.h"
 
+#include "config/vecmath.h"
+
 #define PI 3.141593f
+#define INF 114514.0f
+#define ERR 0.0001f
 
 #define ORI_WIDTH 500
 #define ORI_HEIGHT 500
 
-typedef struct vector2f {
-    GLfloat x, y;
-} Vector2f;
-
-typedef struct vector3f {
-    GLfloat x, y, z;
-} Vector3f;
-
-typedef struct vector4f {
-    GLfloat x, y, z, a;
-} Vector4f;
-
-typedef struct matrix4f {
-    GLfloat mat[16];
-    GLfloat *operator[](int r) {
-        return &mat[r * 4];
-    }
-} Matrix4f;
-
 typedef struct patch {
     Vector3f samples[4];
     Vector3f normal;
@@ -42,49 +27,30 @@ typedef struct ray {
     vector3f startPoint;
 } Ray;
 
-//角度/弧度转换
-GLfloat degToRad(GLfloat deg);
-GLfloat radToDeg(GLfloat rad);
-
-//归一化
-Vector3f normalize(const Vector3f &src);
-Vector2f normalize(const Vector2f &src);
-
-//求长度
-GLfloat length(const Vector3f &src);
-GLfloat length(const Vector2f &src);
-
-//加
-Vector2f operator+(const Vector2f &a, const Vector2f &b);
-Vector3f operator+(const Vector3f &a, const Vector3f &b);
-void operator+=(Vector2f &dst, const Vector2f &src);
-void operator+=(Vector3f &dst, const Vector3f &src);
-
-//减
-Vector2f operator-(const Vector2f &a, const Vector2f &b);
-Vector3f operator-(const Vector3f &a, const Vector3f &b);
-void operator-=(Vector2f &dst, const Vector2f &src);
-void operator-=(Vector3f &dst, const Vector3f &src);
+//击中信息：与tracer.frag中的HitInfo对应
+typedef struct hitInfo {
+    GLfloat distance;
+    Vector3f hitPoint;
+    Vector3f normal;
+    int id;      //击中模型的编号，未击中为-1
+    Vector2f uv; //击中点的纹理坐标
+} HitInfo;
 
-//乘
-Vector2f operator*(const Vector2f &a, GLfloat b);
-Vector3f operator*(const Vector3f &a, GLfloat b);
-void operator*=(Vector2f &dst, GLfloat src);
-void operator*=(Vector3f &dst, GLfloat src);
+//角度/弧度转换
+inline constexpr GLfloat degToRad(GLfloat deg) {
+    return PI * deg / 180.0f;
+}
 
-//相等
-bool operator==(const Vector2f &a, const Vector2f &b);
-bool operator==(const Vector3f &a, const Vector3f &b);
+inline constexpr GLfloat radToDeg(GLfloat rad) {
+    return rad / PI * 180.0f;
+}
 
-//点积
-GLfloat operator*(const Vector3f &a, const Vector3f &b);
-//叉积
-Vector3f operator&(const Vector3f &src, const Vector3f &dst);
+//光线与四边形求交，与tracer.frag中的hitQuad一致
+bool hitQuad(const Ray &r, const Vector3f *samples, HitInfo &hit);
+//光线与AABB包围盒求交，返回进入距离，未击中返回-1
+GLfloat hitAABB(const Ray &r, const Vector3f &AA, const Vector3f &BB);
 
 //三维矩阵输出
 std::ostream &operator<<(std::ostream &out, const Vector3f &src);
-
-//四维矩阵乘法
-Matrix4f operator*(Matrix4f &a, Matrix4f &b);
 //四维矩阵输出
-std::ostream &operator<<(std::ostream &out, Matrix4f &mat);
+std::ostream &operator<<(std::ostream &out, const Matrix4f &mat);
@@ -0,0 +1,262 @@
+/********************************************
+ * 此文件定义了向量、矩阵类型及其运算
+ * 全部运算在头文件中内联，标量运算可用于常量表达式，
+ * 四维向量与矩阵运算使用SSE，批量运算使用SoA布局
+ * 八通道的批量运算见simd/floatx8.h
+ *******************************************/
+
+#pragma once
+
+#include <cmath>
+#include <emmintrin.h>
+
+#include "GL/glew.h"
+
+typedef struct vector2f {
+    GLfloat x, y;
+} Vector2f;
+
+typedef struct vector3f {
+    GLfloat x, y, z;
+} Vector3f;
+
+typedef struct vector4f {
+    GLfloat x, y, z, a;
+} Vector4f;
+
+typedef struct matrix4f {
+    GLfloat mat[16];
+    GLfloat *operator[](int r) {
+        return &mat[r * 4];
+    }
+    const GLfloat *operator[](int r) const {
+        return &mat[r * 4];
+    }
+} Matrix4f;
+
+//上传到GL的数据依赖以下内存布局
+static_assert(sizeof(Vector2f) == 2 * sizeof(GLfloat), "Vector2f must be tightly packed");
+static_assert(sizeof(Vector3f) == 3 * sizeof(GLfloat), "Vector3f must be tightly packed");
+static_assert(sizeof(Vector4f) == 4 * sizeof(GLfloat), "Vector4f must be tightly packed");
+static_assert(sizeof(Matrix4f) == 16 * sizeof(GLfloat), "Matrix4f must be tightly packed");
+
+/*****************************************************
+ * 二维、三维向量：标量实现
+ *****************************************************/
+
+//加
+inline constexpr Vector2f operator+(const Vector2f &a, const Vector2f &b) {
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline constexpr Vector3f operator+(const Vector3f &a, const Vector3f &b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline constexpr void operator+=(Vector2f &dst, const Vector2f &src) {
+    dst.x += src.x;
+    dst.y += src.y;
+}
+
+inline constexpr void operator+=(Vector3f &dst, const Vector3f &src) {
+    dst.x += src.x;
+    dst.y += src.y;
+    dst.z += src.z;
+}
+
+//减
+inline constexpr Vector2f operator-(const Vector2f &a, const Vector2f &b) {
+    return {a.x - b.x, a.y - b.y};
+}
+
+inline constexpr Vector3f operator-(const Vector3f &a, const Vector3f &b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline constexpr void operator-=(Vector2f &dst, const Vector2f &src) {
+    dst.x -= src.x;
+    dst.y -= src.y;
+}
+
+inline constexpr void operator-=(Vector3f &dst, const Vector3f &src) {
+    dst.x -= src.x;
+    dst.y -= src.y;
+    dst.z -= src.z;
+}
+
+//乘
+inline constexpr Vector2f operator*(const Vector2f &a, GLfloat b) {
+    return {a.x * b, a.y * b};
+}
+
+inline constexpr Vector3f operator*(const Vector3f &a, GLfloat b) {
+    return {a.x * b, a.y * b, a.z * b};
+}
+
+inline constexpr void operator*=(Vector2f &dst, GLfloat src) {
+    dst.x *= src;
+    dst.y *= src;
+}
+
+inline constexpr void operator*=(Vector3f &dst, GLfloat src) {
+    dst.x *= src;
+    dst.y *= src;
+    dst.z *= src;
+}
+
+//相等
+inline constexpr bool operator==(const Vector2f &a, const Vector2f &b) {
+    return (a.x == b.x && a.y == b.y);
+}
+
+inline constexpr bool operator==(const Vector3f &a, const Vector3f &b) {
+    return (a.x == b.x && a.y == b.y && a.z == b.z);
+}
+
+//点积
+inline constexpr GLfloat operator*(const Vector3f &a, const Vector3f &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//叉积
+inline constexpr Vector3f operator&(const Vector3f &src, const Vector3f &dst) {
+    return {src.y * dst.z - src.z * dst.y,
+            src.z * dst.x - src.x * dst.z,
+            src.x * dst.y - src.y * dst.x};
+}
+
+//求长度
+inline GLfloat length(const Vector3f &src) {
+    return std::sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
+}
+
+inline GLfloat length(const Vector2f &src) {
+    return std::sqrt(src.x * src.x + src.y * src.y);
+}
+
+//归一化
+inline Vector3f normalize(const Vector3f &src) {
+    GLfloat len = length(src);
+    return {src.x / len, src.y / len, src.z / len};
+}
+
+inline Vector2f normalize(const Vector2f &src) {
+    GLfloat len = length(src);
+    return {src.x / len, src.y / len};
+}
+
+/*****************************************************
+ * 四维向量与矩阵：SSE实现
+ *****************************************************/
+
+inline __m128 load(const Vector4f &v) {
+    return _mm_loadu_ps(&v.x);
+}
+
+inline Vector4f store(__m128 v) {
+    Vector4f ret;
+    _mm_storeu_ps(&ret.x, v);
+    return ret;
+}
+
+inline Vector4f operator+(const Vector4f &a, const Vector4f &b) {
+    return store(_mm_add_ps(load(a), load(b)));
+}
+
+inline Vector4f operator-(const Vector4f &a, const Vector4f &b) {
+    return store(_mm_sub_ps(load(a), load(b)));
+}
+
+inline Vector4f operator*(const Vector4f &a, GLfloat b) {
+    return store(_mm_mul_ps(load(a), _mm_set1_ps(b)));
+}
+
+inline void operator+=(Vector4f &dst, const Vector4f &src) {
+    dst = dst + src;
+}
+
+inline void operator-=(Vector4f &dst, const Vector4f &src) {
+    dst = dst - src;
+}
+
+inline void operator*=(Vector4f &dst, GLfloat src) {
+    dst = dst * src;
+}
+
+//点积
+inline GLfloat operator*(const Vector4f &a, const Vector4f &b) {
+    __m128 m = _mm_mul_ps(load(a), load(b));
+    m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(m);
+}
+
+//四维矩阵乘法：结果的每一行是b各行以a对应行元素为系数的线性组合
+inline Matrix4f operator*(const Matrix4f &a, const Matrix4f &b) {
+    Matrix4f ret;
+    __m128 b0 = _mm_loadu_ps(b[0]), b1 = _mm_loadu_ps(b[1]);
+    __m128 b2 = _mm_loadu_ps(b[2]), b3 = _mm_loadu_ps(b[3]);
+    for (int i = 0; i < 4; i++) {
+        __m128 r = _mm_mul_ps(_mm_set1_ps(a[i][0]), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[i][1]), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[i][2]), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[i][3]), b3));
+        _mm_storeu_ps(ret[i], r);
+    }
+    return ret;
+}
+
+//矩阵与列向量相乘
+inline Vector4f operator*(const Matrix4f &a, const Vector4f &v) {
+    return {a[0][0] * v.x + a[0][1] * v.y + a[0][2] * v.z + a[0][3] * v.a,
+            a[1][0] * v.x + a[1][1] * v.y + a[1][2] * v.z + a[1][3] * v.a,
+            a[2][0] * v.x + a[2][1] * v.y + a[2][2] * v.z + a[2][3] * v.a,
+            a[3][0] * v.x + a[3][1] * v.y + a[3][2] * v.z + a[3][3] * v.a};
+}
+
+/*****************************************************
+ * 批量三维向量：SoA布局，每个分量存放4个向量
+ *****************************************************/
+
+struct Vector3fx4 {
+    __m128 x, y, z;
+
+    Vector3fx4() = default;
+    Vector3fx4(__m128 x, __m128 y, __m128 z): x(x), y(y), z(z) {}
+    //将同一个向量广播到所有通道
+    explicit Vector3fx4(const Vector3f &v): x(_mm_set1_ps(v.x)), y(_mm_set1_ps(v.y)), z(_mm_set1_ps(v.z)) {}
+    //由4个AoS布局的向量转置得到
+    Vector3fx4(const Vector3f &a, const Vector3f &b, const Vector3f &c, const Vector3f &d):
+            x(_mm_setr_ps(a.x, b.x, c.x, d.x)),
+            y(_mm_setr_ps(a.y, b.y, c.y, d.y)),
+            z(_mm_setr_ps(a.z, b.z, c.z, d.z)) {}
+};
+
+inline Vector3fx4 operator+(const Vector3fx4 &a, const Vector3fx4 &b) {
+    return {_mm_add_ps(a.x, b.x), _mm_add_ps(a.y, b.y), _mm_add_ps(a.z, b.z)};
+}
+
+inline Vector3fx4 operator-(const Vector3fx4 &a, const Vector3fx4 &b) {
+    return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+}
+
+inline Vector3fx4 operator*(const Vector3fx4 &a, __m128 b) {
+    return {_mm_mul_ps(a.x, b), _mm_mul_ps(a.y, b), _mm_mul_ps(a.z, b)};
+}
+
+//点积
+inline __m128 operator*(const Vector3fx4 &a, const Vector3fx4 &b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+//叉积
+inline Vector3fx4 operator&(const Vector3fx4 &a, const Vector3fx4 &b) {
+    return {_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+            _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+            _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))};
+}
+
+//按掩码选择：掩码为真的通道取a，否则取b
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
@@ -1,59 +1,142 @@
 #include "loader.h"
 
-FileLoader::FileLoader(const char *name): size(0) {
-    std::ifstream file(name);
-    if (!file.is_open()) {
-        std::cout << "Failed to open file!" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-
-    std::ostringstream str;
-    file.seekg(0, std::fstream::end);
-    size = (int)file.tellg();
-    buf = new char[size];
-    file.seekg(0);
-    file.read(buf, size);
-    file.close();
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BMP_TYPE 0x4D42     //"BM"
+#define BMP_RGB 0           //不压缩
+#define BMP_BITFIELDS 3     //按位掩码存储
+
+#ifdef _WIN32
+FileLoader::FileLoader(const char *name) {
+    HANDLE file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "Failed to open file!";
+        return;
+    }
+
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) {
+        CloseHandle(file);
+        error = "Failed to map file!";
+        return;
+    }
+    size = (size_t)len.QuadPart;
+
+    //映射视图会保持对文件的引用，句柄可立即关闭
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping != nullptr) {
+        buf = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    if (buf == nullptr) error = "Failed to map file!";
 }
 
-BmpLoader::BmpLoader(const char *file) {
-    long offset = 0;
-    memcpy(&bfh, file, sizeof(BITMAPFILEHEADER));
-    if (bfh.bfType != 0x4D42) {
-        std::cout << "Invalid Texture Format: Type" << std::endl;
-        exit(EXIT_FAILURE);
+FileLoader::~FileLoader() {
+    if (buf != nullptr) UnmapViewOfFile(buf);
+}
+#else
+FileLoader::FileLoader(const char *name) {
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        error = "Failed to open file!";
+        return;
     }
 
-    offset += sizeof(BITMAPFILEHEADER);
-    memcpy(&bih, file + offset, sizeof(BITMAPINFOHEADER));
-    width = bih.biWidth;
-    height = bih.biHeight;
-    if (bih.biBitCount == 24) {
-        channel = 3;
-        format = GL_RGB;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        error = "Failed to map file!";
+        return;
     }
-    else if (bih.biBitCount == 32) {
-        channel = 4;
-        format = GL_RGBA;
+    size = (size_t)st.st_size;
+
+    //映射会保持对文件的引用，描述符可立即关闭
+    void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        error = "Failed to map file!";
+        return;
     }
-    else {
-        std::cout << "CRASH:Invalid Texture Format: Channel" << std::endl;
-        exit(EXIT_FAILURE);
+    buf = (const char *)p;
+}
+
+FileLoader::~FileLoader() {
+    if (buf != nullptr) munmap((void *)buf, size);
+}
+#endif
+
+BmpLoader::BmpLoader(const FileLoader &file) {
+    if (file.error != nullptr) {
+        error = file.error;
+        return;
+    }
+    const char *data = file.buf;
+    size_t size = file.getSize();
+
+    if (size < sizeof(BmpFileHeader) + sizeof(BmpInfoHeader)) {
+        error = "Invalid Texture Format: Size";
+        return;
+    }
+    memcpy(&bfh, data, sizeof(BmpFileHeader));
+    memcpy(&bih, data + sizeof(BmpFileHeader), sizeof(BmpInfoHeader));
+    if (bfh.type != BMP_TYPE) {
+        error = "Invalid Texture Format: Type";
+        return;
+    }
+    if (bih.size < sizeof(BmpInfoHeader) || bih.planes != 1 || bih.width <= 0 || bih.height == 0) {
+        error = "Invalid Texture Format: Header";
+        return;
     }
 
-    if (bih.biSizeImage == 0)
-        bih.biSizeImage = width * height * channel;
+    if (bih.bitCount == 24) {
+        channel = 3;
+        internalFormat = GL_RGB8;
+        format = GL_BGR;
+    } else if (bih.bitCount == 32) {
+        channel = 4;
+        internalFormat = GL_RGBA8;
+        format = GL_BGRA;
+    } else {
+        error = "CRASH:Invalid Texture Format: Channel";
+        return;
+    }
 
-    textureData = new char[bih.biSizeImage];
+    //只支持不压缩或标准BGRA位掩码的格式
+    if (bih.compression == BMP_BITFIELDS && channel == 4) {
+        uint32_t masks[3];
+        if (sizeof(BmpFileHeader) + sizeof(BmpInfoHeader) + sizeof(masks) > size) {
+            error = "Invalid Texture Format: Size";
+            return;
+        }
+        memcpy(masks, data + sizeof(BmpFileHeader) + sizeof(BmpInfoHeader), sizeof(masks));
+        if (masks[0] != 0x00FF0000 || masks[1] != 0x0000FF00 || masks[2] != 0x000000FF) {
+            error = "Invalid Texture Format: Bit Fields";
+            return;
+        }
+    } else if (bih.compression != BMP_RGB) {
+        error = "Invalid Texture Format: Compression";
+        return;
+    }
 
-    offset = (long)bfh.bfOffBits;
-    memcpy(textureData, file + offset, bih.biSizeImage);
+    width = bih.width;
+    height = bih.height < 0 ? -bih.height : bih.height;
+    topDown = bih.height < 0;
+    stride = (width * channel + 3) & ~3;
 
-    char temp;
-    for (int i = 0; i < bih.biSizeImage; i += channel) {
-        temp = textureData[i];
-        textureData[i] = textureData[i + 2];
-        textureData[i + 2] = temp;
+    if (bfh.offBits > size || (size_t)stride * height > size - bfh.offBits) {
+        error = "Invalid Texture Format: Size";
+        return;
     }
+    textureData = data + bfh.offBits;
 }
-
@@ -1,37 +1,71 @@
 #pragma once
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <windows.h>
-#include <vector>
+#include <cstdint>
+#include <cstddef>
 #include <GL/glew.h>
 
 #include "config/config.h"
 
+//以只读方式映射整个文件，不复制文件内容
 class FileLoader {
 private:
-    int size;
+    size_t size{};
 
 public:
-    char *buf;
+    const char *buf{};
+    const char *error{}; //打开或映射失败的原因，成功时为空，由调用者决定如何处理
 
     explicit FileLoader(const char *name);
-    ~FileLoader() {delete[] buf;}
+    FileLoader(const FileLoader &) = delete;
+    ~FileLoader();
+
+    size_t getSize() const {return size;}
+};
+
+//BMP文件头与信息头，按文件中的布局紧密排列（小端序）
+#pragma pack(push, 1)
+struct BmpFileHeader {
+    uint16_t type;
+    uint32_t size;
+    uint16_t reserved1;
+    uint16_t reserved2;
+    uint32_t offBits;
 };
 
+struct BmpInfoHeader {
+    uint32_t size;
+    int32_t width;
+    int32_t height;   //为负时行自上而下存储
+    uint16_t planes;
+    uint16_t bitCount;
+    uint32_t compression;
+    uint32_t sizeImage;
+    int32_t xPelsPerMeter;
+    int32_t yPelsPerMeter;
+    uint32_t clrUsed;
+    uint32_t clrImportant;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BmpFileHeader) == 14, "BmpFileHeader must match the file layout");
+static_assert(sizeof(BmpInfoHeader) == 40, "BmpInfoHeader must match the file layout");
+
+//解析映射后的BMP文件，像素数据直接指向文件映射，按BGR(A)格式上传
 class BmpLoader {
 private:
     int channel;
-    BITMAPFILEHEADER bfh{};
-    BITMAPINFOHEADER bih{};
+    BmpFileHeader bfh{};
+    BmpInfoHeader bih{};
 
 public:
-    char *textureData;
+    const char *error{};     //文件无效或格式不支持的原因，成功时为空，此时以下成员无效
+    const char *textureData; //第一行像素，行间距为stride
     int width, height;
-    int format;
+    int stride;              //每行字节数，按4字节对齐
+    bool topDown;            //行是否自上而下存储
+    GLint internalFormat;
+    GLenum format;
 
-    explicit BmpLoader(const char *file);
-    ~BmpLoader() {delete[] textureData;}
+    explicit BmpLoader(const FileLoader &file);
 };
-
@@ -0,0 +1,72 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int n) {
+    if (n <= 0) n = (int)std::thread::hardware_concurrency();
+    if (n <= 0) n = 1;
+    for (int i = 0; i < n; i++)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cond.notify_all();
+    for (auto &worker : workers) worker.join();
+
+    //GL任务可能继续提交工作线程任务与GL任务，此时均在当前线程执行，直到没有新的任务
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(glMutex);
+            if (glTasks.empty()) break;
+        }
+        poll();
+    }
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() {return stop || !tasks.empty();});
+            //停止后仍执行完队列中的任务
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        //停止后工作线程可能已退出，任务在调用线程执行
+        if (stop) {
+            lock.unlock();
+            task();
+            return;
+        }
+        tasks.push(std::move(task));
+    }
+    cond.notify_one();
+}
+
+void ThreadPool::post(std::function<bool()> task) {
+    std::lock_guard<std::mutex> lock(glMutex);
+    glTasks.push_back(std::move(task));
+}
+
+bool ThreadPool::poll() {
+    std::vector<std::function<bool()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(glMutex);
+        ready.swap(glTasks);
+    }
+    //任务执行时可能继续投递新的任务，留到下一次调用执行
+    bool changed = false;
+    for (auto &task : ready) changed = task() || changed;
+    return changed;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//资源加载线程池：耗时的解析与建树在工作线程执行，GL调用投递回GL线程执行
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;   //工作线程任务
+    std::vector<std::function<bool()>> glTasks; //GL线程任务，返回场景是否发生变化
+    std::mutex mutex;
+    std::mutex glMutex;
+    std::condition_variable cond;
+    bool stop = false;
+
+    void work();
+
+public:
+    //默认按CPU核数创建工作线程
+    explicit ThreadPool(int n = 0);
+    //执行完所有已提交的任务后退出：工作线程先执行完队列中的任务，剩余的GL任务在调用线程执行，须在GL线程析构
+    //任务中捕获的模型、材质与纹理等资源因此总能交给场景或随任务释放
+    ~ThreadPool();
+
+    //提交在工作线程执行的任务；析构开始后提交的任务在调用线程直接执行
+    void submit(std::function<void()> task);
+    //提交在GL线程执行的任务，可在任意线程调用
+    void post(std::function<bool()> task);
+    //在GL线程调用，执行已提交的GL任务，返回场景是否发生变化
+    bool poll();
+};
@@ -1,17 +1,31 @@
 #include <GL/glew.h>
 #include <GL/freeglut.h>
 
+#include <cstring>
+
 #include "config/config.h"
 #include "scene/scene.h"
+#include "simd/kernel.h"
 
 //光线追踪场景
 Scene *scene;
+//累积方式
+ACCUMULATE_MODE accumulate = BLEND;
+TRACER_BACKEND backend = FRAGMENT;
+//最大反弹次数与开始俄罗斯轮盘的反弹次数
+int maxDepth = MAX_DEPTH;
+int rouletteDepth = ROULETTE_DEPTH;
+//每秒显示的次数
+double presentRate = PRESENT_RATE;
 
 //记录屏幕高度
 int height = ORI_HEIGHT;
 
 void myInit() {
-    scene = new Scene();
+    scene = new Scene(accumulate, backend);
+    scene->setMaxDepth(maxDepth);
+    scene->setRouletteDepth(rouletteDepth);
+    scene->setPresentRate(presentRate);
 }
 
 void myDelete() {
@@ -23,8 +37,8 @@ void reshape(int, int h) {
 }
 
 void display() {
-    scene->render();
-    glutSwapBuffers();
+    //只在显示时交换缓冲，累积不受垂直同步限制
+    if (scene->render()) glutSwapBuffers();
 }
 
 void frame() {
@@ -40,12 +54,47 @@ void mouse(int button, int state, int x, int y) {
 }
 
 int main(int argc, char *argv[]) {
+    //-isa <name>：指定CPU求交核函数的指令集（sse4、avx2、avx512）
+    //-bench：只运行CPU求交核函数的性能测试
+    //-pingpong：在两个缓冲间交替读写累积结果，默认使用加法混合
+    //-wavefront：使用计算着色器的波前路径追踪，默认使用片元着色器
+    //-depth <n>：路径的最大反弹次数，默认为6
+    //-roulette <n>：反弹n次后开始以俄罗斯轮盘结束路径，默认为3，不小于最大反弹次数时不启用
+    //-fps <n>：每秒显示的次数，默认为30，累积不受显示频率限制
+    bool bench = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-bench") == 0) {
+            bench = true;
+        } else if (strcmp(argv[i], "-pingpong") == 0) {
+            accumulate = PING_PONG;
+        } else if (strcmp(argv[i], "-wavefront") == 0) {
+            backend = WAVEFRONT;
+        } else if (strcmp(argv[i], "-depth") == 0 && i + 1 < argc) {
+            maxDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-roulette") == 0 && i + 1 < argc) {
+            rouletteDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-fps") == 0 && i + 1 < argc) {
+            presentRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-isa") == 0 && i + 1 < argc) {
+            if (!setKernelISA(argv[++i])) {
+                std::cout << "unsupported isa: " << argv[i] << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    if (bench) {
+        benchmarkKernels();
+        return 0;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
     glutInitWindowSize(ORI_WIDTH, ORI_HEIGHT);
     glutCreateWindow("ray tracing - tcy");
 
     glewInit();
+    //不限制驱动并行编译着色器的线程数
+    if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
     myInit();
 
     glutReshapeFunc(reshape);
@@ -17,6 +17,7 @@ public:
     GLfloat refractTint = 0.0f;                    //折射属性（颜色到光照的插值）：0-1
     GLfloat refractIndex = 1.0f;                   //折射率
     GLfloat refractRoughness = 0.0f;               //折射模糊度：0-1
+    bool dirty = true;                             //属性修改后置位，上传到着色器后清除
 
     static const Material metal;
     static const Material plastic;
@@ -1,26 +1,67 @@
 #include "model.h"
 
+#include <atomic>
 #include <fstream>
 
 #include "bvh/bvh.h"
 
-static int model_num = 0;
+//模型可在加载线程中创建
+static std::atomic<int> model_num(0);
 
-Model::Model(Material *mat, Texture *tex): material(mat), texture(tex), id(model_num++) {
+//点坐标到圆柱体侧面的纹理映射
+static Vector2f cylinderTexCoord(const Vector3f &P, const Vector3f &center, GLfloat height) {
+    GLfloat ang_x = std::atan2(P.z - center.z, P.x - center.x);
+    return {1.0f - ang_x / (2.0f * PI), (P.y - center.y) / height};
+}
+
+//将光线包中更新的光线按面片补全击中信息
+static void fillQuadHits(const RayPacket &p, const Vector3f *samples, int mask, __m128 t, HitInfo *hits) {
+    alignas(16) GLfloat dist[PACKET_SIZE];
+    _mm_store_ps(dist, t);
+    Vector3f normal = normalize((samples[1] - samples[0]) & (samples[2] - samples[0]));
+    for (int i = 0; i < PACKET_SIZE; i++) {
+        if (!(mask >> i & 1)) continue;
+        hits[i].distance = dist[i];
+        hits[i].hitPoint = p.rays[i].startPoint + p.rays[i].direction * dist[i];
+        hits[i].normal = normal;
+    }
+}
+
+//光线包扩展为八路光线批次，多出的通道重复最后一条光线，其结果不写回
+static void packetBatch(const RayPacket &p, const HitInfo *hits, RayBatch &r, HitBatch &hit) {
+    r.set(p.rays, PACKET_SIZE);
+    hit.clear();
+    for (int i = 0; i < PACKET_SIZE; i++) hit.distance[i] = hits[i].distance;
+}
+
+//将批次中更新的光线写回击中信息
+static int fillBatchHits(const RayPacket &p, int mask, const HitBatch &hit, HitInfo *hits) {
+    mask &= (1 << PACKET_SIZE) - 1;
+    for (int i = 0; i < PACKET_SIZE; i++) {
+        if (!(mask >> i & 1)) continue;
+        hits[i].distance = hit.distance[i];
+        hits[i].hitPoint = p.rays[i].startPoint + p.rays[i].direction * hit.distance[i];
+        hits[i].normal = {hit.nx[i], hit.ny[i], hit.nz[i]};
+    }
+    return mask;
+}
+
+Model::Model(Material *mat, Texture *tex): id(model_num++), material(mat), texture(tex) {
 
 }
 
+Model::Model(Model &&other) noexcept: id(other.id), material(other.material), texture(other.texture),
+                                      dirty(other.dirty) {
+    other.material = nullptr;
+    other.texture = nullptr;
+}
+
 Model::~Model() {
     delete material;
     delete texture;
 }
 
 CustomizedModel::CustomizedModel(const std::string &path, const Vector3f &eye, Material *mat, Texture *tex): Model(mat, tex) {
-    glGenBuffers(1, &patch_tbo);
-    glGenTextures(1, &patch_tex);
-    glGenBuffers(1, &bvh_tbo);
-    glGenTextures(1, &bvh_tex);
-
     std::ifstream file(path);
     if (!file.is_open()) {
         std::cout << "obj file is not found" << std::endl;
@@ -96,41 +137,43 @@ CustomizedModel::CustomizedModel(const std::string &path, const Vector3f &eye, M
     file.close();
 }
 
-CustomizedModel::~CustomizedModel() {
-    glDeleteBuffers(1, &patch_tbo);
-    glDeleteTextures(1, &patch_tex);
-    glDeleteBuffers(1, &bvh_tbo);
-    glDeleteTextures(1, &bvh_tex);
-    delete[] bvh;
-}
-
-MODEL_TYPE CustomizedModel::type() {
-    return CUSTOMIZED;
-}
-
-GLfloat CustomizedModel::hit(Ray r) {
-    //按照矩形包围面片处理
-    GLfloat t = (center.z - r.startPoint.z) / r.direction.z;
-    Vector3f P = r.startPoint + r.direction * t;
-    if (P.x >= center.x - radius && P.x <= center.x + radius &&
-        P.y >= center.y && P.y <= center.y + height) return t;
-    return -1.0f;
+CustomizedModel::CustomizedModel(CustomizedModel &&other) noexcept:
+        Model(std::move(other)), patches(std::move(other.patches)), bvh(other.bvh),
+        leaf_bvh(other.leaf_bvh), blocks(other.blocks),
+        center(other.center), radius(other.radius), height(other.height),
+        patch_num(other.patch_num), bvh_size(other.bvh_size) {
+    //BVH树的所有权转移到新对象
+    other.bvh = other.leaf_bvh = nullptr;
+    other.blocks = nullptr;
 }
 
-GLuint CustomizedModel::getPatchTex() {
-    return patch_tex;
+CustomizedModel::~CustomizedModel() {
+    delete[] bvh;
+    delete[] leaf_bvh;
+    delete[] blocks;
 }
 
-GLuint CustomizedModel::getBVHTex() {
-    return bvh_tex;
+bool CustomizedModel::hit(const Ray &r, HitInfo &hit) {
+    if (blocks != nullptr) return BVH::hitBlocks(leaf_bvh, blocks, r, hit);
+    //与着色器共用同一棵BVH树
+    return BVH::hit(bvh, patches.data(), r, hit);
 }
 
-Vector3f CustomizedModel::getCenter() {
-    return center;
+int CustomizedModel::hit4(const RayPacket &p, HitInfo *hits) {
+    __m128 t = _mm_setr_ps(hits[0].distance, hits[1].distance, hits[2].distance, hits[3].distance);
+    __m128i idx = _mm_set1_epi32(-1);
+    int mask = BVH::hit4(bvh, patches.data(), p, t, idx);
+    if (mask == 0) return 0;
+
+    alignas(16) int index[PACKET_SIZE];
+    _mm_store_si128((__m128i *)index, idx);
+    for (int i = 0; i < PACKET_SIZE; i++)
+        if (mask >> i & 1) fillQuadHits(p, patches[index[i]].samples, 1 << i, t, hits);
+    return mask;
 }
 
-GLfloat CustomizedModel::getHeight() {
-    return height;
+Vector2f CustomizedModel::texCoord(const HitInfo &hit) {
+    return cylinderTexCoord(hit.hitPoint, center, height);
 }
 
 void CustomizedModel::trans(GLfloat scale, Vector3f move) {
@@ -150,20 +193,19 @@ void CustomizedModel::trans(GLfloat scale, Vector3f move) {
     center += move;
 }
 
-void CustomizedModel::build() {
+void CustomizedModel::build(bool packed) {
     BVH tree(patches, patch_num, 3);
-    GLsizei bvh_size;
     bvh = tree.getLinearBVH(bvh_size);
 
-    glBindBuffer(GL_TEXTURE_BUFFER, patch_tbo);
-    glBufferData(GL_TEXTURE_BUFFER, (GLsizei)(sizeof(Patch) * patch_num), patches.data(), GL_STATIC_DRAW);
-    glBindTexture(GL_TEXTURE_BUFFER, patch_tex);
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, patch_tbo);
-
-    glBindBuffer(GL_TEXTURE_BUFFER, bvh_tbo);
-    glBufferData(GL_TEXTURE_BUFFER, bvh_size, bvh, GL_STATIC_DRAW);
-    glBindTexture(GL_TEXTURE_BUFFER, bvh_tex);
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, bvh_tbo);
+    //建树会重排面片，因此在副本上构建，叶子块中保存了求交所需的全部数据
+    if (packed) {
+        std::vector<Patch> copy(patches);
+        BVH leaf_tree(copy, patch_num, KERNEL_WIDTH);
+        GLsizei leaf_size;
+        int block_num;
+        leaf_bvh = leaf_tree.getLinearBVH(leaf_size);
+        blocks = BVH::packLeaves(leaf_bvh, leaf_size / (GLsizei)sizeof(LinearNode), copy.data(), block_num);
+    }
 }
 
 QuadModel::QuadModel(Vector3f v1, Vector3f v2, Vector3f v3, Material *mat, Texture *tex): Model(mat, tex) {
@@ -176,20 +218,33 @@ QuadModel::QuadModel(Vector3f v1, Vector3f v2, Vector3f v3, Material *mat, Textu
     normal = normalize(normal);
 }
 
-MODEL_TYPE QuadModel::type() {
-    return QUAD;
-}
-
-GLfloat QuadModel::hit(Ray) {
-    return false;
+bool QuadModel::hit(const Ray &r, HitInfo &hit) {
+    return hitQuad(r, samples, hit);
 }
 
-Vector3f *QuadModel::getSamples() {
-    return samples;
+int QuadModel::hit4(const RayPacket &p, HitInfo *hits) {
+    __m128 t = _mm_setr_ps(hits[0].distance, hits[1].distance, hits[2].distance, hits[3].distance);
+    __m128i idx = _mm_setzero_si128();
+    int mask = hitQuad4(p, samples, 0, t, idx);
+    fillQuadHits(p, samples, mask, t, hits);
+    return mask;
 }
 
-Vector3f QuadModel::getNormal() {
-    return normal;
+Vector2f QuadModel::texCoord(const HitInfo &hit) {
+    //在四边形所在平面内求解 P - samples[1] = u * m + v * n
+    Vector3f m = samples[2] - samples[0];
+    Vector3f n = samples[0] - samples[1];
+    Vector3f q = hit.hitPoint - samples[1];
+    GLfloat a, b, c, d, x, y;
+    if (m.x == 0.0f && n.x == 0.0f && q.x == 0.0f) {
+        a = m.y; b = n.y; c = m.z; d = n.z; x = q.y; y = q.z;
+    } else if (m.y == 0.0f && n.y == 0.0f && q.y == 0.0f) {
+        a = m.x; b = n.x; c = m.z; d = n.z; x = q.x; y = q.z;
+    } else {
+        a = m.x; b = n.x; c = m.y; d = n.y; x = q.x; y = q.y;
+    }
+    GLfloat det = a * d - b * c;
+    return {(d * x - b * y) / det, (a * y - c * x) / det};
 }
 
 SphereModel::SphereModel(Vector3f c, GLfloat r, Material *mat, Texture *tex): Model(mat, tex) {
@@ -197,25 +252,47 @@ SphereModel::SphereModel(Vector3f c, GLfloat r, Material *mat, Texture *tex): Mo
     radius = r;
 }
 
-MODEL_TYPE SphereModel::type() {
-    return SPHERE;
-}
-
-GLfloat SphereModel::hit(Ray r) {
+bool SphereModel::hit(const Ray &r, HitInfo &hit) {
+    //计算光线与球心距离
     GLfloat t = (center - r.startPoint) * r.direction;
     Vector3f T = r.startPoint + r.direction * t;
     Vector3f CP = T - center;
     GLfloat l_CP = length(CP);
-    if (l_CP <= radius) return t;
-    return -1.0f;
+
+    //距离大于半径则不相交
+    if (l_CP > radius) return false;
+
+    //计算交点
+    GLfloat delta = std::sqrt(radius * radius - l_CP * l_CP);
+    GLfloat t1 = t - delta;
+    GLfloat t2 = t + delta;
+
+    //判断是哪个交点，并剔除与自身相交的情况
+    if (t1 > ERR) t = t1;
+    else if (t2 > ERR) t = t2;
+    else return false;
+
+    //存在遮挡
+    if (t >= hit.distance - ERR) return false;
+
+    hit.distance = t;
+    hit.hitPoint = r.startPoint + r.direction * t;
+    hit.normal = normalize(hit.hitPoint - center);
+    return true;
 }
 
-Vector3f SphereModel::getCenter() {
-    return center;
+int SphereModel::hit4(const RayPacket &p, HitInfo *hits) {
+    RayBatch r{};
+    HitBatch hit{};
+    packetBatch(p, hits, r, hit);
+    return fillBatchHits(p, hitSphere8(r, center, radius, hit), hit, hits);
 }
 
-GLfloat SphereModel::getRadius() {
-    return radius;
+Vector2f SphereModel::texCoord(const HitInfo &hit) {
+    //法矢量到球面纹理坐标的映射
+    GLfloat ang_x = std::atan2(hit.normal.z, hit.normal.x);
+    GLfloat ang_y = std::asin(hit.normal.y);
+    return {1.0f - ang_x / (2.0f * PI), 0.5f + ang_y / PI};
 }
 
 CylinderModel::CylinderModel(Vector3f c, GLfloat r, GLfloat h, Material *mat, Texture *tex): Model(mat, tex) {
@@ -224,26 +301,62 @@ CylinderModel::CylinderModel(Vector3f c, GLfloat r, GLfloat h, Material *mat, Te
     height = h;
 }
 
-MODEL_TYPE CylinderModel::type() {
-    return CYLINDER;
-}
-
-GLfloat CylinderModel::hit(Ray r) {
-    GLfloat t = (center.z - r.startPoint.z) / r.direction.z;
-    Vector3f P = r.startPoint + r.direction * t;
-    if (P.x >= center.x - radius && P.x <= center.x + radius &&
-        P.y >= center.y && P.y <= center.y + height) return t;
-    return -1.0f;
-}
+bool CylinderModel::hit(const Ray &r, HitInfo &hit) {
+    //计算光线到中轴的最短距离
+    Vector2f SF = {center.x - r.startPoint.x, center.z - r.startPoint.z};
+    Vector2f d_ST = {r.direction.x, r.direction.z};
+    GLfloat l_dST = length(d_ST);
+    GLfloat l_FT = std::fabs(SF.y * d_ST.x - SF.x * d_ST.y) / l_dST;
+
+    //距离大于半径则不与无限长圆柱面相交
+    if (l_FT > radius) return false;
+
+    //计算与无限长圆柱面的交点
+    GLfloat l_SF = length(SF);
+    GLfloat t = std::sqrt(l_SF * l_SF - l_FT * l_FT) / l_dST;
+    GLfloat right = radius * radius - l_FT * l_FT;
+    GLfloat left = 1.0f - r.direction.y * r.direction.y;
+    GLfloat delta = std::sqrt(right / left);
+    GLfloat t1 = t - delta;
+    GLfloat t2 = t + delta;
+    Vector3f M = r.startPoint + r.direction * t1;
+    Vector3f N = r.startPoint + r.direction * t2;
+
+    //交点方向相反
+    if (t2 <= ERR) return false;
+
+    //击中点在侧面
+    if (M.y >= center.y && M.y <= center.y + height) {
+        if (t1 <= ERR) return false; //与自身相交
+        if (t1 >= hit.distance - ERR) return false; //存在遮挡
+        Vector2f nor = normalize(Vector2f{M.x - center.x, M.z - center.z});
+        hit.distance = t1;
+        hit.hitPoint = M;
+        hit.normal = {nor.x, 0.0f, nor.y};
+        return true;
+    }
 
-Vector3f CylinderModel::getCenter() {
-    return center;
+    //击中点在下底面或上底面
+    GLfloat y;
+    if (M.y < center.y && N.y >= center.y) y = center.y;
+    else if (M.y > center.y + height && N.y <= center.y + height) y = center.y + height;
+    else return false;
+
+    GLfloat m = (y - r.startPoint.y) / r.direction.y;
+    if (m >= hit.distance - ERR) return false; //存在遮挡
+    hit.distance = m;
+    hit.hitPoint = r.startPoint + r.direction * m;
+    hit.normal = {0.0f, y == center.y ? -1.0f : 1.0f, 0.0f};
+    return true;
 }
 
-GLfloat CylinderModel::getRadius() {
-    return radius;
+int CylinderModel::hit4(const RayPacket &p, HitInfo *hits) {
+    RayBatch r{};
+    HitBatch hit{};
+    packetBatch(p, hits, r, hit);
+    return fillBatchHits(p, hitCylinder8(r, center, radius, height, hit), hit, hits);
 }
 
-GLfloat CylinderModel::getHeight() {
-    return height;
-}
+Vector2f CylinderModel::texCoord(const HitInfo &hit) {
+    return cylinderTexCoord(hit.hitPoint, center, height);
+}
\ No newline at end of file
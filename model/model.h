@@ -7,113 +7,131 @@
 #include "material/material.h"
 #include "texture/texture.h"
 #include "bvh/bvh.h"
+#include "simd/simd.h"
 
 //模型类别：自定义类型（扫描表面）、四边形、球体、圆柱体
 enum MODEL_TYPE {CUSTOMIZED, QUAD, SPHERE, CYLINDER};
 
-//模型基类
+//模型基类：不含虚函数，各类模型在场景中分别存放于连续数组，通过模板静态分发
 class Model {
 protected:
     int id;
     Material *material{};
     Texture *texture{};
+    bool dirty = true; //几何或纹理变化后置位，上传到着色器后清除
 
 public:
     explicit Model(Material *mat, Texture *tex = nullptr);
+    Model(Model &&other) noexcept;
+    Model(const Model &) = delete;
     ~Model();
 
     Material *getMaterial() {return material;}
     Texture *getTexture() {return texture;}
     int getId() const {return id;}
-    void setLighting() {material->lighting = !material->lighting;}
-
-    virtual MODEL_TYPE type() = 0;
-    virtual GLfloat hit(Ray r) = 0;
-
-    virtual Vector3f *getSamples() {return nullptr;}
-    virtual GLuint getPatchTex() {return 0;}
-    virtual GLuint getBVHTex() {return 0;}
-    virtual Vector3f getCenter() {return {0.0f, 0.0f, 0.0f};}
-    virtual GLfloat getRadius() {return 0.0f;}
-    virtual GLfloat getHeight() {return 0.0f;}
-    virtual Vector3f getNormal() {return {0.0f, 0.0f, 0.0f};}
-    virtual void trans(GLfloat scale, Vector3f move) {}
-    virtual void build() {}
+    void setLighting() {
+        material->lighting = !material->lighting;
+        material->dirty = true;
+    }
+    bool isDirty() const {return dirty;}
+    void setDirty(bool value) {dirty = value;}
+
+    //各派生类提供以下同名函数：
+    //  bool hit(const Ray &r, HitInfo &hit)：与tracer.frag一致的精确求交，仅当交点比hit中记录的更近时更新hit
+    //  int hit4(const RayPacket &p, HitInfo *hits)：光线包求交，返回更新的光线掩码
+    //  Vector2f texCoord(const HitInfo &hit)：击中点的纹理坐标，与tracer.frag中的纹理映射一致
 };
 
-class CustomizedModel : public Model {
+class CustomizedModel final : public Model {
 private:
     std::vector<Patch> patches{};
-    GLuint *bvh{};
+    LinearNode *bvh{};
+    LinearNode *leaf_bvh{}; //CPU端求交使用的BVH树，叶子大小与求交核宽度一致
+    QuadBlock *blocks{};    //leaf_bvh的SoA叶子块
 
     Vector3f center{};
     GLfloat radius{};
     GLfloat height{};
 
-    GLuint patch_tbo{};
-    GLuint patch_tex{};
     GLsizei patch_num{};
-    GLuint bvh_tbo{};
-    GLuint bvh_tex{};
+    GLsizei bvh_size{};
 
 public:
+    static constexpr MODEL_TYPE TYPE = CUSTOMIZED;
+
+    //只在CPU端处理数据，可在工作线程执行；面片与BVH树由场景合并后上传
     explicit CustomizedModel(const std::string &path, const Vector3f &eye, Material *mat, Texture *tex = nullptr);
+    CustomizedModel(CustomizedModel &&other) noexcept;
     ~CustomizedModel();
 
-    MODEL_TYPE type() override;
-    GLfloat hit(Ray r) override;
-
-    GLuint getPatchTex() override;
-    GLuint getBVHTex() override;
-    Vector3f getCenter() override;
-    GLfloat getHeight() override;
-    void trans(GLfloat scale, Vector3f move) override;
-    void build() override;
+    bool hit(const Ray &r, HitInfo &hit);
+    int hit4(const RayPacket &p, HitInfo *hits);
+    Vector2f texCoord(const HitInfo &hit);
+
+    const Patch *getPatches() const {return patches.data();}
+    GLsizei getPatchNum() const {return patch_num;}
+    //着色器使用的BVH树及其结点数
+    const LinearNode *getBVH() const {return bvh;}
+    GLsizei getBVHNum() const {return bvh_size / (GLsizei)sizeof(LinearNode);}
+    Vector3f getCenter() const {return center;}
+    GLfloat getHeight() const {return height;}
+    void trans(GLfloat scale, Vector3f move);
+    //packed为真时额外构建CPU端的叶子块BVH树，用于单条光线求交
+    void build(bool packed = false);
 };
 
-class QuadModel : public Model {
+class QuadModel final : public Model {
 private:
     Vector3f samples[4]{};
     vector3f normal{};
 
 public:
+    static constexpr MODEL_TYPE TYPE = QUAD;
+
     QuadModel(Vector3f left_up, Vector3f left_down, Vector3f right_up, Material *mat, Texture *tex = nullptr);
 
-    MODEL_TYPE type() override;
-    GLfloat hit(Ray r) override;
+    bool hit(const Ray &r, HitInfo &hit);
+    int hit4(const RayPacket &p, HitInfo *hits);
+    Vector2f texCoord(const HitInfo &hit);
 
-    Vector3f *getSamples() override;
-    Vector3f getNormal() override;
+    Vector3f *getSamples() {return samples;}
+    Vector3f getNormal() const {return normal;}
 };
 
-class SphereModel : public Model {
+class SphereModel final : public Model {
 private:
     Vector3f center{};
     GLfloat radius{};
 
 public:
+    static constexpr MODEL_TYPE TYPE = SPHERE;
+
     SphereModel(Vector3f center, GLfloat radius, Material *mat, Texture *tex = nullptr);
 
-    MODEL_TYPE type() override;
-    GLfloat hit(Ray r) override;
+    bool hit(const Ray &r, HitInfo &hit);
+    int hit4(const RayPacket &p, HitInfo *hits);
+    Vector2f texCoord(const HitInfo &hit);
 
-    Vector3f getCenter() override;
-    GLfloat getRadius() override;
+    Vector3f getCenter() const {return center;}
+    GLfloat getRadius() const {return radius;}
 };
 
-class CylinderModel : public Model {
+class CylinderModel final : public Model {
 private:
     Vector3f center{};
     GLfloat radius{};
     GLfloat height{};
 
 public:
+    static constexpr MODEL_TYPE TYPE = CYLINDER;
+
     CylinderModel(Vector3f bottom_center, GLfloat radius, GLfloat height, Material *mat, Texture *tex = nullptr);
 
-    MODEL_TYPE type() override;
-    GLfloat hit(Ray r) override;
+    bool hit(const Ray &r, HitInfo &hit);
+    int hit4(const RayPacket &p, HitInfo *hits);
+    Vector2f texCoord(const HitInfo &hit);
 
-    Vector3f getCenter() override;
-    GLfloat getRadius() override;
-    GLfloat getHeight() override;
+    Vector3f getCenter() const {return center;}
+    GLfloat getRadius() const {return radius;}
+    GLfloat getHeight() const {return height;}
 };
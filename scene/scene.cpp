@@ -1,9 +1,27 @@
 #include "scene.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
 #include "shader/shaderBuf.h"
 
-Scene::Scene() {
-    tracerShader = new Shader(tracer_vert, tracer_frag);
-    renderShader = new Shader(tracer_vert, render_frag);
+Scene::Scene(ACCUMULATE_MODE accumulate, TRACER_BACKEND backend): accumulate(accumulate) {
+    //光线追踪着色器在首次上传场景时按场景签名选择
+    vertSource = Shader::loadSource(SHADER_DIR "tracer.vert", tracer_vert);
+    tracerSource = Shader::loadSource(SHADER_DIR "tracer.frag", tracer_frag);
+    std::string renderSource = Shader::loadSource(SHADER_DIR "render.frag", render_frag);
+    renderShader = new Shader(vertSource.c_str(), renderSource.c_str());
+    //预览着色器与场景无关，立即开始异步编译
+    std::string previewSource = Shader::loadSource(SHADER_DIR "preview.frag", preview_frag);
+    previewShader = Shader::compileAsync(vertSource.c_str(), previewSource.c_str(), "");
+    resolveUniforms();
+    sceneBuffer = new SceneBuffer(SCENE_BINDING);
+    glGenBuffers(1, &patch_tbo);
+    glGenTextures(1, &patch_tex);
+    glGenBuffers(1, &bvh_tbo);
+    glGenTextures(1, &bvh_tex);
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -11,290 +29,676 @@ Scene::Scene() {
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(screen), screen, GL_STATIC_DRAW);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vector3f), nullptr);
+    glEnableVertexAttribArray(1);
+
+    //启用帧缓冲：RGBA32F可作为渲染目标并支持混合，RGB32F不保证
+    int buffers = accumulate == PING_PONG ? 2 : 1;
+    glGenFramebuffers(buffers, fbo);
+    glGenTextures(buffers, tbo);
+    for (int i = 0; i < buffers; i++) {
+        glBindTexture(GL_TEXTURE_2D, tbo[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, ORI_WIDTH, ORI_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        //渲染结果写入纹理
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, tbo[i], 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGenQueries(1, &timer);
+    if (backend == WAVEFRONT) wavefront = new Wavefront(ORI_WIDTH, ORI_HEIGHT);
 
-    //启用帧缓冲
-    glGenFramebuffers(1, &fbo);
-    glGenTextures(1, &tbo);
-    glBindTexture(GL_TEXTURE_2D, tbo);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, ORI_WIDTH, ORI_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    //纹理与网格模型由线程池异步加载，加载完成前先渲染已有的模型
+    pool = new ThreadPool();
+    textures = new TextureArray();
 
     //设置模型
     Material *mat;
     Texture *tex;
-    Model *mod;
     //左灯
     mat = new Material();
     mat->lighting = true;
     mat->color = {0.95f, 0.95f, 0.95f};
-    mod = new QuadModel({-1.0f, 0.8f, -0.7f},
-                        {-1.0f, 0.2f, -0.7f},
-                        {-1.0f, 0.8f, -1.3f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({-1.0f, 0.8f, -0.7f},
+                              {-1.0f, 0.2f, -0.7f},
+                              {-1.0f, 0.8f, -1.3f},
+                              mat));
     //右灯
     mat = new Material();
     mat->lighting = true;
     mat->color = {0.95f, 0.95f, 0.95f};
-    mod = new QuadModel({1.0f, 0.8f, -1.3f},
-                        {1.0f, 0.2f, -1.3f},
-                        {1.0f, 0.8f, -0.7f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({1.0f, 0.8f, -1.3f},
+                              {1.0f, 0.2f, -1.3f},
+                              {1.0f, 0.8f, -0.7f},
+                              mat));
     //后墙
     mat = new Material(Material::wall);
     mat->color = {0.6f, 0.85f, 0.918f};
-    mod = new QuadModel({-1.0f, 1.0f, -2.0f},
-                        {-1.0f, -1.0f, -2.0f},
-                        {1.0f, 1.0f, -2.0f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({-1.0f, 1.0f, -2.0f},
+                              {-1.0f, -1.0f, -2.0f},
+                              {1.0f, 1.0f, -2.0f},
+                              mat));
     //左墙
     mat = new Material(Material::wall);
     mat->color = {1.0f, 0.682f, 0.788f};
-    mod = new QuadModel({-1.0f, 1.0f, 0.0f},
-                        {-1.0f, -1.0f, 0.0f},
-                        {-1.0f, 1.0f, -2.0f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({-1.0f, 1.0f, 0.0f},
+                              {-1.0f, -1.0f, 0.0f},
+                              {-1.0f, 1.0f, -2.0f},
+                              mat));
     //右墙
     mat = new Material(Material::wall);
     mat->color = {0.71f, 0.902f, 0.114f};
-    mod = new QuadModel({1.0f, 1.0f, -2.0f},
-                        {1.0f, -1.0f, -2.0f},
-                        {1.0f, 1.0f, 0.0f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({1.0f, 1.0f, -2.0f},
+                              {1.0f, -1.0f, -2.0f},
+                              {1.0f, 1.0f, 0.0f},
+                              mat));
     //天花板
     mat = new Material(Material::wall);
     mat->color = {1.0f, 1.0f, 1.0f};
-    mod = new QuadModel({-1.0f, 1.0f, 0.0f},
-                        {-1.0f, 1.0f, -2.0f},
-                        {1.0f, 1.0f, 0.0f},
-                        mat);
-    models.push_back(mod);
+    quads.push_back(QuadModel({-1.0f, 1.0f, 0.0f},
+                              {-1.0f, 1.0f, -2.0f},
+                              {1.0f, 1.0f, 0.0f},
+                              mat));
     //地板
     mat = new Material(Material::smoothWood);
-    tex = new Texture(".\\static\\3.bmp");
-    mod = new QuadModel({-1.0f, -1.0f, -2.0f},
-                        {-1.0f, -1.0f, 0.0f},
-                        {1.0f, -1.0f, -2.0f},
-                        mat, tex);
-    models.push_back(mod);
+    tex = new Texture();
+    tex->load(*pool, *textures, "./static/3.bmp");
+    quads.push_back(QuadModel({-1.0f, -1.0f, -2.0f},
+                              {-1.0f, -1.0f, 0.0f},
+                              {1.0f, -1.0f, -2.0f},
+                              mat, tex));
 //    //前墙
 //    mat = new Material(Material::wall);
-//    mod = new QuadModel({1.0f, 1.0f, 0.0f},
-//                        {1.0f, -1.0f, 0.0f},
-//                        {-1.0f, 1.0f, 0.0f},
-//                        mat);
-//    models.push_back(mod);
+//    quads.push_back(QuadModel({1.0f, 1.0f, 0.0f},
+//                              {1.0f, -1.0f, 0.0f},
+//                              {-1.0f, 1.0f, 0.0f},
+//                              mat));
     //玻璃球
     mat = new Material(Material::glass);
-    mod = new SphereModel({0.6f, -0.1f, -0.7f},
-                          0.25f, mat);
-    models.push_back(mod);
+    spheres.push_back(SphereModel({0.6f, -0.1f, -0.7f},
+                                  0.25f, mat));
     //塑料圆柱1
     mat = new Material(Material::plastic);
-    mod = new CylinderModel({0.6f, -1.0f, -0.7f},
-                            0.15f, 0.65f, mat);
-    models.push_back(mod);
+    cylinders.push_back(CylinderModel({0.6f, -1.0f, -0.7f},
+                                      0.15f, 0.65f, mat));
     //金属球
     mat = new Material(Material::metal);
-    mod = new SphereModel({0.4f, 0.15f, -1.5f},
-                          0.15f, mat);
-    models.push_back(mod);
+    spheres.push_back(SphereModel({0.4f, 0.15f, -1.5f},
+                                  0.15f, mat));
     //塑料圆柱2
     mat = new Material(Material::plastic);
-    mod = new CylinderModel({0.4f, -1.0f, -1.5f},
-                            0.1f, 1.0f, mat);
-    models.push_back(mod);
-    //旋转扫描模型
-    mat = new Material(Material::smoothChina);
-    tex = new Texture(".\\static\\2000.bmp");
-    mod = new CustomizedModel(".\\static\\goblet.obj", eyePos, mat, tex);
-    mod->trans(0.5f, {-0.6f, -0.2f - mod->getCenter().y * 0.5f, -1.5f});
-    mod->build();
-    models.push_back(mod);
+    cylinders.push_back(CylinderModel({0.4f, -1.0f, -1.5f},
+                                      0.1f, 1.0f, mat));
     //塑料圆柱3
     mat = new Material(Material::plastic);
-    mod = new CylinderModel({-0.6f, -1.0f, -1.5f},
-                            0.25, 0.8f, mat);
-    models.push_back(mod);
+    cylinders.push_back(CylinderModel({-0.6f, -1.0f, -1.5f},
+                                      0.25, 0.8f, mat));
     //塑料地球仪
     mat = new Material(Material::plastic);
-    tex = new Texture(".\\static\\10.bmp");
-    mod = new SphereModel({-0.1f, -0.6f, -1.0f},
-                          0.4f, mat, tex);
-    models.push_back(mod);
+    tex = new Texture();
+    tex->load(*pool, *textures, "./static/10.bmp");
+    spheres.push_back(SphereModel({-0.1f, -0.6f, -1.0f},
+                                  0.4f, mat, tex));
+    //旋转扫描模型：在工作线程中解析并建树，完成后在GL线程上传并加入场景
+    mat = new Material(Material::smoothChina);
+    tex = new Texture();
+    tex->load(*pool, *textures, "./static/2000.bmp");
+    pool->submit([this, mat, tex]() {
+        auto model = std::make_shared<CustomizedModel>("./static/goblet.obj", eyePos, mat, tex);
+        model->trans(0.5f, {-0.6f, -0.2f - model->getCenter().y * 0.5f, -1.5f});
+        model->build(true);
+        pool->post([this, model]() {
+            customized.push_back(std::move(*model));
+            return true;
+        });
+    });
 
     //记录开始时间
-    start = GetTickCount();
+    start = std::chrono::steady_clock::now();
 }
 
 Scene::~Scene() {
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteTextures(1, &tbo);
-}
-
-void Scene::setMaterial(const std::string &name, Material *material) {
-    tracerShader->setBool(name + ".lighting", material->lighting);
-    tracerShader->setVec3(name + ".color", material->color);
-    tracerShader->setFloat(name + ".specularRate", material->specularRate);
-    tracerShader->setFloat(name + ".specularTint", material->specularTint);
-    tracerShader->setFloat(name + ".specularRoughness", material->specularRoughness);
-    tracerShader->setFloat(name + ".refractRate", material->refractRate);
-    tracerShader->setFloat(name + ".refractTint", material->refractTint);
-    tracerShader->setFloat(name + ".refractIndex", material->refractIndex);
-    tracerShader->setFloat(name + ".refractRoughness", material->refractRoughness);
-}
-
-void Scene::setTexture(const std::string &name, Texture *texture, int id) {
-    if (texture != nullptr) {
-        tracerShader->setBool(name + ".useTexture", true);
-        //前18个纹理单元已被占用
-        texture->bind(GL_TEXTURE18 + id);
-        tracerShader->setInt(name + ".texture", 18 + id);
+    //先执行完加载任务，加载结果交给场景后再统一释放
+    delete pool;
+    delete textures;
+    delete sceneBuffer;
+    for (auto &variant : variants) delete variant.second;
+    delete wavefront;
+    delete previewShader;
+    delete renderShader;
+    glDeleteBuffers(1, &patch_tbo);
+    glDeleteTextures(1, &patch_tex);
+    glDeleteBuffers(1, &bvh_tbo);
+    glDeleteTextures(1, &bvh_tex);
+    glDeleteFramebuffers(2, fbo);
+    glDeleteTextures(2, tbo);
+    glDeleteQueries(1, &timer);
+    for (GLsync sync : inflight) glDeleteSync(sync);
+}
+
+void Scene::resolveUniforms() {
+    renderUniforms.maxFrame = renderShader->uniform<GLint>("maxFrame");
+    renderUniforms.frameBuffer = renderShader->uniform<GLint>("frameBuffer");
+    renderShader->use();
+    renderUniforms.maxFrame.set(MAX_FRAME);
+    renderUniforms.frameBuffer.set(0);
+}
+
+void Scene::resolveTracerUniforms(Shader *shader) {
+    const Shader &tracer = *shader;
+    tracerUniforms.width = tracer.uniform<GLint>("width");
+    tracerUniforms.height = tracer.uniform<GLint>("height");
+    tracerUniforms.frame = tracer.uniform<GLint>("frame");
+    tracerUniforms.samples = tracer.uniform<GLint>("samples");
+    tracerUniforms.maxFrame = tracer.uniform<GLint>("maxFrame");
+    tracerUniforms.maxDepth = tracer.uniform<GLint>("maxDepth");
+    tracerUniforms.rouletteDepth = tracer.uniform<GLint>("rouletteDepth");
+    tracerUniforms.eyePos = tracer.uniform<Vector3f>("eyePos");
+    tracerUniforms.V = tracer.uniform<GLuint>("V");
+    tracerUniforms.lastFrame = tracer.uniform<GLint>("lastFrame");
+    tracerUniforms.textures = tracer.uniform<GLint>("textures");
+    tracerUniforms.patchTex = tracer.uniform<GLint>("patchTex");
+    tracerUniforms.bvhTex = tracer.uniform<GLint>("bvhTex");
+
+    //uniform的值保存在程序对象中，常量只在程序可用时设置一次
+    shader->use();
+    tracerUniforms.width.set(ORI_WIDTH);
+    tracerUniforms.height.set(ORI_HEIGHT);
+    tracerUniforms.maxFrame.set(MAX_FRAME);
+    tracerUniforms.maxDepth.set(maxDepth);
+    tracerUniforms.rouletteDepth.set(rouletteDepth);
+    tracerUniforms.eyePos.set(eyePos);
+    tracerUniforms.V.set(sobol, 64);
+    tracerUniforms.lastFrame.set(0);
+    //纹理数组在分配时已绑定到固定的纹理单元
+    tracerUniforms.textures.set(TEXTURE_ARRAY_UNIT);
+    tracerUniforms.patchTex.set(16);
+    tracerUniforms.bvhTex.set(17);
+}
+
+std::string Scene::signature() {
+    bool texture = false, refract = false;
+    forEachModels([&](auto &models) {
+        for (auto &model : models) {
+            texture = texture || (model.getTexture() != nullptr && model.getTexture()->isReady());
+            refract = refract || model.getMaterial()->refractRate > 0.0f;
+        }
+    });
+
+    std::ostringstream defines;
+    defines << "#define SPECIALIZED\n"
+            << "#define QUAD_NUM " << quads.size() << "\n"
+            << "#define SPHERE_NUM " << spheres.size() << "\n"
+            << "#define CYLINDER_NUM " << cylinders.size() << "\n"
+            << "#define CUSTOMIZED_NUM " << customized.size() << "\n"
+            << "#define USE_TEXTURE " << (texture ? "true" : "false") << "\n"
+            << "#define USE_REFRACT " << (refract ? "true" : "false") << "\n"
+            << "#define ACCUMULATE_BLEND " << (accumulate == BLEND ? "true" : "false") << "\n";
+    return defines.str();
+}
+
+void Scene::selectVariant() {
+    std::string defines = signature();
+    if (defines == variantDefines) return;
+    if (wavefront != nullptr) {
+        wavefront->select(defines);
+    } else {
+        Shader *&variant = variants[defines];
+        if (variant == nullptr) variant = Shader::compileAsync(vertSource.c_str(), tracerSource.c_str(), defines);
+        tracerShader = variant;
+    }
+    variantDefines = defines;
+    resolved = false;
+    previewed = false;
+}
+
+bool Scene::tracerReady() {
+    if (resolved) return true;
+    //驱动不支持并行编译时ready()会等待编译完成，先显示一帧预览再等待
+    if (wavefront != nullptr) {
+        if (!wavefront->isLinked() && !previewed) return false;
+        if (!wavefront->ready()) return false;
+        //各阶段与片元着色器共用场景描述与常量
+        wavefront->forEachKernel([this](Shader *kernel) { resolveTracerUniforms(kernel); });
+        wavefront->resolve();
     } else {
-        tracerShader->setBool(name + ".useTexture", false);
+        if (!tracerShader->isLinked() && !previewed) return false;
+        if (!tracerShader->ready()) return false;
+        resolveTracerUniforms(tracerShader);
+    }
+    resolved = true;
+    frame = 0;
+    finished = false;
+    start = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool Scene::renderPreview() {
+    //预览只有主光线求交，编译开销远小于完整的路径追踪；支持并行编译时尚未完成则本次不绘制
+    previewed = true;
+    if (!previewShader->ready()) return false;
+    if (!previewResolved) {
+        //与光线追踪着色器共用常量，之后解析当前变体时会重新设置tracerUniforms
+        resolveTracerUniforms(previewShader);
+        previewUniforms.quadNum = previewShader->uniform<GLint>("quadNum");
+        previewUniforms.sphereNum = previewShader->uniform<GLint>("sphereNum");
+        previewUniforms.cylinderNum = previewShader->uniform<GLint>("cylinderNum");
+        previewUniforms.customizedNum = previewShader->uniform<GLint>("customizedNum");
+        previewResolved = true;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    previewShader->use();
+    previewUniforms.quadNum.set((GLint)quads.size());
+    previewUniforms.sphereNum.set((GLint)spheres.size());
+    previewUniforms.cylinderNum.set((GLint)cylinders.size());
+    previewUniforms.customizedNum.set((GLint)customized.size());
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_QUADS, 0, 4);
+    return true;
+}
+
+void Scene::markDirty() {
+    dirty = true;
+    forEachModels([](auto &models) {
+        for (auto &model : models) model.setDirty(true);
+    });
+}
+
+//模型的纹理信息写入缓冲中的对应字段
+template <typename T>
+static void setTexture(T &data, Texture *texture) {
+    data.useTexture = texture != nullptr && texture->isReady();
+    data.layer = data.useTexture ? texture->getLayer() : 0;
+    data.uvTransform = data.useTexture ? texture->getUVTransform() : Vector4f{1.0f, 1.0f, 0.0f, 0.0f};
+}
+
+static MaterialData toData(const Material *m) {
+    return {m->color, m->specularRate,
+            m->specularTint, m->specularRoughness, m->refractRate, m->refractTint,
+            m->refractIndex, m->refractRoughness, m->lighting, 0.0f};
+}
+
+static QuadData toData(QuadModel &model, int material) {
+    QuadData data{};
+    for (int i = 0; i < 4; i++) {
+        const Vector3f &v = model.getSamples()[i];
+        data.samples[i] = {v.x, v.y, v.z, 0.0f};
     }
+    data.normal = model.getNormal();
+    data.material = material;
+    setTexture(data, model.getTexture());
+    return data;
 }
 
-void Scene::setQuad(const std::string &name, Model *model) {
-    tracerShader->setVec3(name + ".quad.samples", model->getSamples(), 4);
-    tracerShader->setVec3(name + ".quad.normal", model->getNormal());
-    setMaterial(name + ".material", model->getMaterial());
-    setTexture(name, model->getTexture(), model->getId());
+static SphereData toData(SphereModel &model, int material) {
+    SphereData data{};
+    data.center = model.getCenter();
+    data.radius = model.getRadius();
+    data.material = material;
+    setTexture(data, model.getTexture());
+    return data;
 }
 
-void Scene::setSphere(const std::string &name, Model *model) {
-    tracerShader->setVec3(name + ".sph.center", model->getCenter());
-    tracerShader->setFloat(name + ".sph.radius", model->getRadius());
-    setMaterial(name + ".material", model->getMaterial());
-    setTexture(name, model->getTexture(), model->getId());
+static CylinderData toData(CylinderModel &model, int material) {
+    CylinderData data{};
+    data.center = model.getCenter();
+    data.radius = model.getRadius();
+    data.height = model.getHeight();
+    data.material = material;
+    setTexture(data, model.getTexture());
+    return data;
 }
 
-void Scene::setCylinder(const std::string &name, Model *model) {
-    tracerShader->setVec3(name + ".cyl.center", model->getCenter());
-    tracerShader->setFloat(name + ".cyl.radius", model->getRadius());
-    tracerShader->setFloat(name + ".cyl.height", model->getHeight());
-    setMaterial(name + ".material", model->getMaterial());
-    setTexture(name, model->getTexture(), model->getId());
+static CustomizedData toData(CustomizedModel &model, int material) {
+    CustomizedData data{};
+    data.center = model.getCenter();
+    data.height = model.getHeight();
+    data.material = material;
+    setTexture(data, model.getTexture());
+    return data;
 }
 
-void Scene::setCustomized(const std::string &name, Model *model) {
+void Scene::uploadGeometry() {
+    std::vector<Patch> patches;
+    std::vector<LinearNode> nodes;
+    for (auto &model : customized) {
+        patches.insert(patches.end(), model.getPatches(), model.getPatches() + model.getPatchNum());
+        nodes.insert(nodes.end(), model.getBVH(), model.getBVH() + model.getBVHNum());
+    }
+    //缓冲不能为空，没有网格模型时保留一个元素
+    patches.resize(std::max<size_t>(patches.size(), 1));
+    nodes.resize(std::max<size_t>(nodes.size(), 1));
+
+    glBindBuffer(GL_TEXTURE_BUFFER, patch_tbo);
+    glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(sizeof(Patch) * patches.size()), patches.data(), GL_STATIC_DRAW);
     glActiveTexture(GL_TEXTURE16);
-    glBindTexture(GL_TEXTURE_BUFFER, model->getPatchTex());
-    tracerShader->setInt(name + ".patchTex", 16);
+    glBindTexture(GL_TEXTURE_BUFFER, patch_tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, patch_tbo);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, bvh_tbo);
+    glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(sizeof(LinearNode) * nodes.size()), nodes.data(), GL_STATIC_DRAW);
     glActiveTexture(GL_TEXTURE17);
-    glBindTexture(GL_TEXTURE_BUFFER, model->getBVHTex());
-    tracerShader->setInt(name + ".bvhTex", 17);
-    tracerShader->setVec3(name + ".center", model->getCenter());
-    tracerShader->setFloat(name + ".height", model->getHeight());
-    setMaterial(name + ".material", model->getMaterial());
-    setTexture(name, model->getTexture(), model->getId());
+    glBindTexture(GL_TEXTURE_BUFFER, bvh_tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, bvh_tbo);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Scene::uploadScene() {
+    bool changed = dirty;
+    forEachModels([&](auto &models) {
+        for (auto &model : models)
+            changed = changed || model.isDirty() || model.getMaterial()->dirty;
+    });
+    if (!changed) return;
+
+    if (dirty) {
+        selectVariant();
+        uploadGeometry();
+        dirty = false;
+    }
+
+    //材质表：多个模型共用的材质只存放一次
+    std::vector<MaterialData> materials;
+    std::unordered_map<const Material *, int> index;
+    auto materialIndex = [&](const Material *m) {
+        auto it = index.find(m);
+        if (it != index.end()) return it->second;
+        materials.push_back(toData(m));
+        return index[m] = (int)materials.size() - 1;
+    };
+
+    //各类模型转换为缓冲中的布局，并清除变化标记
+    auto convert = [&](auto &models) {
+        std::vector<decltype(toData(models[0], 0))> data;
+        for (auto &model : models) {
+            data.push_back(toData(model, materialIndex(model.getMaterial())));
+            model.setDirty(false);
+        }
+        return data;
+    };
+    std::vector<QuadData> quadData = convert(quads);
+    std::vector<SphereData> sphereData = convert(spheres);
+    std::vector<CylinderData> cylinderData = convert(cylinders);
+    std::vector<CustomizedData> customizedData = convert(customized);
+
+    //网格模型的面片与结点在合并后的数组中的起始下标
+    int node_offset = 0, patch_offset = 0;
+    for (int i = 0; i < (int)customized.size(); i++) {
+        customizedData[i].nodeOffset = node_offset;
+        customizedData[i].patchOffset = patch_offset;
+        node_offset += customized[i].getBVHNum();
+        patch_offset += customized[i].getPatchNum();
+    }
+
+    forEachModels([](auto &models) {
+        for (auto &model : models) model.getMaterial()->dirty = false;
+    });
+
+    sceneBuffer->clear();
+    sceneBuffer->add(materials);
+    sceneBuffer->add(quadData);
+    sceneBuffer->add(sphereData);
+    sceneBuffer->add(cylinderData);
+    sceneBuffer->add(customizedData);
+    sceneBuffer->upload();
+}
+
+void Scene::adjustSamples() {
+    if (timedSamples == 0) return;
+    //结果未就绪时不等待，下一帧再读取
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(timer, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(timer, GL_QUERY_RESULT, &elapsed);
+    double sampleTime = (double)elapsed * 1e-6 / timedSamples;
+    passSamples = std::max(1, std::min(MAX_PASS_SAMPLES, (int)(PASS_TIME / std::max(sampleTime, 1e-3))));
+    timedSamples = 0;
 }
 
 void Scene::hitModel(GLfloat x, GLfloat y) {
     Vector3f screenPoint = {x, y, 0.0f};
     Ray r = {normalize(screenPoint - eyePos), eyePos};
-    GLfloat minDist = 10.0f, t;
-    int size = (int)models.size(), hit = -1;
+    HitInfo info{};
 
-    for (int i = 0; i < size; i++) {
-        t = models[i]->hit(r);
-        if (t > 0 && t < minDist) {
-            minDist = t;
-            hit = i;
-        }
-    }
+    //与着色器相同的最近交点判断，保证选中的是可见物体
+    ModelRef hit = intersect(r, info);
 
-    if (hit != -1) {
-        models[hit]->setLighting();
+    if (hit.index != -1) {
+        getModel(hit)->setLighting();
         //重置
         frame = 0;
         finished = false;
-        start = GetTickCount();
+        start = std::chrono::steady_clock::now();
     }
 }
 
-void Scene::render() {
-    int nums[4]{};
-    char buf[20];
+//模型数组对应的模型类别
+template <typename T>
+static constexpr MODEL_TYPE typeOf(const std::vector<T> &) {
+    return T::TYPE;
+}
 
-    if (!finished) {
-        //绑定自定义帧缓存
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        tracerShader->use();
-        tracerShader->setInt("width", ORI_WIDTH);
-        tracerShader->setInt("height", ORI_HEIGHT);
-        tracerShader->setInt("frame", frame);
-        tracerShader->setInt("maxFrame", MAX_FRAME);
-        tracerShader->setVec3("eyePos", eyePos);
-        tracerShader->setUint("V", (GLuint *) sobol, 64);
-
-        //将前一帧的纹理加载到光线追踪着色器中
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tbo);
-        tracerShader->setInt("lastFrame", 0);
-
-        //将模型数据导入光线追踪着色器
-        for (auto model: models) {
-            switch (model->type()) {
-                case QUAD:
-                    sprintf(buf, "quads[%d]", nums[QUAD]++);
-                    setQuad(buf, model);
-                    break;
-                case SPHERE:
-                    sprintf(buf, "spheres[%d]", nums[SPHERE]++);
-                    setSphere(buf, model);
-                    break;
-                case CYLINDER:
-                    sprintf(buf, "cylinders[%d]", nums[CYLINDER]++);
-                    setCylinder(buf, model);
-                    break;
-                case CUSTOMIZED:
-                    setCustomized("customized", model);
-                    break;
-                default:
-                    break;
-            }
+//在同一类模型中求最近交点
+template <typename T>
+static void hitModels(std::vector<T> &models, const Ray &r, HitInfo &hit, int &index) {
+    int size = (int)models.size();
+    for (int i = 0; i < size; i++) {
+        if (models[i].hit(r, hit)) index = i;
+    }
+}
+
+Scene::ModelRef Scene::intersect(const Ray &r, HitInfo &hit) {
+    ModelRef ref = {QUAD, -1};
+    hit.distance = INF;
+    forEachModels([&](auto &models) {
+        int index = -1;
+        hitModels(models, r, hit, index);
+        if (index != -1) ref = {typeOf(models), index};
+    });
+    return ref;
+}
+
+Model *Scene::getModel(ModelRef ref) {
+    switch (ref.type) {
+        case QUAD:
+            return &quads[ref.index];
+        case SPHERE:
+            return &spheres[ref.index];
+        case CYLINDER:
+            return &cylinders[ref.index];
+        case CUSTOMIZED:
+            return &customized[ref.index];
+        default:
+            return nullptr;
+    }
+}
+
+void Scene::finishHit(HitInfo &hit, ModelRef ref) {
+    if (ref.index == -1) {
+        hit.id = -1;
+        hit.uv = {0.0f, 0.0f};
+        return;
+    }
+    hit.id = getModel(ref)->getId();
+    switch (ref.type) {
+        case QUAD:
+            hit.uv = quads[ref.index].texCoord(hit);
+            break;
+        case SPHERE:
+            hit.uv = spheres[ref.index].texCoord(hit);
+            break;
+        case CYLINDER:
+            hit.uv = cylinders[ref.index].texCoord(hit);
+            break;
+        case CUSTOMIZED:
+            hit.uv = customized[ref.index].texCoord(hit);
+            break;
+        default:
+            break;
+    }
+}
+
+void Scene::intersect(const Ray *rays, HitInfo *hits, int n) {
+    int i = 0;
+
+    //方向一致的光线按包求交
+    for (; i + PACKET_SIZE <= n; i += PACKET_SIZE) {
+        if (!coherent(rays + i)) {
+            for (int j = i; j < i + PACKET_SIZE; j++)
+                finishHit(hits[j], intersect(rays[j], hits[j]));
+            continue;
+        }
+
+        RayPacket packet(rays + i);
+        ModelRef refs[PACKET_SIZE];
+        for (int j = 0; j < PACKET_SIZE; j++) {
+            hits[i + j].distance = INF;
+            refs[j] = {QUAD, -1};
         }
+        forEachModels([&](auto &models) {
+            int size = (int)models.size();
+            for (int k = 0; k < size; k++) {
+                int mask = models[k].hit4(packet, hits + i);
+                for (int j = 0; j < PACKET_SIZE; j++)
+                    if (mask >> j & 1) refs[j] = {typeOf(models), k};
+            }
+        });
+        for (int j = 0; j < PACKET_SIZE; j++) finishHit(hits[i + j], refs[j]);
+    }
+
+    //剩余的光线逐条求交
+    for (; i < n; i++) finishHit(hits[i], intersect(rays[i], hits[i]));
+}
 
-        tracerShader->setInt("quadNum", nums[QUAD]);
-        tracerShader->setInt("sphereNum", nums[SPHERE]);
-        tracerShader->setInt("cylinderNum", nums[CYLINDER]);
+void Scene::trace() {
+    //重新开始累积时清空之前的结果
+    if (frame == 0) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[current]);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
 
-        //将渲染结果加载到纹理中
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, tbo, 0);
+    adjustSamples();
+    int samples = std::max(1, std::min(passSamples, MAX_FRAME - frame));
 
-        //绘制屏幕像素
-        glBindVertexArray(VAO);
-        glEnableVertexAttribArray(1);
-        glDrawArrays(GL_QUADS, 0, 4);
+    //同一时刻只有一个计时中的查询；波前后端逐个样本追踪，在累积纹理上原处相加
+    bool timing = timedSamples == 0;
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, timer);
+    if (wavefront != nullptr) {
+        for (int i = 0; i < samples; i++) wavefront->trace(tbo[current], frame + i, maxDepth);
+    } else {
+        traceFragment(samples);
+    }
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        timedSamples = samples;
     }
 
-    //重新绑定到默认帧缓存
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    renderShader->use();
-    renderShader->setInt("maxFrame", MAX_FRAME);
+    //更新帧数
+    frame += samples;
+    if (frame >= MAX_FRAME) {
+        finished = true;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double rate = MAX_FRAME / elapsed.count();
+        std::cout << "fn: " << MAX_FRAME << " fps: " << rate << std::endl;
+    }
+}
 
-    //将当前帧的纹理加载到绘制着色器中
+void Scene::traceFragment(int samples) {
+    //交替读写时读取最新结果，写入另一个缓冲，避免同一纹理既被读取又被写入
+    if (accumulate == PING_PONG) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, tbo[current]);
+        current = 1 - current;
+    } else {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo[current]);
+    tracerShader->use();
+    tracerUniforms.frame.set(frame);
+    tracerUniforms.samples.set(samples);
+
+    //绘制屏幕像素
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_QUADS, 0, 4);
+    glDisable(GL_BLEND);
+}
+
+void Scene::present() {
+    //绑定到默认帧缓存，从0号纹理单元读取最新的累积结果
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tbo);
-    renderShader->setInt("frameBuffer", 0);
+    glBindTexture(GL_TEXTURE_2D, tbo[current]);
+    renderShader->use();
 
     //再次绘制屏幕像素
     glBindVertexArray(VAO);
-    glEnableVertexAttribArray(1);
     glDrawArrays(GL_QUADS, 0, 4);
+    presented = std::chrono::steady_clock::now();
+}
 
-    //更新帧数
-    if (frame < MAX_FRAME) {
-        frame++;
-    } else if (!finished){
-        finished = true;
-        double rate = 1000.0 * MAX_FRAME / (GetTickCount() - start);
-        std::cout << "fn: " << MAX_FRAME << " fps: " << rate << std::endl;
+void Scene::retirePasses(double timeout) {
+    //已满时最多等待到下次显示，避免空转
+    if (inflight.size() >= MAX_INFLIGHT && timeout > 0.0)
+        glClientWaitSync(inflight.front(), GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)(timeout * 1e6));
+    while (!inflight.empty()) {
+        GLenum status = glClientWaitSync(inflight.front(), 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(inflight.front());
+        inflight.pop_front();
     }
 }
+
+bool Scene::render() {
+    //执行加载完成的GL上传，场景变化时重新累积
+    if (pool->poll()) {
+        markDirty();
+        frame = 0;
+        finished = false;
+        start = std::chrono::steady_clock::now();
+    }
+
+    //只上传变化的部分，场景变化时可能切换着色器变体；稳定状态下每帧只更新frame
+    uploadScene();
+    if (!tracerReady()) return renderPreview();
+
+    //距下次显示的时间（毫秒）
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - presented;
+    double remaining = 1000.0 / presentRate - elapsed.count();
+
+    //GPU空出位置时继续累积，累积速度只受光线追踪限制
+    if (!finished) {
+        retirePasses(remaining);
+        if (inflight.size() < MAX_INFLIGHT) {
+            trace();
+            inflight.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        }
+    }
+
+    //按固定频率显示，其余调用只提交命令
+    if (!finished && remaining > 0.0) {
+        glFlush();
+        return false;
+    }
+    present();
+    return true;
+}
+
+void Scene::setMaxDepth(int depth) {
+    //重新解析uniform时设置新的值，并清空之前的累积结果
+    maxDepth = std::max(1, depth);
+    resolved = false;
+}
+
+void Scene::setRouletteDepth(int depth) {
+    rouletteDepth = std::max(1, depth);
+    resolved = false;
+}
+
+void Scene::setPresentRate(double rate) {
+    //至少每秒显示一次
+    presentRate = std::max(1.0, rate);
+}
@@ -1,44 +1,174 @@
 #pragma once
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
 #include <random>
+#include <chrono>
 #include <GL/glew.h>
 
 #include "shader/shader.h"
 #include "model/model.h"
 #include "material/material.h"
+#include "loader/threadpool.h"
+#include "scenebuffer.h"
+#include "wavefront.h"
 
 #define MAX_FRAME 2048
+#define MAX_DEPTH 6 //路径追踪默认的最大反弹次数
+#define ROULETTE_DEPTH 3 //默认从第几次反弹后开始俄罗斯轮盘
+#define MAX_PASS_SAMPLES 64 //每次绘制的最大样本数
+#define PASS_TIME 16.0      //每次绘制的目标耗时（毫秒），据此调整每次绘制的样本数
+#define PRESENT_RATE 30.0   //默认每秒显示的次数，累积不受显示频率限制
+#define MAX_INFLIGHT 2      //GPU上未完成的追踪绘制数上限
+
+//累积方式：加法混合到同一个缓冲，或在两个缓冲间交替读写
+enum ACCUMULATE_MODE {BLEND, PING_PONG};
+//光线追踪后端：片元着色器逐像素追踪完整路径，或计算着色器按波前分阶段追踪
+enum TRACER_BACKEND {FRAGMENT, WAVEFRONT};
 
 class Scene {
 private:
     bool finished = false;
-    DWORD start;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point presented; //上次显示的时间
+
+    int frame = 0; //已累积的样本数
+    int maxDepth = MAX_DEPTH; //最大反弹次数，以uniform传入着色器，修改时无需重新编译
+    int rouletteDepth = ROULETTE_DEPTH; //反弹次数达到后开始俄罗斯轮盘，不小于maxDepth时不启用
+    double presentRate = PRESENT_RATE; //每秒显示的次数
+    //累积结果：加法混合只使用第一个缓冲，交替读写时current为最新结果所在的缓冲
+    const ACCUMULATE_MODE accumulate;
+    GLuint fbo[2]{};
+    GLuint tbo[2]{};
+    int current = 0;
+    //波前追踪后端，使用片元着色器时为空
+    Wavefront *wavefront{};
 
-    int frame = 0;
-    GLuint fbo{};
-    GLuint tbo{};
+    //资源加载线程池
+    ThreadPool *pool;
+    //所有模型共用的纹理数组
+    TextureArray *textures;
 
     //着色器
-    Shader *tracerShader; //光线追踪着色器
-    Shader *renderShader; //绘制着色器
+    Shader *tracerShader{};  //光线追踪着色器：当前场景对应的特化变体，异步编译
+    Shader *previewShader;   //预览着色器：当前变体编译完成前显示，只输出主光线击中点的反照率，不随变体切换
+    Shader *renderShader;    //绘制着色器
+    //着色器源码：运行时从文件读取，修改后无需重新生成shaderBuf.h
+    std::string vertSource, tracerSource;
+    //光线追踪着色器的特化变体，以场景签名（注入的宏定义）为键缓存；波前后端的变体由Wavefront缓存
+    std::unordered_map<std::string, Shader *> variants;
+    std::string variantDefines;   //当前变体的宏定义
+    bool resolved = false;        //当前变体已编译完成并设置了常量
+    bool previewed = false;       //当前变体已显示过预览
+    bool previewResolved = false; //预览着色器已编译完成并设置了常量
+
+    //模型：每类模型存放在各自的连续数组中
+    std::vector<QuadModel> quads;
+    std::vector<SphereModel> spheres;
+    std::vector<CylinderModel> cylinders;
+    std::vector<CustomizedModel> customized;
+
+    //模型引用：类别与在对应数组中的下标
+    struct ModelRef {
+        MODEL_TYPE type;
+        int index;
+    };
+
+    //对每类模型数组调用f，f为以模型数组为参数的泛型函数
+    template <typename F>
+    void forEachModels(F &&f) {
+        f(quads);
+        f(spheres);
+        f(cylinders);
+        f(customized);
+    }
+
+    //光线追踪着色器的全局变量
+    struct {
+        Uniform<GLint> width, height, frame, maxFrame, maxDepth, rouletteDepth, samples;
+        Uniform<Vector3f> eyePos;
+        Uniform<GLuint> V;
+        Uniform<GLint> lastFrame, textures, patchTex, bvhTex;
+    } tracerUniforms;
 
-    //模型
-    std::vector<Model *> models;
+    //绘制着色器的全局变量
+    struct {
+        Uniform<GLint> maxFrame, frameBuffer;
+    } renderUniforms;
 
-    //传递uniform变量的工具函数
-    void setMaterial(const std::string &name, Material *material);
-    void setTexture(const std::string &name, Texture *texture, int id);
-    void setQuad(const std::string &name, Model *model);
-    void setSphere(const std::string &name, Model *model);
-    void setCylinder(const std::string &name, Model *model);
-    void setCustomized(const std::string &name, Model *model);
+    //预览着色器不特化，模型数量每次绘制时设置
+    struct {
+        Uniform<GLint> quadNum, sphereNum, cylinderNum, customizedNum;
+    } previewUniforms;
+
+    //场景描述：材质表与各类模型数组
+    SceneBuffer *sceneBuffer;
+    //所有网格模型合并后的面片与BVH树，以纹理缓冲读取
+    GLuint patch_tbo{}, patch_tex{};
+    GLuint bvh_tbo{}, bvh_tex{};
+
+    //每次绘制的样本数，由计时查询测得的耗时调整
+    int passSamples = 1;
+    GLuint timer{};       //绘制耗时的计时查询
+    int timedSamples = 0; //计时中的绘制的样本数，为0时没有未完成的查询
+    //已提交但未完成的追踪绘制的栅栏
+    std::deque<GLsync> inflight;
+
+    //模型数量或纹理等场景状态变化，需要重新上传
+    bool dirty = true;
+
+    //解析绘制着色器的uniform句柄，并设置常量
+    void resolveUniforms();
+    //解析光线追踪着色器（变体或预览）的uniform句柄，并设置不随场景变化的常量
+    void resolveTracerUniforms(Shader *shader);
+    //场景签名：模型数量与用到的特性，以宏定义的形式注入着色器
+    std::string signature();
+    //切换到当前场景签名对应的变体，首次使用时开始异步编译
+    void selectVariant();
+    //当前变体是否可用，编译刚完成时解析uniform并重新开始累积
+    bool tracerReady();
+    //变体编译期间直接绘制预览到默认帧缓存，预览着色器尚未编译完成时不绘制，返回是否绘制
+    bool renderPreview();
+    //读取已完成的计时查询，按单个样本的耗时调整每次绘制的样本数
+    void adjustSamples();
+    //累积一次绘制的样本，并计时以调整样本数
+    void trace();
+    //片元着色器后端：在帧缓存中累积samples个样本
+    void traceFragment(int samples);
+    //将累积结果伽马校正后绘制到默认帧缓存
+    void present();
+    //回收已完成的追踪绘制；未完成的已达上限时最多等待timeout毫秒
+    void retirePasses(double timeout);
+    //标记所有模型需要重新上传
+    void markDirty();
+    //有模型或材质变化时重新生成场景描述，一次写入缓冲
+    void uploadScene();
+    //合并所有网格模型的面片与BVH树，上传到纹理缓冲
+    void uploadGeometry();
+
+    //单条光线求最近交点，返回击中的模型，未击中时下标为-1
+    ModelRef intersect(const Ray &r, HitInfo &hit);
+    //补全击中信息中的模型编号与纹理坐标
+    void finishHit(HitInfo &hit, ModelRef ref);
+    Model *getModel(ModelRef ref);
 
 public:
-    Scene();
+    explicit Scene(ACCUMULATE_MODE accumulate = BLEND, TRACER_BACKEND backend = FRAGMENT);
     ~Scene();
     void hitModel(GLfloat x, GLfloat y);
-    void render();
+    //累积并按固定频率显示，返回是否绘制了需要交换缓冲的画面
+    bool render();
+    //设置最大反弹次数并重新开始累积
+    void setMaxDepth(int depth);
+    //设置开始俄罗斯轮盘的反弹次数并重新开始累积
+    void setRouletteDepth(int depth);
+    //设置每秒显示的次数，不影响已累积的结果
+    void setPresentRate(double rate);
+
+    //批量求交：为rays中的n条光线计算最近交点，写入hits
+    void intersect(const Ray *rays, HitInfo *hits, int n);
 
 private:
     const Vector3f eyePos = {0.0f, 0.0f, 4.0f};
@@ -0,0 +1,42 @@
+#include "scenebuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+SceneBuffer::SceneBuffer(GLuint binding): binding(binding) {
+    glGenBuffers(1, &buffer);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+}
+
+SceneBuffer::~SceneBuffer() {
+    glDeleteBuffers(1, &buffer);
+}
+
+void SceneBuffer::clear() {
+    data.clear();
+    offsets.clear();
+}
+
+void SceneBuffer::append(const void *items, size_t size, size_t stride) {
+    size_t offset = (data.size() + alignment - 1) / alignment * alignment;
+    offsets.push_back((GLintptr)offset);
+    data.resize(offset + std::max(size, stride), 0);
+    if (size > 0) memcpy(data.data() + offset, items, size);
+}
+
+void SceneBuffer::upload() {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    auto size = (GLsizeiptr)data.size();
+    if (size > capacity) {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size, data.data(), GL_DYNAMIC_DRAW);
+        capacity = size;
+    } else {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data.data());
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    offsets.push_back((GLintptr)data.size());
+    for (int i = 0; i + 1 < (int)offsets.size(); i++)
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding + i, buffer, offsets[i], offsets[i + 1] - offsets[i]);
+    offsets.pop_back();
+}
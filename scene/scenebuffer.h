@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+
+#include "config/config.h"
+
+//场景描述的首个绑定点，与tracer.frag中的着色器存储块一致
+#define SCENE_BINDING 0
+
+/*****************************************************
+ * 着色器存储缓冲中的数据：与tracer.frag中的结构体按std430布局一一对应
+ *****************************************************/
+
+struct MaterialData {
+    Vector3f color;
+    GLfloat specularRate;
+    GLfloat specularTint, specularRoughness, refractRate, refractTint;
+    GLfloat refractIndex, refractRoughness;
+    GLint lighting;
+    GLfloat pad;
+};
+
+struct QuadData {
+    Vector4f samples[4]; //vec3数组的步长为16字节
+    Vector3f normal;
+    GLfloat pad0;
+    GLint material, useTexture, layer, pad1;
+    Vector4f uvTransform;
+};
+
+struct SphereData {
+    Vector3f center;
+    GLfloat radius;
+    GLint material, useTexture, layer, pad;
+    Vector4f uvTransform;
+};
+
+struct CylinderData {
+    Vector3f center;
+    GLfloat radius;
+    GLfloat height, pad0[3];
+    GLint material, useTexture, layer, pad1;
+    Vector4f uvTransform;
+};
+
+struct CustomizedData {
+    Vector3f center;
+    GLfloat height;
+    GLint material, useTexture, layer, nodeOffset;
+    GLint patchOffset, pad[3];
+    Vector4f uvTransform;
+};
+
+static_assert(sizeof(MaterialData) == 48, "MaterialData must match std430 layout");
+static_assert(sizeof(QuadData) == 112, "QuadData must match std430 layout");
+static_assert(sizeof(SphereData) == 48, "SphereData must match std430 layout");
+static_assert(sizeof(CylinderData) == 64, "CylinderData must match std430 layout");
+static_assert(sizeof(CustomizedData) == 64, "CustomizedData must match std430 layout");
+
+//由多段数组组成的着色器存储缓冲，第i段绑定到binding + i，所有段在内存中拼接后一次写入
+class SceneBuffer {
+private:
+    GLuint buffer{};
+    GLuint binding;
+    GLsizeiptr capacity{};
+    GLint alignment{}; //段起始偏移的对齐要求
+    std::vector<unsigned char> data;
+    std::vector<GLintptr> offsets;
+
+    void append(const void *items, size_t size, size_t stride);
+
+public:
+    explicit SceneBuffer(GLuint binding);
+    SceneBuffer(const SceneBuffer &) = delete;
+    ~SceneBuffer();
+
+    //清空已追加的数据
+    void clear();
+    //追加一段数组，空数组按一个元素占位，以保证绑定范围有效
+    template <typename T>
+    void add(const std::vector<T> &items) {
+        append(items.data(), items.size() * sizeof(T), sizeof(T));
+    }
+    //写入缓冲并绑定各段，容量不足时重新分配
+    void upload();
+};
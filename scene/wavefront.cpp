@@ -0,0 +1,94 @@
+#include "wavefront.h"
+
+#include "shader/shaderBuf.h"
+
+Wavefront::Wavefront(int width, int height): pathNum(width * height) {
+    source = Shader::loadSource(SHADER_DIR "wavefront.comp", wavefront_comp);
+
+    //缓冲只在GPU上读写，分配后绑定到固定的绑定点
+    const GLsizeiptr sizes[3] = {
+            (GLsizeiptr)sizeof(PathData) * pathNum,
+            (GLsizeiptr)sizeof(HitData) * pathNum,
+            (GLsizeiptr)(sizeof(QueueHeader) + 2 * sizeof(GLuint) * pathNum)};
+    glGenBuffers(3, buffers);
+    for (int i = 0; i < 3; i++) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[i]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizes[i], nullptr, GL_DYNAMIC_COPY);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, WAVEFRONT_BINDING + i, buffers[i]);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+Wavefront::~Wavefront() {
+    for (auto &variant : variants) forEach(variant.second, [](Shader *kernel) { delete kernel; });
+    glDeleteBuffers(3, buffers);
+}
+
+void Wavefront::select(const std::string &defines) {
+    auto it = variants.find(defines);
+    if (it == variants.end()) {
+        auto compile = [&](const char *kernel) {
+            return Shader::computeAsync(source.c_str(), defines + "#define " + kernel + "\n");
+        };
+        Kernels k{compile("KERNEL_GENERATE"), compile("KERNEL_EXTEND"), compile("KERNEL_SHADE"),
+                  compile("KERNEL_PREPARE"), compile("KERNEL_ACCUMULATE")};
+        it = variants.emplace(defines, k).first;
+    }
+    kernels = &it->second;
+}
+
+bool Wavefront::ready() {
+    bool result = true;
+    forEach(*kernels, [&](Shader *kernel) { result = kernel->ready() && result; });
+    return result;
+}
+
+bool Wavefront::isLinked() {
+    bool result = true;
+    forEach(*kernels, [&](Shader *kernel) { result = result && kernel->isLinked(); });
+    return result;
+}
+
+void Wavefront::resolve() {
+    uniforms.frame = kernels->generate->uniform<GLint>("frame");
+    uniforms.extendQueue = kernels->extend->uniform<GLint>("queueIn");
+    uniforms.shadeQueue = kernels->shade->uniform<GLint>("queueIn");
+    uniforms.prepareQueue = kernels->prepare->uniform<GLint>("queueIn");
+}
+
+void Wavefront::trace(GLuint texture, int frame, int maxDepth) {
+    const GLbitfield barrier = GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT;
+    glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffers[2]);
+    GLuint groups = (pathNum + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    //生成：所有像素的主光线进入0号队列
+    kernels->generate->use();
+    uniforms.frame.set(frame);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(barrier);
+
+    //每次反弹后存活的路径压缩到另一个队列，线程数由GPU上的队列长度间接决定
+    for (int depth = 0; depth < maxDepth; depth++) {
+        int queue = depth % 2;
+        GLintptr dispatch = (GLintptr)(queue * 4 * sizeof(GLuint));
+        kernels->extend->use();
+        uniforms.extendQueue.set(queue);
+        glDispatchComputeIndirect(dispatch);
+        glMemoryBarrier(barrier);
+        kernels->shade->use();
+        uniforms.shadeQueue.set(queue);
+        glDispatchComputeIndirect(dispatch);
+        glMemoryBarrier(barrier);
+        kernels->prepare->use();
+        uniforms.prepareQueue.set(queue);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(barrier);
+    }
+
+    //累积：之后的累积与显示读取写入的纹理
+    kernels->accumulate->use();
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
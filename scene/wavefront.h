@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <GL/glew.h>
+
+#include "shader/shader.h"
+#include "scenebuffer.h"
+
+//波前追踪缓冲的首个绑定点，紧接场景描述的五段数组
+#define WAVEFRONT_BINDING (SCENE_BINDING + 5)
+#define GROUP_SIZE 64 //计算着色器的工作组大小，与wavefront.comp一致
+
+/*****************************************************
+ * 波前追踪的缓冲：与wavefront.comp中的结构体按std430布局一一对应，只用于计算缓冲大小
+ *****************************************************/
+
+struct PathData {
+    Vector3f startPoint;
+    GLfloat coneWidth;
+    Vector3f direction;
+    GLfloat coneSpread;
+    GLuint seed, pseed;
+    GLint gray, depth;
+    Vector4f throughput[3]; //mat3的列步长为16字节
+    Vector3f radiance;
+    GLfloat pad;
+};
+
+struct HitData {
+    GLfloat distance, pad[3];
+    Vector4f hitPoint, normal, viewDir; //vec3的对齐为16字节
+    MaterialData material;
+};
+
+struct QueueHeader {
+    GLuint dispatch[2][4]; //两个队列的间接启动参数
+    GLuint count[2];
+};
+
+static_assert(sizeof(PathData) == 112, "PathData must match std430 layout");
+static_assert(sizeof(HitData) == 112, "HitData must match std430 layout");
+static_assert(sizeof(QueueHeader) == 40, "QueueHeader must match std430 layout");
+
+//波前路径追踪：每个样本依次执行生成、求交、着色与累积等计算着色器，
+//每次反弹后只为存活的路径启动线程，避免片元着色器中提前结束的路径占用线程
+class Wavefront {
+private:
+    //各阶段的计算着色器，由同一源码注入不同的KERNEL_*宏编译
+    struct Kernels {
+        Shader *generate, *extend, *shade, *prepare, *accumulate;
+    };
+
+    int pathNum;
+    std::string source;
+    //以场景签名为键缓存的特化变体
+    std::unordered_map<std::string, Kernels> variants;
+    Kernels *kernels{};
+
+    //路径状态、交点与路径队列
+    GLuint buffers[3]{};
+
+    //各阶段中随样本或反弹变化的uniform变量
+    struct {
+        Uniform<GLint> frame, extendQueue, shadeQueue, prepareQueue;
+    } uniforms;
+
+    //对当前变体的每个阶段调用f
+    template <typename F>
+    void forEach(const Kernels &k, F &&f) {
+        f(k.generate);
+        f(k.extend);
+        f(k.shade);
+        f(k.prepare);
+        f(k.accumulate);
+    }
+
+public:
+    Wavefront(int width, int height);
+    Wavefront(const Wavefront &) = delete;
+    ~Wavefront();
+
+    //切换到defines对应的变体，首次使用时开始异步编译
+    void select(const std::string &defines);
+    //当前变体的所有阶段是否已可使用
+    bool ready();
+    bool isLinked();
+    //对当前变体的每个阶段调用f，用于设置与片元着色器相同的常量
+    template <typename F>
+    void forEachKernel(F &&f) {
+        forEach(*kernels, f);
+    }
+    //解析各阶段的uniform句柄，ready()后调用
+    void resolve();
+
+    //追踪第frame个样本，最多反弹maxDepth次，并加到累积纹理texture（RGBA32F）上
+    void trace(GLuint texture, int frame, int maxDepth);
+};
@@ -0,0 +1,723 @@
+//光线追踪的公共部分：场景描述、随机数、采样与求交，由tracer.frag与wavefront.comp包含
+//包含前须已声明#version
+
+#define PI 3.1415926
+#define INF 114514.0
+#define ERR 0.0001
+#define CONE_DIFFUSE_SPREAD 0.1 //漫反射后光线锥扩散角的增量
+#define CONE_ROUGH_SPREAD 0.5   //镜面反射与折射后扩散角的增量与模糊度之比
+
+//屏幕参数
+uniform int width;
+uniform int height;
+
+//帧数：已累积的样本数，也是本次绘制中首个样本的序号
+uniform int frame;
+uniform int maxFrame;
+
+//视点
+uniform vec3 eyePos;
+
+//最大反弹次数：运行时设置，不限制上限
+uniform int maxDepth;
+//反弹次数达到后开始以俄罗斯轮盘结束路径
+uniform int rouletteDepth;
+
+//所有模型共用的纹理数组
+uniform sampler2DArray textures;
+
+//表面材质：参考material.h
+struct Material {
+    vec3 color;
+    float specularRate;
+    float specularTint;
+    float specularRoughness;
+    float refractRate;
+    float refractTint;
+    float refractIndex;
+    float refractRoughness;
+    bool lighting;
+};
+
+//`BVH`树节点
+struct BVHNode {
+    vec3 AA;
+    vec3 BB;
+    int l;
+    int r;
+    int n;
+    int index;
+};
+
+/*****************************************************
+ * 模型定义：以std430布局存放在着色器存储缓冲中，参考scenebuffer.h
+ *****************************************************/
+
+//四边形
+struct Quad {
+    vec3 samples[4];
+    vec3 normal;
+};
+
+//四边形模型
+struct QuadModel {
+    Quad quad;
+    int material;       //材质表中的下标
+    bool useTexture;
+    int layer;          //纹理数组中的层号
+    vec4 uvTransform;   //纹理坐标变换：xy为缩放，zw为偏移
+};
+
+//球体
+struct Sphere {
+    vec3 center;
+    float radius;
+};
+
+//球体模型
+struct SphereModel {
+    Sphere sph;
+    int material;       //材质表中的下标
+    bool useTexture;
+    int layer;          //纹理数组中的层号
+    vec4 uvTransform;   //纹理坐标变换：xy为缩放，zw为偏移
+};
+
+//圆柱体
+struct Cylinder {
+    vec3 center;
+    float radius;
+    float height;
+};
+
+//圆柱体模型
+struct CylinderModel {
+    Cylinder cyl;
+    int material;       //材质表中的下标
+    bool useTexture;
+    int layer;          //纹理数组中的层号
+    vec4 uvTransform;   //纹理坐标变换：xy为缩放，zw为偏移
+};
+
+//自定义模型：所有模型的面片与`BVH`树合并存放，各模型记录自己的起始下标
+struct CustomizedModel {
+    vec3 center;
+    float height;
+    int material;       //材质表中的下标
+    bool useTexture;
+    int layer;          //纹理数组中的层号
+    int nodeOffset;     //BVH树根结点在结点数组中的下标
+    int patchOffset;    //首个面片在面片数组中的下标
+    vec4 uvTransform;   //纹理坐标变换：xy为缩放，zw为偏移
+};
+
+/*****************************************************/
+
+//光线
+struct Ray {
+    vec3 startPoint;
+    vec3 direction;
+};
+
+//击中信息
+struct HitInfo {
+    float distance;         // 与交点的距离
+    vec3 hitPoint;          // 光线命中点
+    vec3 normal;            // 命中点法线
+    vec3 viewDir;           // 击中该点的光线的方向
+    Material material;      // 命中点的表面材质
+};
+
+//光线锥：当前光线起点处的宽度与扩散角，用于选择纹理的mipmap层级
+float coneWidth = 0.0;
+float coneSpread = 0.0;
+
+//模型信息：模型数量只受缓冲大小限制
+//场景特化的变体由Scene注入SPECIALIZED及下列宏，模型数量成为常量，循环可展开，未用到的分支可消除
+#ifdef SPECIALIZED
+const int quadNum = QUAD_NUM;
+const int sphereNum = SPHERE_NUM;
+const int cylinderNum = CYLINDER_NUM;
+const int customizedNum = CUSTOMIZED_NUM;
+#else
+uniform int quadNum;
+uniform int sphereNum;
+uniform int cylinderNum;
+uniform int customizedNum;
+#define USE_TEXTURE true       //场景中有模型使用纹理
+#define USE_REFRACT true       //场景中有透明材质
+#define ACCUMULATE_BLEND false //累积方式：加法混合，或读取之前的结果后写入另一个缓冲
+#endif
+
+layout (std430, binding = 0) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+layout (std430, binding = 1) readonly buffer QuadBuffer {
+    QuadModel quads[];
+};
+layout (std430, binding = 2) readonly buffer SphereBuffer {
+    SphereModel spheres[];
+};
+layout (std430, binding = 3) readonly buffer CylinderBuffer {
+    CylinderModel cylinders[];
+};
+layout (std430, binding = 4) readonly buffer CustomizedBuffer {
+    CustomizedModel customized[];
+};
+
+//所有自定义模型合并后的面片（每个面片为四个顶点与法矢量）与`BVH`树结点（每个结点为四个三维向量）
+uniform samplerBuffer patchTex;
+uniform samplerBuffer bvhTex;
+
+/*****************************************************
+ * 生成随机数：随机种子+哈希
+ *****************************************************/
+
+//随机种子：每个样本开始时设置
+uint seed = 0u;
+
+//哈希函数
+uint hash(inout uint seed) {
+    seed *= 0x27d4eb2du;
+    seed = seed ^ (seed >> 15);
+    return seed;
+}
+
+//随机数
+float rand() {
+    return float(hash(seed)) / 4294967296.0;
+}
+
+/*****************************************************
+ * sobol序列
+ *****************************************************/
+
+uniform uint V[64];
+
+//仅与像素坐标有关的随机种子
+uint pseed = 0u;
+
+//格林码
+int gray = 0;
+
+//设置像素coord处第i个样本的随机种子与格林码
+void beginSample(uvec2 coord, int i) {
+    uint pixel = coord.x * 1973u + coord.y * 9277u;
+    seed = pixel + uint(i * maxFrame) * 26699u;
+    pseed = pixel + 512u * 26699u;
+    gray = i ^ (i >> 1);
+}
+
+//生成`sobol`数
+float sobol(int d, int i) {
+    uint result = 0u;
+    int offset = d * 32;
+    for (int j = 0, k = i; k != 0; k >>= 1, j++) {
+        if ((k & 1) == 1) {
+            result ^= V[j + offset];
+        }
+    }
+    return float(result) / 4294967296.0;
+}
+
+float CranleyPattersonRotation(float p) {
+    float u = float(hash(pseed)) / 4294967296.0;
+    p += u;
+    if(p > 1.0) p -= 1.0;
+    if(p < 0.0) p += 1.0;
+    return p;
+}
+
+/*****************************************************
+ * 生成随机向量
+ *****************************************************/
+
+//将向量v投影到N的法向半球
+vec3 toNormalHemisphere(vec3 v, vec3 N) {
+    vec3 helper = vec3(1.0, 0.0, 0.0);
+    if(abs(N.x) >= 1.0 - ERR) helper = vec3(0.0, 0.0, 1.0);
+    vec3 tangent = normalize(cross(N, helper));
+    vec3 bitangent = normalize(cross(N, tangent));
+    return v.x * tangent + v.y * bitangent + v.z * N;
+}
+
+//法向半球随机采样
+vec3 sampleHemisphere(vec3 N) {
+    float r = sqrt(rand());
+    float t = rand() * (2.0 * PI);
+    float x = r * cos(t);
+    float y = r * sin(t);
+    float z = sqrt(1.0 - x * x - y * y);
+    return toNormalHemisphere(vec3(x, y, z), N);
+}
+
+//根据sobol序列的均匀半球采样
+vec3 sampleSobolHemisphere(vec3 N) {
+    float u = CranleyPattersonRotation(sobol(0, gray));
+    float v = CranleyPattersonRotation(sobol(1, gray));
+//    float u = sobol(0, gray);
+//    float v = sobol(1, gray);
+    float r = sqrt(u);
+    float t = v * (2.0 * PI);
+    float x = r * cos(t);
+    float y = r * sin(t);
+    float z = sqrt(1.0 - x * x - y * y);
+    return toNormalHemisphere(vec3(x, y, z), N);
+}
+
+/*****************************************************
+ * 光线追踪
+ *****************************************************/
+
+//点坐标到四边形纹理坐标的映射
+vec2 quadTexCoord(in vec3 samples[4], vec3 P) {
+    vec3 m = samples[2] - samples[0];
+    vec3 n = samples[0] - samples[1];
+    vec3 q = P - samples[1];
+    if (m.x == 0.0 && n.x == 0.0 && q.x == 0) {
+        mat2 mn = mat2(m.yz, n.yz);
+        return inverse(mn) * q.yz;
+    }
+    if (m.y == 0.0 && n.y == 0.0 && q.y == 0.0) {
+        mat2 mn = mat2(m.xz, n.xz);
+        return inverse(mn) * q.xz;
+    }
+    mat2 mn = mat2(m.xy, n.xy);
+    return inverse(mn) * q.xy;
+}
+
+//光线是否击中四边形
+bool hitQuad(Ray r, in Quad quad, inout HitInfo hit) {
+    //求光线与平面交点
+    vec3 n1 = quad.samples[1] - quad.samples[0];
+    vec3 n2 = quad.samples[2] - quad.samples[0];
+    vec3 normal = normalize(cross(n1, n2));
+    float d = -dot(quad.samples[0], normal);
+    float m = dot(r.direction, normal);
+    if (m >= -ERR) return false; //剔除背向面
+    float t = -(d + dot(r.startPoint, normal)) / m;
+    if (t <= ERR) return false; //剔除与自身相交的情况
+    vec3 P = r.startPoint + r.direction * t;
+
+    //根据叉乘与法矢量的方向关系判断是否在四边形内
+    vec3 n3 = P - quad.samples[0];
+    vec3 n4 = P - quad.samples[1];
+    vec3 n5 = P - quad.samples[2];
+    float f1 = dot(cross(n1, n3), normal);
+    float f2 = dot(cross(n3, n2), normal);
+    float f3 = dot(cross(n5, n1), normal);
+    float f4 = dot(cross(n2, n4), normal);
+
+    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {
+        hit.distance = t;
+        hit.hitPoint = P;
+        hit.viewDir = r.direction;
+        hit.normal = normal;
+        return true;
+    }
+
+    return false;
+}
+
+//按光线锥在击中点的覆盖范围选择mipmap层级采样纹理，worldSize为单位纹理坐标对应的世界空间长度
+vec3 sampleTexture(int layer, vec4 uvTransform, vec2 uv, float worldSize, in HitInfo hit) {
+    float footprint = (coneWidth + coneSpread * hit.distance) / max(abs(dot(hit.normal, hit.viewDir)), 0.01);
+    vec2 arraySize = vec2(textureSize(textures, 0).xy);
+    vec2 size = arraySize * uvTransform.xy;
+    float lod = log2(footprint * sqrt(size.x * size.y) / worldSize);
+
+    //纹理只占层的一部分：重复纹理坐标，并在所用层级上离区域边界保留半个纹素，避免采样到区域外
+    int level = clamp(int(ceil(lod)), 0, textureQueryLevels(textures) - 1);
+    vec2 half_texel = 0.5 / vec2(textureSize(textures, level).xy);
+    vec2 st = clamp(fract(uv) * uvTransform.xy, half_texel, uvTransform.xy - half_texel) + uvTransform.zw;
+    return textureLod(textures, vec3(st, layer), lod).xyz;
+}
+
+//光线是否击中四边形模型
+bool hitQuadModel(Ray r, int i, inout HitInfo hit) {
+    bool ret = hitQuad(r, quads[i].quad, hit);
+    if (ret) {
+        hit.material = materials[quads[i].material];
+        //纹理映射
+        if (USE_TEXTURE && quads[i].useTexture) {
+            vec2 tex = quadTexCoord(quads[i].quad.samples, hit.hitPoint);
+            float size = sqrt(length(quads[i].quad.samples[2] - quads[i].quad.samples[0]) *
+                              length(quads[i].quad.samples[0] - quads[i].quad.samples[1]));
+            vec3 color = sampleTexture(quads[i].layer, quads[i].uvTransform, tex, size, hit);
+            hit.material.color = color;
+        }
+    }
+    return ret;
+}
+
+//光线是否击中球体
+bool hitSphere(Ray r, in Sphere sphere, inout HitInfo hit) {
+    //计算光线与球心距离
+    float t = dot(sphere.center - r.startPoint, r.direction);
+    vec3 T = r.startPoint + r.direction * t;
+    vec3 CP = T - sphere.center;
+    float l_CP = length(CP);
+
+    //距离大于半径则不相交
+    if (l_CP > sphere.radius) return false;
+
+    //计算交点
+    float delta = sqrt(sphere.radius * sphere.radius - l_CP * l_CP);
+    float t1 = t - delta;
+    float t2 = t + delta;
+
+    //判断是哪个交点，并剔除与自身相交的情况
+    if (t1 > ERR) t = t1;
+    else if (t2 > ERR) t = t2;
+    else return false;
+
+    //存在遮挡
+    if (t >= hit.distance - ERR) return false;
+
+    hit.distance = t;
+    hit.hitPoint = r.startPoint + r.direction * t;
+    hit.normal = normalize(hit.hitPoint - sphere.center);
+    hit.viewDir = r.direction;
+    return true;
+}
+
+//法矢量到球面纹理坐标的映射
+vec2 sphereTexCoord(vec3 N) {
+    float ang_x = atan(N.z, N.x);
+    float ang_y = asin(N.y);
+    vec2 uv = vec2(ang_x, ang_y);
+    uv.x = 1.0 - ang_x / (2.0 * PI);
+    uv.y = 0.5 + ang_y / PI;
+    return uv;
+}
+
+//光线是否击中球体模型
+bool hitSphereModel(Ray r, int i, inout HitInfo hit) {
+    bool ret = hitSphere(r, spheres[i].sph, hit);
+    if (ret) {
+        hit.material = materials[spheres[i].material];
+        //纹理映射
+        if (USE_TEXTURE && spheres[i].useTexture) {
+            vec2 texc = sphereTexCoord(hit.normal);
+            //经度方向跨越周长，纬度方向跨越半周长
+            float size = sqrt(2.0) * PI * spheres[i].sph.radius;
+            vec3 color = sampleTexture(spheres[i].layer, spheres[i].uvTransform, texc, size, hit);
+            hit.material.color = color;
+        }
+        //折射率：射出时需要取倒数
+        float ref_ang = hit.material.refractIndex;
+        if (ref_ang != 0 && dot(hit.normal, r.direction) > 0) {
+            hit.material.refractIndex = 1.0 / ref_ang;
+            hit.normal = -hit.normal;
+        }
+    }
+    return ret;
+}
+
+//光线是否击中圆柱体
+bool hitCylinder(Ray r, in Cylinder cyl, inout HitInfo hit) {
+    //计算光线到中轴的最短距离
+    vec2 SF = cyl.center.xz - r.startPoint.xz;
+    vec2 d_ST = r.direction.xz;
+    float l_FT = abs(SF.y * d_ST.x - SF.x * d_ST.y) / length(d_ST);
+
+    //距离大于半径则不与无限长圆柱面相交
+    if (l_FT > cyl.radius) return false;
+
+    //计算与无限长圆柱面的交点
+    float l_SF = length(SF);
+    float t = sqrt(l_SF * l_SF - l_FT * l_FT) / length(d_ST);
+    float right = cyl.radius * cyl.radius - l_FT * l_FT;
+    float left = 1.0 - r.direction.y * r.direction.y;
+    float delta = sqrt(right / left);
+    float t1 = t - delta;
+    float t2 = t + delta;
+    vec3 M = r.startPoint + r.direction * t1;
+    vec3 N = r.startPoint + r.direction * t2;
+
+    //交点方向相反
+    if (t2 <= ERR) return false;
+
+    //击中点在M
+    if (M.y >= cyl.center.y && M.y <= cyl.center.y + cyl.height) {
+        if (t1 <= ERR) return false; //与自身相交
+        if (t1 >= hit.distance - ERR) return false; //存在遮挡
+        vec2 nor = normalize(M.xz - cyl.center.xz);
+        hit.distance = t1;
+        hit.hitPoint = M;
+        hit.normal = vec3(nor.x, 0.0, nor.y);
+        hit.viewDir = r.direction;
+        return true;
+    }
+
+    //击中点在下底面
+    if (M.y < cyl.center.y && N.y >= cyl.center.y) {
+        float m = (cyl.center.y - r.startPoint.y) / r.direction.y;
+        if (m >= hit.distance - ERR) return false; //存在遮挡
+        hit.distance = m;
+        hit.hitPoint = r.startPoint + r.direction * m;
+        hit.normal = vec3(0.0, -1.0, 0.0);
+        hit.viewDir = r.direction;
+        return true;
+    }
+
+    //击中点在上底面
+    if (M.y > cyl.center.y + cyl.height && N.y <= cyl.center.y + cyl.height) {
+        float m = (cyl.center.y + cyl.height - r.startPoint.y) / r.direction.y;
+        if (m >= hit.distance - ERR) return false; //存在遮挡
+        hit.distance = m;
+        hit.hitPoint = r.startPoint + r.direction * m;
+        hit.normal = vec3(0.0, 1.0, 0.0);
+        hit.viewDir = r.direction;
+        return true;
+    }
+
+    return false;
+}
+
+//点坐标到圆柱体侧面的纹理映射
+vec2 cylinderTexCoord(vec3 P, vec3 center, float height) {
+    float ang_x = atan(P.z - center.z, P.x - center.x);
+    vec2 uv;
+    uv.x = 1.0 - ang_x / (2.0 * PI);
+    uv.y = (P.y - center.y) / height;
+    return uv;
+}
+
+//光线是否击中圆柱体模型
+bool hitCylinderModel(Ray r, int i, inout HitInfo hit) {
+    bool ret = hitCylinder(r, cylinders[i].cyl, hit);
+    if (ret) {
+        hit.material = materials[cylinders[i].material];
+        hit.material.refractRate = 0.0; //圆柱体不支持透明材质
+        float y = hit.hitPoint.y;
+        float y_l = cylinders[i].cyl.center.y;
+        float y_h = y_l + cylinders[i].cyl.height;
+        //只有侧面有纹理映射
+        if (USE_TEXTURE && cylinders[i].useTexture && y > y_l && y < y_h) {
+            vec2 tex = cylinderTexCoord(hit.hitPoint, cylinders[i].cyl.center, cylinders[i].cyl.height);
+            float size = sqrt(2.0 * PI * cylinders[i].cyl.radius * cylinders[i].cyl.height);
+            vec3 color = sampleTexture(cylinders[i].layer, cylinders[i].uvTransform, tex, size, hit);
+            hit.material.color = color;
+        }
+    }
+    return ret;
+}
+
+//获取自定义模型面片数据，i为模型内的面片编号
+Quad getPatch(in CustomizedModel model, int i) {
+    int offset = (model.patchOffset + i) * 5;
+    Quad q;
+
+    q.samples[0] = texelFetch(patchTex, offset).xyz;
+    q.samples[1] = texelFetch(patchTex, offset + 1).xyz;
+    q.samples[2] = texelFetch(patchTex, offset + 2).xyz;
+    q.samples[3] = texelFetch(patchTex, offset + 3).xyz;
+    q.normal = texelFetch(patchTex, offset + 4).xyz;
+
+    return q;
+}
+
+//获取自定义模型`BVH`树节点数据，i为模型内的结点编号
+BVHNode getBVH(in CustomizedModel model, int i) {
+    int offset = (model.nodeOffset + i) * 4;
+    BVHNode n;
+
+    n.AA = texelFetch(bvhTex, offset).xyz;
+    n.BB = texelFetch(bvhTex, offset + 1).xyz;
+    ivec3 tmp = ivec3(texelFetch(bvhTex, offset + 2).xyz);
+    n.l = tmp.x;
+    n.r = tmp.y;
+    tmp = ivec3(texelFetch(bvhTex, offset + 3).xyz);
+    n.n = tmp.x;
+    n.index = tmp.y;
+
+    return n;
+}
+
+//光线是否击中`AABB`包围盒
+float hitAABB(Ray r, vec3 AA, vec3 BB) {
+    vec3 M = (BB - r.startPoint) / r.direction;
+    vec3 N = (AA - r.startPoint) / r.direction;
+
+    vec3 tmax = max(M, N);
+    vec3 tmin = min(M, N);
+
+    float t1 = min(tmax.x, min(tmax.y, tmax.z));
+    float t2 = max(tmin.x, max(tmin.y, tmin.z));
+
+    return t1 >= t2 && t2 > ERR ? t2 : -1.0;
+}
+
+//光线是否击中自定义模型
+bool hitCustomizedModel(Ray r, in CustomizedModel model, inout HitInfo hit) {
+    int stack[8];
+    int p = 0;
+
+    stack[p++] = 0;
+    while (p > 0) {
+        int top = stack[--p];
+        BVHNode node = getBVH(model, top);
+
+        //叶子结点
+        if (node.n > 0) {
+            int m = node.index;
+            int n = m + node.n;
+            for (int i = m; i < n; i++) {
+                Quad q = getPatch(model, i);
+                if (hitQuad(r, q, hit)) {
+                    hit.material = materials[model.material];
+                    hit.material.refractRate = 0.0; //自定义模型不支持透明材质
+                    //纹理映射
+                    if (USE_TEXTURE && model.useTexture) {
+                        vec2 tex = cylinderTexCoord(hit.hitPoint, model.center, model.height);
+                        //按击中点到中轴的距离计算周长
+                        float radius = max(length(hit.hitPoint.xz - model.center.xz), ERR);
+                        float size = sqrt(2.0 * PI * radius * model.height);
+                        vec3 color = sampleTexture(model.layer, model.uvTransform, tex, size, hit);
+                        hit.material.color = color;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        //与左右盒子求交
+        float t1 = -1.0, t2 = -1.0;
+        if (node.l >= 0) {
+            BVHNode l_node = getBVH(model, node.l);
+            t1 = hitAABB(r, l_node.AA, l_node.BB);
+        }
+        if (node.r >= 0) {
+            BVHNode r_node = getBVH(model, node.r);
+            t2 = hitAABB(r, r_node.AA, r_node.BB);
+        }
+
+        //在最近的盒子中搜索
+        if (t1 > 0 && t2 > 0) {
+            if (t1 < t2) {
+                stack[p++] = node.r;
+                stack[p++] = node.l;
+            } else {
+                stack[p++] = node.l;
+                stack[p++] = node.r;
+            }
+        } else if (t1 > 0) {
+            stack[p++] = node.l;
+        } else if (t2 > 0) {
+            stack[p++] = node.r;
+        }
+    }
+
+    return false;
+}
+
+//击中判断
+bool hitModel(Ray r, out HitInfo hit) {
+    hit.distance = INF;
+    bool ret = false;
+
+    for (int i = 0; i < cylinderNum; i++) {
+        ret = hitCylinderModel(r, i, hit) || ret;
+    }
+    for (int i = 0; i < quadNum; i++) {
+        ret = hitQuadModel(r, i, hit) || ret;
+    }
+    for (int i = 0; i < sphereNum; i++) {
+        ret = hitSphereModel(r, i, hit) || ret;
+    }
+    for (int i = 0; i < customizedNum; i++) {
+        ret = hitCustomizedModel(r, customized[i], hit) || ret;
+    }
+
+    return ret;
+}
+
+/*****************************************************
+ * 路径追踪的单步操作：片元着色器与波前计算着色器共用
+ *****************************************************/
+
+//像素中心位于position的初始光线：视点指向像素点，加入随机偏移量以抗锯齿，并初始化光线锥
+Ray cameraRay(vec3 position) {
+    Ray r;
+    r.startPoint = eyePos;
+    vec3 screen = position;
+    float d = rand(), th = rand() * (2.0 * PI);
+    screen.x += (d * sin(th) - 0.5) * (2.0 / width);
+    screen.y += (d * cos(th) - 0.5) * (2.0 / height);
+    r.direction = normalize(screen - eyePos);
+
+    //初始光线锥：在屏幕处的宽度为一个像素
+    coneWidth = 0.0;
+    coneSpread = 2.0 / (height * length(screen - eyePos));
+    return r;
+}
+
+//根据击中点的材质生成第depth层的下一条光线，返回光线类型（0为漫反射，1为镜面反射，2为折射）与混合指数
+int scatter(inout Ray r, in HitInfo hit, int depth, out float tint) {
+    //随机生成下一条光线
+    vec3 oldRay = r.direction;
+    r.direction = depth == 0 ? sampleSobolHemisphere(hit.normal) : sampleHemisphere(hit.normal);
+//    r.direction = sampleHemisphere(hit.normal);
+    r.startPoint = hit.hitPoint;
+
+    //根据物体材质决定下一条光线的方向
+    float p = rand();
+    tint = 0.0;
+    if (p < hit.material.specularRate) {
+        //镜面反射
+        vec3 ref = reflect(oldRay, hit.normal);
+        r.direction = normalize(mix(ref, r.direction, hit.material.specularRoughness));
+        tint = hit.material.specularTint;
+        coneSpread += hit.material.specularRoughness * CONE_ROUGH_SPREAD;
+        return 1;
+    } else if (USE_REFRACT && hit.material.specularRate <= p && p <= hit.material.specularRate + hit.material.refractRate) {
+        //折射
+        vec3 ref = refract(oldRay, hit.normal, 1.0 / hit.material.refractIndex);
+        r.direction = normalize(mix(ref, -r.direction, hit.material.refractRoughness));
+        tint = hit.material.refractTint;
+        coneSpread += hit.material.refractRoughness * CONE_ROUGH_SPREAD;
+        return 2;
+    }
+    //漫反射
+    coneSpread += CONE_DIFFUSE_SPREAD;
+    return 0;
+}
+
+//本层对下一层颜色的线性变换：漫反射逐通道乘以颜色；镜面反射与折射在颜色乘以入射光强与入射光之间按tint插值，
+//入射光强取各通道之和除以sqrt(3)，对白光与向量长度相同，使变换保持线性，吞吐量可沿路径向前累乘
+mat3 transfer(vec3 color, float cosine, int type, float tint) {
+    float s = sqrt(cosine);
+    if (type == 0) return mat3(color.r * s, 0.0, 0.0, 0.0, color.g * s, 0.0, 0.0, 0.0, color.b * s);
+    return s * (outerProduct(color, vec3((1.0 - tint) / sqrt(3.0))) + mat3(tint));
+}
+
+//路径的一次反弹：击中光源时将其辐射亮度经吞吐量累加到radiance并返回false，否则生成下一条光线并更新吞吐量，
+//被俄罗斯轮盘结束时返回false
+bool bounce(inout Ray r, in HitInfo hit, int depth, inout mat3 throughput, inout vec3 radiance) {
+    //反伽马校正
+    vec3 color = pow(hit.material.color, vec3(2.2));
+
+    //光线锥传播到击中点
+    coneWidth += coneSpread * hit.distance;
+
+    if (hit.material.lighting) {
+        radiance += throughput * (color * 2.0);
+        return false;
+    }
+
+    //光线与击中点法矢量的夹角余弦，在生成下一条光线前计算
+    float cosine = abs(dot(hit.normal, r.direction));
+    float tint;
+    int type = scatter(r, hit, depth, tint);
+    throughput *= transfer(color, cosine, type, tint);
+
+    //俄罗斯轮盘：按吞吐量决定路径是否继续，吞吐量越小越可能结束；存活的路径除以存活概率，期望不变
+    if (depth + 1 >= rouletteDepth) {
+        vec3 response = throughput * vec3(1.0);
+        float survive = min(max(response.r, max(response.g, response.b)), 1.0);
+        if (rand() >= survive) return false;
+        throughput /= survive;
+    }
+    return true;
+}
@@ -1,19 +1,46 @@
+import os
+import re
+
+
 def loadFile(file: str):
     with open(file, 'rb') as f:
         return f.read()
 
 
+def expand(file: str):
+    # 展开#include "..."，与Shader::loadSource的处理一致
+    lines = []
+    for line in loadFile(file).split(b'\n'):
+        match = re.match(rb'\s*#include\s+"(.+)"', line)
+        if match:
+            lines.append(expand(os.path.join(os.path.dirname(file), match.group(1).decode())).rstrip(b'\n'))
+        else:
+            lines.append(line)
+    return b'\n'.join(lines)
+
+
+def literal(source: bytes):
+    # 十六进制转义后紧跟十六进制字符时会被当作同一个转义，用""断开
+    return re.sub(r'(\\x[0-9a-f]{2})(?=[0-9a-fA-F])', r'\1""', f'{source}'[2:-1])
+
+
 if __name__ == '__main__':
-    vert = f'{loadFile("./tracer.vert")}'
-    frag = f'{loadFile("./tracer.frag")}'
-    render = f'{loadFile("./render.frag")}'
+    vert = literal(expand("./tracer.vert"))
+    frag = literal(expand("./tracer.frag"))
+    preview = literal(expand("./preview.frag"))
+    render = literal(expand("./render.frag"))
+    wavefront = literal(expand("./wavefront.comp"))
 
     with open('./shaderBuf.h', 'w') as f:
         f.write(f'#pragma once\n'
                 f'\n'
-                f'#define tracer_vert "{vert[2:-1]}"\n'
+                f'#define tracer_vert "{vert}"\n'
+                f'\n'
+                f'#define tracer_frag "{frag}"\n'
+                f'\n'
+                f'#define preview_frag "{preview}"\n'
                 f'\n'
-                f'#define tracer_frag "{frag[2:-1]}"\n'
+                f'#define render_frag "{render}"\n'
                 f'\n'
-                f'#define render_frag "{render[2:-1]}"\n'
+                f'#define wavefront_comp "{wavefront}"\n'
                 f'')
@@ -0,0 +1,18 @@
+#version 450 core
+
+#include "common.glsl"
+
+//预览：路径追踪的变体编译完成前使用，只投射经过像素中心的主光线，输出击中点的反照率
+//不注入场景特化的宏，模型数量由uniform给出，编译一次后在变体切换间复用
+
+in vec3 position;
+layout (location = 0) out vec3 FragData;
+
+void main() {
+    Ray r;
+    r.startPoint = eyePos;
+    r.direction = normalize(position - eyePos);
+    coneSpread = 2.0 / (height * length(position - eyePos));
+    HitInfo hit;
+    FragData = hitModel(r, hit) ? hit.material.color : vec3(0.0);
+}
@@ -1,51 +1,105 @@
 #include "shader.h"
 
-Shader::Shader(const char *vertPath, const char *fragPath, const char *tcsPath, const char *tesPath, const char *gsPath) {
-    program_id = glCreateProgram();
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
-    int vertID = createShader(vertPath, GL_VERTEX_SHADER);
-    glAttachShader(program_id, vertID);
-    glDeleteShader(vertID);
+Shader::Shader(const char *vertPath, const char *fragPath, const char *tcsPath, const char *tesPath, const char *gsPath)
+    : Shader(vertPath, fragPath, std::string(), tcsPath, tesPath, gsPath) {}
+
+Shader::Shader(const char *vertPath, const char *fragPath, const std::string &defines,
+               const char *tcsPath, const char *tesPath, const char *gsPath)
+    : Shader(std::array<const char *, STAGE_NUM>{{vertPath, fragPath, tcsPath, tesPath, gsPath, nullptr}}.data(), defines) {
+    finish();
+}
 
-    int fragID = createShader(fragPath, GL_FRAGMENT_SHADER);
-    glAttachShader(program_id, fragID);
-    glDeleteShader(fragID);
+Shader::Shader(const char *const *sources, const std::string &defines) {
+    program_id = glCreateProgram();
 
-    if (tcsPath != nullptr) {
-        int tcsID = createShader(tcsPath, GL_TESS_CONTROL_SHADER);
-        glAttachShader(program_id, tcsID);
-        glDeleteShader(tcsID);
+    //驱动与源码均未变化时直接载入上次链接的程序
+    key = cacheKey(sources, STAGE_NUM, defines);
+    if (key != 0 && loadBinary(key)) {
+        reflect();
+        linked = true;
+        return;
     }
 
-    if (tesPath != nullptr) {
-        int tesID = createShader(tesPath, GL_TESS_EVALUATION_SHADER);
-        glAttachShader(program_id, tesID);
-        glDeleteShader(tesID);
+    const GLenum types[STAGE_NUM] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_TESS_CONTROL_SHADER,
+                                     GL_TESS_EVALUATION_SHADER, GL_GEOMETRY_SHADER, GL_COMPUTE_SHADER};
+    for (int i = 0; i < STAGE_NUM; i++) {
+        if (sources[i] == nullptr) continue;
+        int shader = createShader(sources[i], (int)types[i], defines);
+        glAttachShader(program_id, shader);
+        stages.push_back(shader);
     }
 
-    if (gsPath != nullptr) {
-        int gsID = createShader(gsPath, GL_GEOMETRY_SHADER);
-        glAttachShader(program_id, gsID);
-        glDeleteShader(gsID);
+    if (key != 0) glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program_id);
+}
+
+Shader *Shader::compileAsync(const char *vertPath, const char *fragPath, const std::string &defines) {
+    const char *sources[STAGE_NUM] = {vertPath, fragPath, nullptr, nullptr, nullptr, nullptr};
+    return new Shader(sources, defines);
+}
+
+Shader *Shader::computeAsync(const char *compPath, const std::string &defines) {
+    const char *sources[STAGE_NUM] = {nullptr, nullptr, nullptr, nullptr, nullptr, compPath};
+    return new Shader(sources, defines);
+}
+
+bool Shader::ready() {
+    if (linked) return true;
+    if (GLEW_KHR_parallel_shader_compile) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(program_id, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
     }
+    finish();
+    return true;
+}
 
-    linkProgramAndCheck(program_id);
+void Shader::finish() {
+    if (linked) return;
+    //编译错误比链接错误更能说明问题，先检查各阶段
+    for (int shader : stages) {
+        checkShader(shader);
+        glDeleteShader(shader);
+    }
+    stages.clear();
+    checkProgram(program_id);
+    if (key != 0) saveBinary(key);
+    reflect();
+    linked = true;
 }
 
 Shader::~Shader() {
     glDeleteProgram(program_id);
 }
 
-int Shader::createShader(const char *buf, int type) {
+int Shader::createShader(const char *buf, int type, const std::string &defines) {
     int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &buf, nullptr);
-    compileShaderAndCheck(shader);
+    //#version必须位于首行，宏定义接在其后
+    const char *body = strchr(buf, '\n');
+    body = body == nullptr ? buf + strlen(buf) : body + 1;
+    //恢复原有行号，使编译错误指向源码中的位置
+    std::string header = defines.empty() ? defines : defines + "#line 2\n";
+    const char *sources[3] = {buf, header.c_str(), body};
+    GLint lengths[3] = {(GLint)(body - buf), (GLint)header.size(), -1};
+    glShaderSource(shader, 3, sources, lengths);
+    glCompileShader(shader);
     return shader;
 }
 
-void Shader::compileShaderAndCheck(int shader) {
+void Shader::checkShader(int shader) {
     int success;
-    glCompileShader(shader);
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
         char infoLog[1024];
@@ -55,9 +109,8 @@ void Shader::compileShaderAndCheck(int shader) {
     }
 }
 
-void Shader::linkProgramAndCheck(int program) {
+void Shader::checkProgram(int program) {
     int success;
-    glLinkProgram(program);
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char infoLog[2048];
@@ -71,50 +124,259 @@ void Shader::use() const {
     glUseProgram(program_id);
 }
 
-void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(program_id, name.data()), (int)value);
+//读取源码并展开#include "..."（相对于当前文件所在的目录），与loader.py的处理一致
+static bool readSource(const std::string &path, std::string &source) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::string dir = path.substr(0, path.find_last_of('/') + 1);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin != std::string::npos && line.compare(begin, 8, "#include") == 0) {
+            size_t l = line.find('"', begin), r = line.rfind('"');
+            if (l != std::string::npos && r > l) {
+                if (!readSource(dir + line.substr(l + 1, r - l - 1), source)) return false;
+                continue;
+            }
+        }
+        source += line;
+        source += '\n';
+    }
+    return true;
+}
+
+std::string Shader::loadSource(const char *path, const char *fallback) {
+    std::string source;
+    return readSource(path, source) ? source : fallback;
+}
+
+/*****************************************************
+ * 程序二进制缓存
+ *****************************************************/
+
+#define BINARY_MAGIC 0x42475250u //"PRGB"
+
+struct BinaryHeader {
+    uint32_t magic;
+    GLenum format;
+    uint64_t key; //与文件名相同的键，防止改名后误用
+    uint64_t size;
+};
+
+//FNV-1a哈希，末尾混入一个分隔字节，使相邻字符串的拼接不会产生相同结果
+static void hashString(uint64_t &h, const char *str) {
+    for (; str != nullptr && *str; str++) {
+        h ^= (unsigned char)*str;
+        h *= 1099511628211ull;
+    }
+    h ^= 0xffu;
+    h *= 1099511628211ull;
+}
+
+static std::string cachePath(uint64_t key) {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return std::string(SHADER_CACHE_DIR) + name + ".bin";
+}
+
+uint64_t Shader::cacheKey(const char *const *sources, int n, const std::string &defines) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return 0;
+
+    //驱动升级后二进制格式可能变化，驱动信息一并计入哈希
+    uint64_t h = 14695981039346656037ull;
+    hashString(h, (const char *)glGetString(GL_VENDOR));
+    hashString(h, (const char *)glGetString(GL_RENDERER));
+    hashString(h, (const char *)glGetString(GL_VERSION));
+    hashString(h, defines.c_str());
+    for (int i = 0; i < n; i++) hashString(h, sources[i]);
+    return h != 0 ? h : 1;
+}
+
+bool Shader::loadBinary(uint64_t key) {
+    std::ifstream in(cachePath(key), std::ios::binary);
+    if (!in) return false;
+    BinaryHeader header{};
+    if (!in.read((char *)&header, sizeof(header))) return false;
+    if (header.magic != BINARY_MAGIC || header.key != key) return false;
+    std::vector<char> binary(header.size);
+    if (!in.read(binary.data(), (std::streamsize)binary.size())) return false;
+
+    glProgramBinary(program_id, header.format, binary.data(), (GLsizei)binary.size());
+    GLint success = 0;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+    return success != 0;
+}
+
+//先写临时文件再改名，避免中断时留下不完整的缓存
+void Shader::saveBinary(uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    BinaryHeader header = {BINARY_MAGIC, 0, key, (uint64_t)length};
+    std::vector<char> binary(length);
+    glGetProgramBinary(program_id, length, nullptr, &header.format, binary.data());
+
+#ifdef _WIN32
+    _mkdir(SHADER_CACHE_DIR);
+#else
+    mkdir(SHADER_CACHE_DIR, 0755);
+#endif
+    std::string path = cachePath(key), tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write((const char *)&header, sizeof(header));
+        out.write(binary.data(), (std::streamsize)binary.size());
+        if (!out) return;
+    }
+    std::remove(path.c_str());
+    std::rename(tmp.c_str(), path.c_str());
+}
+
+void Shader::reflect() {
+    GLint count = 0, max_length = 0;
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::vector<char> buf(max_length + 1);
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_id, (GLuint)i, (GLsizei)buf.size(), nullptr, &size, &type, buf.data());
+        std::string name = buf.data();
+        UniformInfo info = {glGetUniformLocation(program_id, name.data()), type};
+        uniforms[name] = info;
+        //数组以首个元素的名称报告，同时登记不带[0]的名称
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            uniforms[name.substr(0, name.size() - 3)] = info;
+    }
+}
+
+template <typename T>
+Uniform<T> Shader::uniform(const std::string &name) const {
+    Uniform<T> ret;
+    auto it = uniforms.find(name);
+    if (it == uniforms.end()) return ret;
+    if (!Uniform<T>::matches(it->second.type)) {
+        std::cout << "Uniform Type Error: " << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    ret.location = it->second.location;
+    return ret;
+}
+
+/*****************************************************
+ * 各类型uniform变量的类型检查与设置，按指针类型重载
+ *****************************************************/
+
+static bool matchType(const bool *, GLenum type) {
+    return type == GL_BOOL;
+}
+
+//整数变量也用于设置采样器绑定的纹理单元
+static bool matchType(const GLint *, GLenum type) {
+    switch (type) {
+        case GL_INT:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool matchType(const GLuint *, GLenum type) {
+    return type == GL_UNSIGNED_INT;
+}
+
+static bool matchType(const GLfloat *, GLenum type) {
+    return type == GL_FLOAT;
+}
+
+static bool matchType(const Vector2f *, GLenum type) {
+    return type == GL_FLOAT_VEC2;
 }
 
-void Shader::setInt(const std::string &name, GLint value) const {
-    glUniform1i(glGetUniformLocation(program_id, name.data()), value);
+static bool matchType(const Vector3f *, GLenum type) {
+    return type == GL_FLOAT_VEC3;
 }
 
-void Shader::setUint(const std::string &name, GLuint value) const {
-    glUniform1ui(glGetUniformLocation(program_id, name.data()), value);
+static bool matchType(const Vector4f *, GLenum type) {
+    return type == GL_FLOAT_VEC4;
 }
 
-void Shader::setUint(const std::string &name, GLuint *value, GLsizei n) const {
-    glUniform1uiv(glGetUniformLocation(program_id, name.data()), n, value);
+static bool matchType(const Matrix4f *, GLenum type) {
+    return type == GL_FLOAT_MAT4;
 }
 
-void Shader::setFloat(const std::string &name, GLfloat value) const {
-    glUniform1f(glGetUniformLocation(program_id, name.data()), value);
+static void setUniform(GLint location, const bool *value, GLsizei n) {
+    std::vector<GLint> buf(value, value + n);
+    glUniform1iv(location, n, buf.data());
 }
 
-void Shader::setVec2(const std::string &name, Vector2f value) const {
-    glUniform2f(glGetUniformLocation(program_id, name.data()), value.x, value.y);
+static void setUniform(GLint location, const GLint *value, GLsizei n) {
+    glUniform1iv(location, n, value);
 }
 
-void Shader::setVec2(const std::string &name, Vector2f *value, GLsizei n) const {
-    glUniform2fv(glGetUniformLocation(program_id, name.data()), n, (GLfloat *)value);
+static void setUniform(GLint location, const GLuint *value, GLsizei n) {
+    glUniform1uiv(location, n, value);
 }
 
-void Shader::setVec3(const std::string &name, Vector3f value) const {
-    glUniform3f(glGetUniformLocation(program_id, name.data()), value.x, value.y, value.z);
+static void setUniform(GLint location, const GLfloat *value, GLsizei n) {
+    glUniform1fv(location, n, value);
 }
 
-void Shader::setVec3(const std::string &name, Vector3f *value, GLsizei n) const {
-    glUniform3fv(glGetUniformLocation(program_id, name.data()), n, (GLfloat *)value);
+static void setUniform(GLint location, const Vector2f *value, GLsizei n) {
+    glUniform2fv(location, n, (const GLfloat *)value);
 }
 
-void Shader::setVec4(const std::string &name, Vector4f value) const {
-    glUniform4f(glGetUniformLocation(program_id, name.data()), value.x, value.y, value.z, value.a);
+static void setUniform(GLint location, const Vector3f *value, GLsizei n) {
+    glUniform3fv(location, n, (const GLfloat *)value);
 }
 
-void Shader::setVec4(const std::string &name, Vector4f *value, GLsizei n) const {
-    glUniform4fv(glGetUniformLocation(program_id, name.data()), n, (GLfloat *)value);
+static void setUniform(GLint location, const Vector4f *value, GLsizei n) {
+    glUniform4fv(location, n, (const GLfloat *)value);
 }
 
-void Shader::setMat4(const std::string &name, Matrix4f value) const {
-    glUniformMatrix4fv(glGetUniformLocation(program_id, name.data()), 1, GL_FALSE, value[0]);
+static void setUniform(GLint location, const Matrix4f *value, GLsizei n) {
+    glUniformMatrix4fv(location, n, GL_FALSE, (const GLfloat *)value);
 }
+
+template <typename T>
+bool Uniform<T>::matches(GLenum type) {
+    return matchType((const T *)nullptr, type);
+}
+
+template <typename T>
+void Uniform<T>::set(const T &value) const {
+    setUniform(location, &value, 1);
+}
+
+template <typename T>
+void Uniform<T>::set(const T *value, GLsizei n) const {
+    setUniform(location, value, n);
+}
+
+//支持的类型在此实例化
+template class Uniform<bool>;
+template class Uniform<GLint>;
+template class Uniform<GLuint>;
+template class Uniform<GLfloat>;
+template class Uniform<Vector2f>;
+template class Uniform<Vector3f>;
+template class Uniform<Vector4f>;
+template class Uniform<Matrix4f>;
+
+template Uniform<bool> Shader::uniform<bool>(const std::string &) const;
+template Uniform<GLint> Shader::uniform<GLint>(const std::string &) const;
+template Uniform<GLuint> Shader::uniform<GLuint>(const std::string &) const;
+template Uniform<GLfloat> Shader::uniform<GLfloat>(const std::string &) const;
+template Uniform<Vector2f> Shader::uniform<Vector2f>(const std::string &) const;
+template Uniform<Vector3f> Shader::uniform<Vector3f>(const std::string &) const;
+template Uniform<Vector4f> Shader::uniform<Vector4f>(const std::string &) const;
+template Uniform<Matrix4f> Shader::uniform<Matrix4f>(const std::string &) const;
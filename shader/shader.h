@@ -1,35 +1,91 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "GL/glew.h"
 
 #include "config/config.h"
 
+#define SHADER_DIR "./shader/"             //运行时读取的着色器源码目录
+#define SHADER_CACHE_DIR "./shader_cache/" //链接后的程序二进制缓存目录
+#define STAGE_NUM 6 //着色器阶段数：顶点、片元、细分控制、细分求值、几何、计算
+
+//着色器中uniform变量的句柄，由Shader::uniform按名称解析一次，T为变量在C++中的类型
+//设置前须启用对应的着色器；变量未被着色器使用时句柄无效，设置不产生效果
+template <typename T>
+class Uniform {
+private:
+    GLint location = -1;
+    friend class Shader;
+
+    //反射得到的GL类型是否与T一致
+    static bool matches(GLenum type);
+
+public:
+    Uniform() = default;
+
+    void set(const T &value) const;
+    void set(const T *value, GLsizei n) const;
+    bool valid() const {return location >= 0;}
+};
+
 class Shader {
 private:
+    //反射得到的uniform变量：位置与GL类型
+    struct UniformInfo {
+        GLint location;
+        GLenum type;
+    };
+
     int program_id;
+    std::unordered_map<std::string, UniformInfo> uniforms;
+    uint64_t key{};           //程序二进制缓存的键
+    std::vector<int> stages;  //等待链接完成的各阶段着色器
+    bool linked = false;      //链接完成且已检查
+
+    //发出编译与链接命令，不等待完成；sources依次为各阶段的源码，不使用的阶段为空
+    Shader(const char *const *sources, const std::string &defines);
+    //等待链接完成，检查错误并反射uniform变量
+    void finish();
 
-    static int createShader(const char *buf, int type);
-    static void compileShaderAndCheck(int shader);
-    static void linkProgramAndCheck(int program);
+    //defines插入到源码的#version行之后
+    static int createShader(const char *buf, int type, const std::string &defines);
+    static void checkShader(int shader);
+    static void checkProgram(int program);
+    //程序二进制缓存的键：各阶段源码、宏定义与驱动信息的哈希；驱动不支持程序二进制时为0
+    static uint64_t cacheKey(const char *const *sources, int n, const std::string &defines);
+    //从缓存恢复程序，缓存缺失或驱动拒绝时返回false
+    bool loadBinary(uint64_t key);
+    void saveBinary(uint64_t key);
+    //链接后查询所有活动的uniform变量
+    void reflect();
 
 public:
     Shader(const char *vertPath, const char *fragPath,
            const char *tcsPath = nullptr, const char *tesPath = nullptr, const char *gsPath = nullptr);
+    //以注入的宏定义编译各阶段，用于生成特化的着色器变体
+    Shader(const char *vertPath, const char *fragPath, const std::string &defines,
+           const char *tcsPath = nullptr, const char *tesPath = nullptr, const char *gsPath = nullptr);
+    Shader(const Shader &) = delete;
     ~Shader();
 
+    //异步编译：驱动支持KHR_parallel_shader_compile时在驱动线程中编译与链接，立即返回
+    static Shader *compileAsync(const char *vertPath, const char *fragPath, const std::string &defines);
+    static Shader *computeAsync(const char *compPath, const std::string &defines);
+    //是否已可使用；驱动不支持并行编译时，首次调用会等待编译完成
+    bool ready();
+    bool isLinked() const {return linked;}
+
+    //使用与解析uniform前须确认ready()
     void use() const;
 
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, GLint value) const;
-    void setUint(const std::string &name, GLuint value) const;
-    void setUint(const std::string &name, GLuint *value, GLsizei n) const;
-    void setFloat(const std::string &name, GLfloat value) const;
-    void setVec2(const std::string &name, Vector2f value) const;
-    void setVec2(const std::string &name, Vector2f *value, GLsizei n) const;
-    void setVec3(const std::string &name, Vector3f value) const;
-    void setVec3(const std::string &name, Vector3f *value, GLsizei n) const;
-    void setVec4(const std::string &name, Vector4f value) const;
-    void setVec4(const std::string &name, Vector4f *value, GLsizei n) const;
-    void setMat4(const std::string &name, Matrix4f value) const;
-};
\ No newline at end of file
+    //读取着色器源码文件并展开其中的#include，文件不存在时使用编译进程序的源码
+    static std::string loadSource(const char *path, const char *fallback);
+
+    //按名称解析uniform句柄，数组可省略末尾的[0]；类型不一致时报错退出
+    template <typename T>
+    Uniform<T> uniform(const std::string &name) const;
+};
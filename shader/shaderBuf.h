@@ -1,7 +1,11 @@
 #pragma once
 
-#define tracer_vert "#version 330\r\n\r\nlayout (location = 1) in vec3 aPosition;\r\n\r\nout vec3 position;\r\n\r\nvoid main() {\r\n    position = aPosition;\r\n    gl_Position = vec4(aPosition, 1.0);\r\n}"
+#define tracer_vert "#version 330\n\nlayout (location = 1) in vec3 aPosition;\n\nout vec3 position;\n\nvoid main() {\n    position = aPosition;\n    gl_Position = vec4(aPosition, 1.0);\n}"
 
-#define tracer_frag "#version 450 core\r\n\r\n#define PI 3.1415926\r\n#define INF 114514.0\r\n#define ERR 0.0001\r\n\r\nin vec3 position;\r\nlayout (location = 0) out vec3 FragData;\r\n\r\n//\xe5\xb1\x8f\xe5\xb9\x95\xe5\x8f\x82\xe6\x95\xb0\r\nuniform int width;\r\nuniform int height;\r\n\r\n//\xe5\xb8\xa7\xe6\x95\xb0\r\nuniform int frame;\r\nuniform int maxFrame;\r\n\r\n//\xe4\xb8\x8a\xe4\xb8\x80\xe5\xb8\xa7\xe7\x9a\x84\xe5\xb8\xa7\xe7\xbc\x93\xe5\xad\x98\r\nuniform sampler2D lastFrame;\r\n\r\n//\xe8\xa7\x86\xe7\x82\xb9\r\nuniform vec3 eyePos;\r\n\r\n//\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\xef\xbc\x9a\xe5\x8f\x82\xe8\x80\x83material.h\r\nstruct Material {\r\n    bool lighting;\r\n    vec3 color;\r\n    float specularRate;\r\n    float specularTint;\r\n    float specularRoughness;\r\n    float refractRate;\r\n    float refractTint;\r\n    float refractIndex;\r\n    float refractRoughness;\r\n};\r\n\r\n//`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\r\nstruct BVHNode {\r\n    vec3 AA;\r\n    vec3 BB;\r\n    int l;\r\n    int r;\r\n    int n;\r\n    int index;\r\n};\r\n\r\n/*****************************************************\r\n * \xe6\xa8\xa1\xe5\x9e\x8b\xe5\xae\x9a\xe4\xb9\x89\r\n *****************************************************/\r\n\r\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\r\nstruct Quad {\r\n    vec3 samples[4];\r\n    vec3 normal;\r\n};\r\n\r\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\r\nstruct QuadModel {\r\n    Quad quad;\r\n    Material material;\r\n    bool useTexture;\r\n    sampler2D texture;\r\n};\r\n\r\n//\xe7\x90\x83\xe4\xbd\x93\r\nstruct Sphere {\r\n    vec3 center;\r\n    float radius;\r\n};\r\n\r\n//\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\r\nstruct SphereModel {\r\n    Sphere sph;\r\n    Material material;\r\n    bool useTexture;\r\n    sampler2D texture;\r\n};\r\n\r\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\r\nstruct Cylinder {\r\n    vec3 center;\r\n    float radius;\r\n    float height;\r\n};\r\n\r\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\r\nstruct CylinderModel {\r\n    Cylinder cyl;\r\n    Material material;\r\n    bool useTexture;\r\n    sampler2D texture;\r\n};\r\n\r\n//\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\r\nstruct CustomizedModel {\r\n    samplerBuffer patchTex;\r\n    samplerBuffer bvhTex;\r\n    vec3 center;\r\n    float height;\r\n    Material material;\r\n    bool useTexture;\r\n    sampler2D texture;\r\n};\r\n\r\n/*****************************************************/\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\r\nstruct Ray {\r\n    vec3 startPoint;\r\n    vec3 direction;\r\n};\r\n\r\n//\xe5\x87\xbb\xe4\xb8\xad\xe4\xbf\xa1\xe6\x81\xaf\r\nstruct HitInfo {\r\n    float distance;         // \xe4\xb8\x8e\xe4\xba\xa4\xe7\x82\xb9\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\r\n    vec3 hitPoint;          // \xe5\x85\x89\xe7\xba\xbf\xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\r\n    vec3 normal;            // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\xba\xbf\r\n    vec3 viewDir;           // \xe5\x87\xbb\xe4\xb8\xad\xe8\xaf\xa5\xe7\x82\xb9\xe7\x9a\x84\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\r\n    Material material;      // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\r\n};\r\n\r\n//\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbf\xa1\xe6\x81\xaf\r\nuniform int quadNum;\r\nuniform QuadModel quads[8];        //\xe6\x9c\x80\xe5\xa4\x9a\xe5\x85\xab\xe4\xb8\xaa\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\r\nuniform int sphereNum;\r\nuniform SphereModel spheres[3];    //\xe6\x9c\x80\xe5\xa4\x9a\xe4\xb8\x89\xe4\xb8\xaa\xe7\x90\x83\r\nuniform int cylinderNum;\r\nuniform CylinderModel cylinders[3];//\xe6\x9c\x80\xe5\xa4\x9a\xe4\xb8\x89\xe4\xb8\xaa\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\r\nuniform CustomizedModel customized;//\xe4\xbb\x85\xe6\x94\xaf\xe6\x8c\x81\xe4\xb8\x80\xe4\xb8\xaa\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\r\n\r\n/*****************************************************\r\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xef\xbc\x9a\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90+\xe5\x93\x88\xe5\xb8\x8c\r\n *****************************************************/\r\n\r\n//\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\r\nuint seed = uint(\r\n    uint((position.x * 0.5 + 0.5) * width) * 1973u +\r\n    uint((position.y * 0.5 + 0.5) * height) * 9277u +\r\n    uint(frame * maxFrame) * 26699u);\r\n\r\n//\xe5\x93\x88\xe5\xb8\x8c\xe5\x87\xbd\xe6\x95\xb0\r\nuint hash(inout uint seed) {\r\n    seed *= 0x27d4eb2du;\r\n    seed = seed ^ (seed >> 15);\r\n    return seed;\r\n}\r\n\r\n//\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\r\nfloat rand() {\r\n    return float(hash(seed)) / 4294967296.0;\r\n}\r\n\r\n/*****************************************************\r\n * sobol\xe5\xba\x8f\xe5\x88\x97\r\n *****************************************************/\r\n\r\nuniform uint V[64];\r\n\r\n//\xe4\xbb\x85\xe4\xb8\x8e\xe5\x83\x8f\xe7\xb4\xa0\xe5\x9d\x90\xe6\xa0\x87\xe6\x9c\x89\xe5\x85\xb3\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\r\nuint pseed = uint(\r\n    uint((position.x * 0.5 + 0.5) * width) * 1973u +\r\n    uint((position.y * 0.5 + 0.5) * height) * 9277u +\r\n    512u * 26699u);\r\n\r\n//\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\r\nint gray = frame ^ (frame >> 1);\r\n\r\n//\xe7\x94\x9f\xe6\x88\x90`sobol`\xe6\x95\xb0\r\nfloat sobol(int d, int i) {\r\n    uint result = 0u;\r\n    int offset = d * 32;\r\n    for (int j = 0, k = i; k != 0; k >>= 1, j++) {\r\n        if ((k & 1) == 1) {\r\n            result ^= V[j + offset];\r\n        }\r\n    }\r\n    return float(result) / 4294967296.0;\r\n}\r\n\r\nfloat CranleyPattersonRotation(float p) {\r\n    float u = float(hash(pseed)) / 4294967296.0;\r\n    p += u;\r\n    if(p > 1.0) p -= 1.0;\r\n    if(p < 0.0) p += 1.0;\r\n    return p;\r\n}\r\n\r\n/*****************************************************\r\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe5\x90\x91\xe9\x87\x8f\r\n *****************************************************/\r\n\r\n//\xe5\xb0\x86\xe5\x90\x91\xe9\x87\x8fv\xe6\x8a\x95\xe5\xbd\xb1\xe5\x88\xb0N\xe7\x9a\x84\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\r\nvec3 toNormalHemisphere(vec3 v, vec3 N) {\r\n    vec3 helper = vec3(1.0, 0.0, 0.0);\r\n    if(abs(N.x) >= 1.0 - ERR) helper = vec3(0.0, 0.0, 1.0);\r\n    vec3 tangent = normalize(cross(N, helper));\r\n    vec3 bitangent = normalize(cross(N, tangent));\r\n    return v.x * tangent + v.y * bitangent + v.z * N;\r\n}\r\n\r\n//\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\xe9\x9a\x8f\xe6\x9c\xba\xe9\x87\x87\xe6\xa0\xb7\r\nvec3 sampleHemisphere(vec3 N) {\r\n    float r = sqrt(rand());\r\n    float t = rand() * (2.0 * PI);\r\n    float x = r * cos(t);\r\n    float y = r * sin(t);\r\n    float z = sqrt(1.0 - x * x - y * y);\r\n    return toNormalHemisphere(vec3(x, y, z), N);\r\n}\r\n\r\n//\xe6\xa0\xb9\xe6\x8d\xaesobol\xe5\xba\x8f\xe5\x88\x97\xe7\x9a\x84\xe5\x9d\x87\xe5\x8c\x80\xe5\x8d\x8a\xe7\x90\x83\xe9\x87\x87\xe6\xa0\xb7\r\nvec3 sampleSobolHemisphere(vec3 N) {\r\n    float u = CranleyPattersonRotation(sobol(0, gray));\r\n    float v = CranleyPattersonRotation(sobol(1, gray));\r\n//    float u = sobol(0, gray);\r\n//    float v = sobol(1, gray);\r\n    float r = sqrt(u);\r\n    float t = v * (2.0 * PI);\r\n    float x = r * cos(t);\r\n    float y = r * sin(t);\r\n    float z = sqrt(1.0 - x * x - y * y);\r\n    return toNormalHemisphere(vec3(x, y, z), N);\r\n}\r\n\r\n/*****************************************************\r\n * \xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\r\n *****************************************************/\r\n\r\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\r\nvec2 quadTexCoord(in vec3 samples[4], vec3 P) {\r\n    vec3 m = samples[2] - samples[0];\r\n    vec3 n = samples[0] - samples[1];\r\n    vec3 q = P - samples[1];\r\n    if (m.x == 0.0 && n.x == 0.0 && q.x == 0) {\r\n        mat2 mn = mat2(m.yz, n.yz);\r\n        return inverse(mn) * q.yz;\r\n    }\r\n    if (m.y == 0.0 && n.y == 0.0 && q.y == 0.0) {\r\n        mat2 mn = mat2(m.xz, n.xz);\r\n        return inverse(mn) * q.xz;\r\n    }\r\n    mat2 mn = mat2(m.xy, n.xy);\r\n    return inverse(mn) * n.xy;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\r\nbool hitQuad(Ray r, in Quad quad, inout HitInfo hit) {\r\n    //\xe6\xb1\x82\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\xb9\xb3\xe9\x9d\xa2\xe4\xba\xa4\xe7\x82\xb9\r\n    vec3 n1 = quad.samples[1] - quad.samples[0];\r\n    vec3 n2 = quad.samples[2] - quad.samples[0];\r\n    vec3 normal = normalize(cross(n1, n2));\r\n    float d = -dot(quad.samples[0], normal);\r\n    float m = dot(r.direction, normal);\r\n    if (m >= -ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe8\x83\x8c\xe5\x90\x91\xe9\x9d\xa2\r\n    float t = -(d + dot(r.startPoint, normal)) / m;\r\n    if (t <= ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\r\n    vec3 P = r.startPoint + r.direction * t;\r\n\r\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe5\x8f\x89\xe4\xb9\x98\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\xe5\x85\xb3\xe7\xb3\xbb\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x90\xa6\xe5\x9c\xa8\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe5\x86\x85\r\n    vec3 n3 = P - quad.samples[0];\r\n    vec3 n4 = P - quad.samples[1];\r\n    vec3 n5 = P - quad.samples[2];\r\n    float f1 = dot(cross(n1, n3), normal);\r\n    float f2 = dot(cross(n3, n2), normal);\r\n    float f3 = dot(cross(n5, n1), normal);\r\n    float f4 = dot(cross(n2, n4), normal);\r\n\r\n    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {\r\n        hit.distance = t;\r\n        hit.hitPoint = P;\r\n        hit.viewDir = r.direction;\r\n        hit.normal = normal;\r\n        return true;\r\n    }\r\n\r\n    return false;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\r\nbool hitQuadModel(Ray r, in QuadModel quadM, inout HitInfo hit) {\r\n    bool ret = hitQuad(r, quadM.quad, hit);\r\n    if (ret) {\r\n        hit.material = quadM.material;\r\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\r\n        if (quadM.useTexture) {\r\n            vec2 tex = quadTexCoord(quadM.quad.samples, hit.hitPoint);\r\n            vec3 color = texture(quadM.texture, tex).xyz;\r\n            hit.material.color = color;\r\n        }\r\n    }\r\n    return ret;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\r\nbool hitSphere(Ray r, in Sphere sphere, inout HitInfo hit) {\r\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe7\x90\x83\xe5\xbf\x83\xe8\xb7\x9d\xe7\xa6\xbb\r\n    float t = dot(sphere.center - r.startPoint, r.direction);\r\n    vec3 T = r.startPoint + r.direction * t;\r\n    vec3 CP = T - sphere.center;\r\n    float l_CP = length(CP);\r\n\r\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe7\x9b\xb8\xe4\xba\xa4\r\n    if (l_CP > sphere.radius) return false;\r\n\r\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xba\xa4\xe7\x82\xb9\r\n    float delta = sqrt(sphere.radius * sphere.radius - l_CP * l_CP);\r\n    float t1 = t - delta;\r\n    float t2 = t + delta;\r\n\r\n    //\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x93\xaa\xe4\xb8\xaa\xe4\xba\xa4\xe7\x82\xb9\xef\xbc\x8c\xe5\xb9\xb6\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\r\n    if (t1 > ERR) t = t1;\r\n    else if (t2 > ERR) t = t2;\r\n    else return false;\r\n\r\n    //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\r\n    if (t >= hit.distance - ERR) return false;\r\n\r\n    hit.distance = t;\r\n    hit.hitPoint = r.startPoint + r.direction * t;\r\n    hit.normal = normalize(hit.hitPoint - sphere.center);\r\n    hit.viewDir = r.direction;\r\n    return true;\r\n}\r\n\r\n//\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe5\x88\xb0\xe7\x90\x83\xe9\x9d\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\r\nvec2 sphereTexCoord(vec3 N) {\r\n    float ang_x = atan(N.z, N.x);\r\n    float ang_y = asin(N.y);\r\n    vec2 uv = vec2(ang_x, ang_y);\r\n    uv.x = 1.0 - ang_x / (2.0 * PI);\r\n    uv.y = 0.5 + ang_y / PI;\r\n    return uv;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\r\nbool hitSphereModel(Ray r, in SphereModel sphM, inout HitInfo hit) {\r\n    bool ret = hitSphere(r, sphM.sph, hit);\r\n    if (ret) {\r\n        hit.material = sphM.material;\r\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\r\n        if (sphM.useTexture) {\r\n            vec2 texc = sphereTexCoord(hit.normal);\r\n            vec3 color = texture(sphM.texture, texc).xyz;\r\n            hit.material.color = color;\r\n        }\r\n        //\xe6\x8a\x98\xe5\xb0\x84\xe7\x8e\x87\xef\xbc\x9a\xe5\xb0\x84\xe5\x87\xba\xe6\x97\xb6\xe9\x9c\x80\xe8\xa6\x81\xe5\x8f\x96\xe5\x80\x92\xe6\x95\xb0\r\n        float ref_ang = hit.material.refractIndex;\r\n        if (ref_ang != 0 && dot(hit.normal, r.direction) > 0) {\r\n            hit.material.refractIndex = 1.0 / ref_ang;\r\n            hit.normal = -hit.normal;\r\n        }\r\n    }\r\n    return ret;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\r\nbool hitCylinder(Ray r, in Cylinder cyl, inout HitInfo hit) {\r\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe6\x9c\x80\xe7\x9f\xad\xe8\xb7\x9d\xe7\xa6\xbb\r\n    vec2 SF = cyl.center.xz - r.startPoint.xz;\r\n    vec2 d_ST = r.direction.xz;\r\n    float l_FT = abs(SF.y * d_ST.x - SF.x * d_ST.y) / length(d_ST);\r\n\r\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9b\xb8\xe4\xba\xa4\r\n    if (l_FT > cyl.radius) return false;\r\n\r\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9a\x84\xe4\xba\xa4\xe7\x82\xb9\r\n    float l_SF = length(SF);\r\n    float t = sqrt(l_SF * l_SF - l_FT * l_FT) / length(d_ST);\r\n    float right = cyl.radius * cyl.radius - l_FT * l_FT;\r\n    float left = 1.0 - r.direction.y * r.direction.y;\r\n    float delta = sqrt(right / left);\r\n    float t1 = t - delta;\r\n    float t2 = t + delta;\r\n    vec3 M = r.startPoint + r.direction * t1;\r\n    vec3 N = r.startPoint + r.direction * t2;\r\n\r\n    //\xe4\xba\xa4\xe7\x82\xb9\xe6\x96\xb9\xe5\x90\x91\xe7\x9b\xb8\xe5\x8f\x8d\r\n    if (t2 <= ERR) return false;\r\n\r\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8M\r\n    if (M.y >= cyl.center.y && M.y <= cyl.center.y + cyl.height) {\r\n        if (t1 <= ERR) return false; //\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\r\n        if (t1 >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\r\n        vec2 nor = normalize(M.xz - cyl.center.xz);\r\n        hit.distance = t1;\r\n        hit.hitPoint = M;\r\n        hit.normal = vec3(nor.x, 0.0, nor.y);\r\n        hit.viewDir = r.direction;\r\n        return true;\r\n    }\r\n\r\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8b\xe5\xba\x95\xe9\x9d\xa2\r\n    if (M.y < cyl.center.y && N.y >= cyl.center.y) {\r\n        float m = (cyl.center.y - r.startPoint.y) / r.direction.y;\r\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\r\n        hit.distance = m;\r\n        hit.hitPoint = r.startPoint + r.direction * m;\r\n        hit.normal = vec3(0.0, -1.0, 0.0);\r\n        hit.viewDir = r.direction;\r\n        return true;\r\n    }\r\n\r\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8a\xe5\xba\x95\xe9\x9d\xa2\r\n    if (M.y > cyl.center.y + cyl.height && N.y <= cyl.center.y + cyl.height) {\r\n        float m = (cyl.center.y + cyl.height - r.startPoint.y) / r.direction.y;\r\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\r\n        hit.distance = m;\r\n        hit.hitPoint = r.startPoint + r.direction * m;\r\n        hit.normal = vec3(0.0, 1.0, 0.0);\r\n        hit.viewDir = r.direction;\r\n        return true;\r\n    }\r\n\r\n    return false;\r\n}\r\n\r\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xbe\xa7\xe9\x9d\xa2\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\r\nvec2 cylinderTexCoord(vec3 P, vec3 center, float height) {\r\n    float ang_x = atan(P.z - center.z, P.x - center.x);\r\n    vec2 uv;\r\n    uv.x = 1.0 - ang_x / (2.0 * PI);\r\n    uv.y = (P.y - center.y) / height;\r\n    return uv;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\r\nbool hitCylinderModel(Ray r, in CylinderModel cylM, inout HitInfo hit) {\r\n    bool ret = hitCylinder(r, cylM.cyl, hit);\r\n    if (ret) {\r\n        hit.material = cylM.material;\r\n        hit.material.refractRate = 0.0; //\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\r\n        float y = hit.hitPoint.y;\r\n        float y_l = cylM.cyl.center.y;\r\n        float y_h = y_l + cylM.cyl.height;\r\n        //\xe5\x8f\xaa\xe6\x9c\x89\xe4\xbe\xa7\xe9\x9d\xa2\xe6\x9c\x89\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\r\n        if (cylM.useTexture && y > y_l && y < y_h) {\r\n            vec2 tex = cylinderTexCoord(hit.hitPoint, cylM.cyl.center, cylM.cyl.height);\r\n            vec3 color = texture(cylM.texture, tex).xyz;\r\n            hit.material.color = color;\r\n        }\r\n    }\r\n    return ret;\r\n}\r\n\r\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe6\x8d\xae\r\nQuad getPatch(int i) {\r\n    int offset = i * 5;\r\n    Quad q;\r\n\r\n    q.samples[0] = texelFetch(customized.patchTex, offset).xyz;\r\n    q.samples[1] = texelFetch(customized.patchTex, offset + 1).xyz;\r\n    q.samples[2] = texelFetch(customized.patchTex, offset + 2).xyz;\r\n    q.samples[3] = texelFetch(customized.patchTex, offset + 3).xyz;\r\n    q.normal = texelFetch(customized.patchTex, offset + 4).xyz;\r\n\r\n    return q;\r\n}\r\n\r\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\xe6\x95\xb0\xe6\x8d\xae\r\nBVHNode getBVH(int i) {\r\n    int offset = i * 4;\r\n    BVHNode n;\r\n\r\n    n.AA = texelFetch(customized.bvhTex, offset).xyz;\r\n    n.BB = texelFetch(customized.bvhTex, offset + 1).xyz;\r\n    ivec3 tmp = ivec3(texelFetch(customized.bvhTex, offset + 2).xyz);\r\n    n.l = tmp.x;\r\n    n.r = tmp.y;\r\n    tmp = ivec3(texelFetch(customized.bvhTex, offset + 3).xyz);\r\n    n.n = tmp.x;\r\n    n.index = tmp.y;\r\n\r\n    return n;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad`AABB`\xe5\x8c\x85\xe5\x9b\xb4\xe7\x9b\x92\r\nfloat hitAABB(Ray r, vec3 AA, vec3 BB) {\r\n    vec3 M = (BB - r.startPoint) / r.direction;\r\n    vec3 N = (AA - r.startPoint) / r.direction;\r\n\r\n    vec3 tmax = max(M, N);\r\n    vec3 tmin = min(M, N);\r\n\r\n    float t1 = min(tmax.x, min(tmax.y, tmax.z));\r\n    float t2 = max(tmin.x, max(tmin.y, tmin.z));\r\n\r\n    return t1 >= t2 && t2 > ERR ? t2 : -1.0;\r\n}\r\n\r\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\r\nbool hitCustomizedModel(Ray r, inout HitInfo hit) {\r\n    int stack[8];\r\n    int p = 0;\r\n\r\n    stack[p++] = 0;\r\n    while (p > 0) {\r\n        int top = stack[--p];\r\n        BVHNode node = getBVH(top);\r\n\r\n        //\xe5\x8f\xb6\xe5\xad\x90\xe7\xbb\x93\xe7\x82\xb9\r\n        if (node.n > 0) {\r\n            int m = node.index;\r\n            int n = m + node.n;\r\n            for (int i = m; i < n; i++) {\r\n                Quad q = getPatch(i);\r\n                if (hitQuad(r, q, hit)) {\r\n                    hit.material = customized.material;\r\n                    hit.material.refractRate = 0.0; //\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\r\n                    //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\r\n                    if (customized.useTexture) {\r\n                        vec2 tex = cylinderTexCoord(hit.hitPoint, customized.center, customized.height);\r\n                        vec3 color = texture(customized.texture, tex).xyz;\r\n                        hit.material.color = color;\r\n                    }\r\n                    return true;\r\n                }\r\n            }\r\n        }\r\n\r\n        //\xe4\xb8\x8e\xe5\xb7\xa6\xe5\x8f\xb3\xe7\x9b\x92\xe5\xad\x90\xe6\xb1\x82\xe4\xba\xa4\r\n        float t1 = -1.0, t2 = -1.0;\r\n        if (node.l >= 0) {\r\n            BVHNode l_node = getBVH(node.l);\r\n            t1 = hitAABB(r, l_node.AA, l_node.BB);\r\n        }\r\n        if (node.r >= 0) {\r\n            BVHNode r_node = getBVH(node.r);\r\n            t2 = hitAABB(r, r_node.AA, r_node.BB);\r\n        }\r\n\r\n        //\xe5\x9c\xa8\xe6\x9c\x80\xe8\xbf\x91\xe7\x9a\x84\xe7\x9b\x92\xe5\xad\x90\xe4\xb8\xad\xe6\x90\x9c\xe7\xb4\xa2\r\n        if (t1 > 0 && t2 > 0) {\r\n            if (t1 < t2) {\r\n                stack[p++] = node.r;\r\n                stack[p++] = node.l;\r\n            } else {\r\n                stack[p++] = node.l;\r\n                stack[p++] = node.r;\r\n            }\r\n        } else if (t1 > 0) {\r\n            stack[p++] = node.l;\r\n        } else if (t2 > 0) {\r\n            stack[p++] = node.r;\r\n        }\r\n    }\r\n\r\n    return false;\r\n}\r\n\r\n//\xe5\x87\xbb\xe4\xb8\xad\xe5\x88\xa4\xe6\x96\xad\r\nbool hitModel(Ray r, out HitInfo hit) {\r\n    hit.distance = INF;\r\n    bool ret = false;\r\n\r\n    for (int i = 0; i < cylinderNum; i++) {\r\n        ret = hitCylinderModel(r, cylinders[i], hit) || ret;\r\n    }\r\n    for (int i = 0; i < quadNum; i++) {\r\n        ret = hitQuadModel(r, quads[i], hit) || ret;\r\n    }\r\n    for (int i = 0; i < sphereNum; i++) {\r\n        ret = hitSphereModel(r, spheres[i], hit) || ret;\r\n    }\r\n    ret = hitCustomizedModel(r, hit) || ret;\r\n\r\n    return ret;\r\n}\r\n\r\n//\xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xef\xbc\x9a\xe7\xba\xbf\xe6\x80\xa7\xe5\x8c\x96\xe9\x80\x92\xe5\xbd\x92\r\nvec3 pathTracing(Ray r, int maxDepth) {\r\n    if (maxDepth > 8) maxDepth = 8; //\xe6\x9c\x80\xe5\xa4\x9a\xe9\x80\x92\xe5\xbd\x92\xe5\x85\xab\xe5\xb1\x82\r\n    vec3 color[8];   //\xe8\xae\xb0\xe5\xbd\x95\xe6\xaf\x8f\xe4\xb8\x80\xe5\xb1\x82\xe9\x80\x92\xe5\xbd\x92\xe7\x9a\x84\xe5\x9f\xba\xe7\xa1\x80\xe9\xa2\x9c\xe8\x89\xb2\r\n    int type[8];     //\xe8\xae\xb0\xe5\xbd\x95\xe6\xaf\x8f\xe4\xb8\x80\xe5\xb1\x82\xe9\x80\x92\xe5\xbd\x92\xe7\x9a\x84\xe5\x85\x89\xe7\xba\xbf\xe7\xb1\xbb\xe5\x9e\x8b\r\n    float cosine[8]; //\xe8\xae\xb0\xe5\xbd\x95\xe6\xaf\x8f\xe4\xb8\x80\xe5\xb1\x82\xe9\x80\x92\xe5\xbd\x92\xe7\x9a\x84\xe5\xa4\xb9\xe8\xa7\x92\xe4\xbd\x99\xe5\xbc\xa6\r\n    float tint[8];   //\xe8\xae\xb0\xe5\xbd\x95\xe6\xaf\x8f\xe4\xb8\x80\xe5\xb1\x82\xe9\x80\x92\xe5\xbd\x92\xe7\x9a\x84\xe6\xb7\xb7\xe5\x90\x88\xe6\x8c\x87\xe6\x95\xb0\r\n    int depth;\r\n\r\n    for (depth = 0; depth < maxDepth; depth++) {\r\n        //\xe8\x8b\xa5\xe6\x9c\xaa\xe5\x87\xbb\xe4\xb8\xad\xe5\x88\x99\xe7\x9b\xb4\xe6\x8e\xa5\xe8\xbf\x94\xe5\x9b\x9e\r\n        HitInfo hit;\r\n        if (!hitModel(r, hit)) {\r\n            color[depth] = vec3(0.0);\r\n            break;\r\n        }\r\n\r\n        //\xe5\x8f\x8d\xe4\xbc\xbd\xe9\xa9\xac\xe6\xa0\xa1\xe6\xad\xa3\r\n        color[depth] = pow(hit.material.color, vec3(2.2));\r\n//        color[depth] = hit.material.color;\r\n\r\n        //\xe8\x8b\xa5\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe5\x88\x99\xe8\xbf\x94\xe5\x9b\x9e\r\n        if (hit.material.lighting) {\r\n            color[depth] *= 2;\r\n            break;\r\n        }\r\n\r\n        //\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe5\xa4\xb9\xe8\xa7\x92\xe4\xbd\x99\xe5\xbc\xa6\r\n        cosine[depth] = abs(dot(hit.normal, r.direction));\r\n\r\n        //\xe9\x9a\x8f\xe6\x9c\xba\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\r\n        vec3 oldRay = r.direction;\r\n        r.direction = depth == 0 ? sampleSobolHemisphere(hit.normal) : sampleHemisphere(hit.normal);\r\n//        r.direction = sampleHemisphere(hit.normal);\r\n        r.startPoint = hit.hitPoint;\r\n\r\n        //\xe6\xa0\xb9\xe6\x8d\xae\xe7\x89\xa9\xe4\xbd\x93\xe6\x9d\x90\xe8\xb4\xa8\xe5\x86\xb3\xe5\xae\x9a\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\r\n        float p = rand();\r\n        //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\r\n        if (p < hit.material.specularRate) {\r\n            //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\r\n            vec3 ref = reflect(oldRay, hit.normal);\r\n            r.direction = normalize(mix(ref, r.direction, hit.material.specularRoughness));\r\n            tint[depth] = hit.material.specularTint;\r\n            type[depth] = 1;\r\n        } else if (hit.material.specularRate <= p && p <= hit.material.specularRate + hit.material.refractRate) {\r\n            //\xe6\x8a\x98\xe5\xb0\x84\r\n            vec3 ref = refract(oldRay, hit.normal, 1.0 / hit.material.refractIndex);\r\n            r.direction = normalize(mix(ref, -r.direction, hit.material.refractRoughness));\r\n            tint[depth] = hit.material.refractTint;\r\n            type[depth] = 2;\r\n        } else {\r\n            //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\r\n            type[depth] = 0;\r\n        }\r\n    }\r\n\r\n    //\xe8\xae\xa1\xe7\xae\x97\xe7\xb4\xaf\xe7\xa7\xaf\xe9\xa2\x9c\xe8\x89\xb2\r\n    for (int i = depth - 1; i >= 0; i--) {\r\n        vec3 light = color[i + 1] * sqrt(cosine[i]);\r\n        if (type[i] > 0) {\r\n            color[i] = mix(color[i] * length(light), light, tint[i]);\r\n        } else {\r\n            color[i] *= light;\r\n        }\r\n    }\r\n\r\n    return color[0];\r\n}\r\n\r\nvoid main() {\r\n    //\xe5\x89\x8d\xe4\xb8\x80\xe5\xb8\xa7\r\n    vec2 pixel = position.xy * 0.5 + 0.5;\r\n    vec3 lastColor = texture(lastFrame, pixel).xyz;\r\n    if (frame >= maxFrame) {\r\n        FragData = lastColor;\r\n        return;\r\n    }\r\n\r\n    //\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xe6\x96\xb9\xe5\x90\x91\xe4\xb8\xba\xe8\xa7\x86\xe7\x82\xb9\xe6\x8c\x87\xe5\x90\x91\xe5\x83\x8f\xe7\xb4\xa0\xe7\x82\xb9\xef\xbc\x8c\xe5\x8a\xa0\xe5\x85\xa5\xe9\x9a\x8f\xe6\x9c\xba\xe5\x81\x8f\xe7\xa7\xbb\xe9\x87\x8f\xe4\xbb\xa5\xe6\x8a\x97\xe9\x94\xaf\xe9\xbd\xbf\r\n    Ray r;\r\n    r.startPoint = eyePos;\r\n    vec3 screen = position;\r\n    float d = rand(), th = rand() * (2.0 * PI);\r\n    screen.x += (d * sin(th) - 0.5) * (2.0 / width);\r\n    screen.y += (d * cos(th) - 0.5) * (2.0 / height);\r\n    r.direction = normalize(screen - eyePos);\r\n\r\n    //\xe5\xbd\x93\xe5\x89\x8d\xe5\xb8\xa7\xe7\x9a\x84\xe5\x83\x8f\xe7\xb4\xa0\xe9\xa2\x9c\xe8\x89\xb2\xe5\x8a\xa0\xe4\xb8\x8a\xe5\x89\x8d\xe4\xb8\x80\xe5\xb8\xa7\xe7\x9a\x84\xe5\x83\x8f\xe7\xb4\xa0\xe9\xa2\x9c\xe8\x89\xb2\r\n    vec3 color = pathTracing(r, 6);\r\n    float rate = 1.0 / (frame + 1);\r\n//    FragData = mix(lastColor, color * (2.0 * PI), rate);\r\n    FragData = lastColor + color * (2.0 * PI);\r\n}"
+#define tracer_frag "#version 450 core\n\n//\xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x85\xac\xe5\x85\xb1\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe5\x9c\xba\xe6\x99\xaf\xe6\x8f\x8f\xe8\xbf\xb0\xe3\x80\x81\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xe3\x80\x81\xe9\x87\x87\xe6\xa0\xb7\xe4\xb8\x8e\xe6\xb1\x82\xe4\xba\xa4\xef\xbc\x8c\xe7\x94\xb1tracer.frag\xe4\xb8\x8ewavefront.comp\xe5\x8c\x85\xe5\x90\xab\n//\xe5\x8c\x85\xe5\x90\xab\xe5\x89\x8d\xe9\xa1\xbb\xe5\xb7\xb2\xe5\xa3\xb0\xe6\x98\x8e#version\n\n#define PI 3.1415926\n#define INF 114514.0\n#define ERR 0.0001\n#define CONE_DIFFUSE_SPREAD 0.1 //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe5\x90\x8e\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\n#define CONE_ROUGH_SPREAD 0.5   //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x90\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\xe4\xb8\x8e\xe6\xa8\xa1\xe7\xb3\x8a\xe5\xba\xa6\xe4\xb9\x8b\xe6\xaf\x94\n\n//\xe5\xb1\x8f\xe5\xb9\x95\xe5\x8f\x82\xe6\x95\xb0\nuniform int width;\nuniform int height;\n\n//\xe5\xb8\xa7\xe6\x95\xb0\xef\xbc\x9a\xe5\xb7\xb2\xe7\xb4\xaf\xe7\xa7\xaf\xe7\x9a\x84\xe6\xa0\xb7\xe6\x9c\xac\xe6\x95\xb0\xef\xbc\x8c\xe4\xb9\x9f\xe6\x98\xaf\xe6\x9c\xac\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe4\xb8\xad\xe9\xa6\x96\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe5\xba\x8f\xe5\x8f\xb7\nuniform int frame;\nuniform int maxFrame;\n\n//\xe8\xa7\x86\xe7\x82\xb9\nuniform vec3 eyePos;\n\n//\xe6\x9c\x80\xe5\xa4\xa7\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xef\xbc\x9a\xe8\xbf\x90\xe8\xa1\x8c\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\xef\xbc\x8c\xe4\xb8\x8d\xe9\x99\x90\xe5\x88\xb6\xe4\xb8\x8a\xe9\x99\x90\nuniform int maxDepth;\n//\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xe8\xbe\xbe\xe5\x88\xb0\xe5\x90\x8e\xe5\xbc\x80\xe5\xa7\x8b\xe4\xbb\xa5\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe8\xb7\xaf\xe5\xbe\x84\nuniform int rouletteDepth;\n\n//\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x85\xb1\xe7\x94\xa8\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\nuniform sampler2DArray textures;\n\n//\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\xef\xbc\x9a\xe5\x8f\x82\xe8\x80\x83material.h\nstruct Material {\n    vec3 color;\n    float specularRate;\n    float specularTint;\n    float specularRoughness;\n    float refractRate;\n    float refractTint;\n    float refractIndex;\n    float refractRoughness;\n    bool lighting;\n};\n\n//`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\nstruct BVHNode {\n    vec3 AA;\n    vec3 BB;\n    int l;\n    int r;\n    int n;\n    int index;\n};\n\n/*****************************************************\n * \xe6\xa8\xa1\xe5\x9e\x8b\xe5\xae\x9a\xe4\xb9\x89\xef\xbc\x9a\xe4\xbb\xa5std430\xe5\xb8\x83\xe5\xb1\x80\xe5\xad\x98\xe6\x94\xbe\xe5\x9c\xa8\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\xad\x98\xe5\x82\xa8\xe7\xbc\x93\xe5\x86\xb2\xe4\xb8\xad\xef\xbc\x8c\xe5\x8f\x82\xe8\x80\x83scenebuffer.h\n *****************************************************/\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nstruct Quad {\n    vec3 samples[4];\n    vec3 normal;\n};\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nstruct QuadModel {\n    Quad quad;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\nstruct Sphere {\n    vec3 center;\n    float radius;\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct SphereModel {\n    Sphere sph;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nstruct Cylinder {\n    vec3 center;\n    float radius;\n    float height;\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct CylinderModel {\n    Cylinder cyl;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xef\xbc\x9a\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe5\x90\x88\xe5\xb9\xb6\xe5\xad\x98\xe6\x94\xbe\xef\xbc\x8c\xe5\x90\x84\xe6\xa8\xa1\xe5\x9e\x8b\xe8\xae\xb0\xe5\xbd\x95\xe8\x87\xaa\xe5\xb7\xb1\xe7\x9a\x84\xe8\xb5\xb7\xe5\xa7\x8b\xe4\xb8\x8b\xe6\xa0\x87\nstruct CustomizedModel {\n    vec3 center;\n    float height;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    int nodeOffset;     //BVH\xe6\xa0\x91\xe6\xa0\xb9\xe7\xbb\x93\xe7\x82\xb9\xe5\x9c\xa8\xe7\xbb\x93\xe7\x82\xb9\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    int patchOffset;    //\xe9\xa6\x96\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe5\x9c\xa8\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n/*****************************************************/\n\n//\xe5\x85\x89\xe7\xba\xbf\nstruct Ray {\n    vec3 startPoint;\n    vec3 direction;\n};\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe4\xbf\xa1\xe6\x81\xaf\nstruct HitInfo {\n    float distance;         // \xe4\xb8\x8e\xe4\xba\xa4\xe7\x82\xb9\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\n    vec3 hitPoint;          // \xe5\x85\x89\xe7\xba\xbf\xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\n    vec3 normal;            // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\xba\xbf\n    vec3 viewDir;           // \xe5\x87\xbb\xe4\xb8\xad\xe8\xaf\xa5\xe7\x82\xb9\xe7\x9a\x84\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    Material material;      // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\n};\n\n//\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\xbd\x93\xe5\x89\x8d\xe5\x85\x89\xe7\xba\xbf\xe8\xb5\xb7\xe7\x82\xb9\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xef\xbc\x8c\xe7\x94\xa8\xe4\xba\x8e\xe9\x80\x89\xe6\x8b\xa9\xe7\xba\xb9\xe7\x90\x86\xe7\x9a\x84mipmap\xe5\xb1\x82\xe7\xba\xa7\nfloat coneWidth = 0.0;\nfloat coneSpread = 0.0;\n\n//\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbf\xa1\xe6\x81\xaf\xef\xbc\x9a\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe5\x8f\xaa\xe5\x8f\x97\xe7\xbc\x93\xe5\x86\xb2\xe5\xa4\xa7\xe5\xb0\x8f\xe9\x99\x90\xe5\x88\xb6\n//\xe5\x9c\xba\xe6\x99\xaf\xe7\x89\xb9\xe5\x8c\x96\xe7\x9a\x84\xe5\x8f\x98\xe4\xbd\x93\xe7\x94\xb1Scene\xe6\xb3\xa8\xe5\x85\xa5SPECIALIZED\xe5\x8f\x8a\xe4\xb8\x8b\xe5\x88\x97\xe5\xae\x8f\xef\xbc\x8c\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe6\x88\x90\xe4\xb8\xba\xe5\xb8\xb8\xe9\x87\x8f\xef\xbc\x8c\xe5\xbe\xaa\xe7\x8e\xaf\xe5\x8f\xaf\xe5\xb1\x95\xe5\xbc\x80\xef\xbc\x8c\xe6\x9c\xaa\xe7\x94\xa8\xe5\x88\xb0\xe7\x9a\x84\xe5\x88\x86\xe6\x94\xaf\xe5\x8f\xaf\xe6\xb6\x88\xe9\x99\xa4\n#ifdef SPECIALIZED\nconst int quadNum = QUAD_NUM;\nconst int sphereNum = SPHERE_NUM;\nconst int cylinderNum = CYLINDER_NUM;\nconst int customizedNum = CUSTOMIZED_NUM;\n#else\nuniform int quadNum;\nuniform int sphereNum;\nuniform int cylinderNum;\nuniform int customizedNum;\n#define USE_TEXTURE true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbd\xbf\xe7\x94\xa8\xe7\xba\xb9\xe7\x90\x86\n#define USE_REFRACT true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n#define ACCUMULATE_BLEND false //\xe7\xb4\xaf\xe7\xa7\xaf\xe6\x96\xb9\xe5\xbc\x8f\xef\xbc\x9a\xe5\x8a\xa0\xe6\xb3\x95\xe6\xb7\xb7\xe5\x90\x88\xef\xbc\x8c\xe6\x88\x96\xe8\xaf\xbb\xe5\x8f\x96\xe4\xb9\x8b\xe5\x89\x8d\xe7\x9a\x84\xe7\xbb\x93\xe6\x9e\x9c\xe5\x90\x8e\xe5\x86\x99\xe5\x85\xa5\xe5\x8f\xa6\xe4\xb8\x80\xe4\xb8\xaa\xe7\xbc\x93\xe5\x86\xb2\n#endif\n\nlayout (std430, binding = 0) readonly buffer MaterialBuffer {\n    Material materials[];\n};\nlayout (std430, binding = 1) readonly buffer QuadBuffer {\n    QuadModel quads[];\n};\nlayout (std430, binding = 2) readonly buffer SphereBuffer {\n    SphereModel spheres[];\n};\nlayout (std430, binding = 3) readonly buffer CylinderBuffer {\n    CylinderModel cylinders[];\n};\nlayout (std430, binding = 4) readonly buffer CustomizedBuffer {\n    CustomizedModel customized[];\n};\n\n//\xe6\x89\x80\xe6\x9c\x89\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x90\x88\xe5\xb9\xb6\xe5\x90\x8e\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe9\xa1\xb6\xe7\x82\xb9\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xef\xbc\x89\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe7\xbb\x93\xe7\x82\xb9\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe7\xbb\x93\xe7\x82\xb9\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe4\xb8\x89\xe7\xbb\xb4\xe5\x90\x91\xe9\x87\x8f\xef\xbc\x89\nuniform samplerBuffer patchTex;\nuniform samplerBuffer bvhTex;\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xef\xbc\x9a\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90+\xe5\x93\x88\xe5\xb8\x8c\n *****************************************************/\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe5\xbc\x80\xe5\xa7\x8b\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\nuint seed = 0u;\n\n//\xe5\x93\x88\xe5\xb8\x8c\xe5\x87\xbd\xe6\x95\xb0\nuint hash(inout uint seed) {\n    seed *= 0x27d4eb2du;\n    seed = seed ^ (seed >> 15);\n    return seed;\n}\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\nfloat rand() {\n    return float(hash(seed)) / 4294967296.0;\n}\n\n/*****************************************************\n * sobol\xe5\xba\x8f\xe5\x88\x97\n *****************************************************/\n\nuniform uint V[64];\n\n//\xe4\xbb\x85\xe4\xb8\x8e\xe5\x83\x8f\xe7\xb4\xa0\xe5\x9d\x90\xe6\xa0\x87\xe6\x9c\x89\xe5\x85\xb3\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\nuint pseed = 0u;\n\n//\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nint gray = 0;\n\n//\xe8\xae\xbe\xe7\xbd\xae\xe5\x83\x8f\xe7\xb4\xa0""coord\xe5\xa4\x84\xe7\xac\xaci\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xe4\xb8\x8e\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nvoid beginSample(uvec2 coord, int i) {\n    uint pixel = coord.x * 1973u + coord.y * 9277u;\n    seed = pixel + uint(i * maxFrame) * 26699u;\n    pseed = pixel + 512u * 26699u;\n    gray = i ^ (i >> 1);\n}\n\n//\xe7\x94\x9f\xe6\x88\x90`sobol`\xe6\x95\xb0\nfloat sobol(int d, int i) {\n    uint result = 0u;\n    int offset = d * 32;\n    for (int j = 0, k = i; k != 0; k >>= 1, j++) {\n        if ((k & 1) == 1) {\n            result ^= V[j + offset];\n        }\n    }\n    return float(result) / 4294967296.0;\n}\n\nfloat CranleyPattersonRotation(float p) {\n    float u = float(hash(pseed)) / 4294967296.0;\n    p += u;\n    if(p > 1.0) p -= 1.0;\n    if(p < 0.0) p += 1.0;\n    return p;\n}\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe5\x90\x91\xe9\x87\x8f\n *****************************************************/\n\n//\xe5\xb0\x86\xe5\x90\x91\xe9\x87\x8fv\xe6\x8a\x95\xe5\xbd\xb1\xe5\x88\xb0N\xe7\x9a\x84\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\nvec3 toNormalHemisphere(vec3 v, vec3 N) {\n    vec3 helper = vec3(1.0, 0.0, 0.0);\n    if(abs(N.x) >= 1.0 - ERR) helper = vec3(0.0, 0.0, 1.0);\n    vec3 tangent = normalize(cross(N, helper));\n    vec3 bitangent = normalize(cross(N, tangent));\n    return v.x * tangent + v.y * bitangent + v.z * N;\n}\n\n//\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\xe9\x9a\x8f\xe6\x9c\xba\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleHemisphere(vec3 N) {\n    float r = sqrt(rand());\n    float t = rand() * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xaesobol\xe5\xba\x8f\xe5\x88\x97\xe7\x9a\x84\xe5\x9d\x87\xe5\x8c\x80\xe5\x8d\x8a\xe7\x90\x83\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleSobolHemisphere(vec3 N) {\n    float u = CranleyPattersonRotation(sobol(0, gray));\n    float v = CranleyPattersonRotation(sobol(1, gray));\n//    float u = sobol(0, gray);\n//    float v = sobol(1, gray);\n    float r = sqrt(u);\n    float t = v * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n/*****************************************************\n * \xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\n *****************************************************/\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 quadTexCoord(in vec3 samples[4], vec3 P) {\n    vec3 m = samples[2] - samples[0];\n    vec3 n = samples[0] - samples[1];\n    vec3 q = P - samples[1];\n    if (m.x == 0.0 && n.x == 0.0 && q.x == 0) {\n        mat2 mn = mat2(m.yz, n.yz);\n        return inverse(mn) * q.yz;\n    }\n    if (m.y == 0.0 && n.y == 0.0 && q.y == 0.0) {\n        mat2 mn = mat2(m.xz, n.xz);\n        return inverse(mn) * q.xz;\n    }\n    mat2 mn = mat2(m.xy, n.xy);\n    return inverse(mn) * q.xy;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nbool hitQuad(Ray r, in Quad quad, inout HitInfo hit) {\n    //\xe6\xb1\x82\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\xb9\xb3\xe9\x9d\xa2\xe4\xba\xa4\xe7\x82\xb9\n    vec3 n1 = quad.samples[1] - quad.samples[0];\n    vec3 n2 = quad.samples[2] - quad.samples[0];\n    vec3 normal = normalize(cross(n1, n2));\n    float d = -dot(quad.samples[0], normal);\n    float m = dot(r.direction, normal);\n    if (m >= -ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe8\x83\x8c\xe5\x90\x91\xe9\x9d\xa2\n    float t = -(d + dot(r.startPoint, normal)) / m;\n    if (t <= ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    vec3 P = r.startPoint + r.direction * t;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe5\x8f\x89\xe4\xb9\x98\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\xe5\x85\xb3\xe7\xb3\xbb\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x90\xa6\xe5\x9c\xa8\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe5\x86\x85\n    vec3 n3 = P - quad.samples[0];\n    vec3 n4 = P - quad.samples[1];\n    vec3 n5 = P - quad.samples[2];\n    float f1 = dot(cross(n1, n3), normal);\n    float f2 = dot(cross(n3, n2), normal);\n    float f3 = dot(cross(n5, n1), normal);\n    float f4 = dot(cross(n2, n4), normal);\n\n    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {\n        hit.distance = t;\n        hit.hitPoint = P;\n        hit.viewDir = r.direction;\n        hit.normal = normal;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe6\x8c\x89\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe5\x9c\xa8\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa6\x86\xe7\x9b\x96\xe8\x8c\x83\xe5\x9b\xb4\xe9\x80\x89\xe6\x8b\xa9mipmap\xe5\xb1\x82\xe7\xba\xa7\xe9\x87\x87\xe6\xa0\xb7\xe7\xba\xb9\xe7\x90\x86\xef\xbc\x8cworldSize\xe4\xb8\xba\xe5\x8d\x95\xe4\xbd\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\xaf\xb9\xe5\xba\x94\xe7\x9a\x84\xe4\xb8\x96\xe7\x95\x8c\xe7\xa9\xba\xe9\x97\xb4\xe9\x95\xbf\xe5\xba\xa6\nvec3 sampleTexture(int layer, vec4 uvTransform, vec2 uv, float worldSize, in HitInfo hit) {\n    float footprint = (coneWidth + coneSpread * hit.distance) / max(abs(dot(hit.normal, hit.viewDir)), 0.01);\n    vec2 arraySize = vec2(textureSize(textures, 0).xy);\n    vec2 size = arraySize * uvTransform.xy;\n    float lod = log2(footprint * sqrt(size.x * size.y) / worldSize);\n\n    //\xe7\xba\xb9\xe7\x90\x86\xe5\x8f\xaa\xe5\x8d\xa0\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x80\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe9\x87\x8d\xe5\xa4\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xef\xbc\x8c\xe5\xb9\xb6\xe5\x9c\xa8\xe6\x89\x80\xe7\x94\xa8\xe5\xb1\x82\xe7\xba\xa7\xe4\xb8\x8a\xe7\xa6\xbb\xe5\x8c\xba\xe5\x9f\x9f\xe8\xbe\xb9\xe7\x95\x8c\xe4\xbf\x9d\xe7\x95\x99\xe5\x8d\x8a\xe4\xb8\xaa\xe7\xba\xb9\xe7\xb4\xa0\xef\xbc\x8c\xe9\x81\xbf\xe5\x85\x8d\xe9\x87\x87\xe6\xa0\xb7\xe5\x88\xb0\xe5\x8c\xba\xe5\x9f\x9f\xe5\xa4\x96\n    int level = clamp(int(ceil(lod)), 0, textureQueryLevels(textures) - 1);\n    vec2 half_texel = 0.5 / vec2(textureSize(textures, level).xy);\n    vec2 st = clamp(fract(uv) * uvTransform.xy, half_texel, uvTransform.xy - half_texel) + uvTransform.zw;\n    return textureLod(textures, vec3(st, layer), lod).xyz;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitQuadModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitQuad(r, quads[i].quad, hit);\n    if (ret) {\n        hit.material = materials[quads[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && quads[i].useTexture) {\n            vec2 tex = quadTexCoord(quads[i].quad.samples, hit.hitPoint);\n            float size = sqrt(length(quads[i].quad.samples[2] - quads[i].quad.samples[0]) *\n                              length(quads[i].quad.samples[0] - quads[i].quad.samples[1]));\n            vec3 color = sampleTexture(quads[i].layer, quads[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\nbool hitSphere(Ray r, in Sphere sphere, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe7\x90\x83\xe5\xbf\x83\xe8\xb7\x9d\xe7\xa6\xbb\n    float t = dot(sphere.center - r.startPoint, r.direction);\n    vec3 T = r.startPoint + r.direction * t;\n    vec3 CP = T - sphere.center;\n    float l_CP = length(CP);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_CP > sphere.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xba\xa4\xe7\x82\xb9\n    float delta = sqrt(sphere.radius * sphere.radius - l_CP * l_CP);\n    float t1 = t - delta;\n    float t2 = t + delta;\n\n    //\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x93\xaa\xe4\xb8\xaa\xe4\xba\xa4\xe7\x82\xb9\xef\xbc\x8c\xe5\xb9\xb6\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    if (t1 > ERR) t = t1;\n    else if (t2 > ERR) t = t2;\n    else return false;\n\n    //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n    if (t >= hit.distance - ERR) return false;\n\n    hit.distance = t;\n    hit.hitPoint = r.startPoint + r.direction * t;\n    hit.normal = normalize(hit.hitPoint - sphere.center);\n    hit.viewDir = r.direction;\n    return true;\n}\n\n//\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe5\x88\xb0\xe7\x90\x83\xe9\x9d\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 sphereTexCoord(vec3 N) {\n    float ang_x = atan(N.z, N.x);\n    float ang_y = asin(N.y);\n    vec2 uv = vec2(ang_x, ang_y);\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = 0.5 + ang_y / PI;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitSphereModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitSphere(r, spheres[i].sph, hit);\n    if (ret) {\n        hit.material = materials[spheres[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && spheres[i].useTexture) {\n            vec2 texc = sphereTexCoord(hit.normal);\n            //\xe7\xbb\x8f\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x91\xa8\xe9\x95\xbf\xef\xbc\x8c\xe7\xba\xac\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x8d\x8a\xe5\x91\xa8\xe9\x95\xbf\n            float size = sqrt(2.0) * PI * spheres[i].sph.radius;\n            vec3 color = sampleTexture(spheres[i].layer, spheres[i].uvTransform, texc, size, hit);\n            hit.material.color = color;\n        }\n        //\xe6\x8a\x98\xe5\xb0\x84\xe7\x8e\x87\xef\xbc\x9a\xe5\xb0\x84\xe5\x87\xba\xe6\x97\xb6\xe9\x9c\x80\xe8\xa6\x81\xe5\x8f\x96\xe5\x80\x92\xe6\x95\xb0\n        float ref_ang = hit.material.refractIndex;\n        if (ref_ang != 0 && dot(hit.normal, r.direction) > 0) {\n            hit.material.refractIndex = 1.0 / ref_ang;\n            hit.normal = -hit.normal;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nbool hitCylinder(Ray r, in Cylinder cyl, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe6\x9c\x80\xe7\x9f\xad\xe8\xb7\x9d\xe7\xa6\xbb\n    vec2 SF = cyl.center.xz - r.startPoint.xz;\n    vec2 d_ST = r.direction.xz;\n    float l_FT = abs(SF.y * d_ST.x - SF.x * d_ST.y) / length(d_ST);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_FT > cyl.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9a\x84\xe4\xba\xa4\xe7\x82\xb9\n    float l_SF = length(SF);\n    float t = sqrt(l_SF * l_SF - l_FT * l_FT) / length(d_ST);\n    float right = cyl.radius * cyl.radius - l_FT * l_FT;\n    float left = 1.0 - r.direction.y * r.direction.y;\n    float delta = sqrt(right / left);\n    float t1 = t - delta;\n    float t2 = t + delta;\n    vec3 M = r.startPoint + r.direction * t1;\n    vec3 N = r.startPoint + r.direction * t2;\n\n    //\xe4\xba\xa4\xe7\x82\xb9\xe6\x96\xb9\xe5\x90\x91\xe7\x9b\xb8\xe5\x8f\x8d\n    if (t2 <= ERR) return false;\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8M\n    if (M.y >= cyl.center.y && M.y <= cyl.center.y + cyl.height) {\n        if (t1 <= ERR) return false; //\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\n        if (t1 >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        vec2 nor = normalize(M.xz - cyl.center.xz);\n        hit.distance = t1;\n        hit.hitPoint = M;\n        hit.normal = vec3(nor.x, 0.0, nor.y);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8b\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y < cyl.center.y && N.y >= cyl.center.y) {\n        float m = (cyl.center.y - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, -1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8a\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y > cyl.center.y + cyl.height && N.y <= cyl.center.y + cyl.height) {\n        float m = (cyl.center.y + cyl.height - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, 1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xbe\xa7\xe9\x9d\xa2\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\nvec2 cylinderTexCoord(vec3 P, vec3 center, float height) {\n    float ang_x = atan(P.z - center.z, P.x - center.x);\n    vec2 uv;\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = (P.y - center.y) / height;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCylinderModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitCylinder(r, cylinders[i].cyl, hit);\n    if (ret) {\n        hit.material = materials[cylinders[i].material];\n        hit.material.refractRate = 0.0; //\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n        float y = hit.hitPoint.y;\n        float y_l = cylinders[i].cyl.center.y;\n        float y_h = y_l + cylinders[i].cyl.height;\n        //\xe5\x8f\xaa\xe6\x9c\x89\xe4\xbe\xa7\xe9\x9d\xa2\xe6\x9c\x89\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && cylinders[i].useTexture && y > y_l && y < y_h) {\n            vec2 tex = cylinderTexCoord(hit.hitPoint, cylinders[i].cyl.center, cylinders[i].cyl.height);\n            float size = sqrt(2.0 * PI * cylinders[i].cyl.radius * cylinders[i].cyl.height);\n            vec3 color = sampleTexture(cylinders[i].layer, cylinders[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe7\xbc\x96\xe5\x8f\xb7\nQuad getPatch(in CustomizedModel model, int i) {\n    int offset = (model.patchOffset + i) * 5;\n    Quad q;\n\n    q.samples[0] = texelFetch(patchTex, offset).xyz;\n    q.samples[1] = texelFetch(patchTex, offset + 1).xyz;\n    q.samples[2] = texelFetch(patchTex, offset + 2).xyz;\n    q.samples[3] = texelFetch(patchTex, offset + 3).xyz;\n    q.normal = texelFetch(patchTex, offset + 4).xyz;\n\n    return q;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe7\xbb\x93\xe7\x82\xb9\xe7\xbc\x96\xe5\x8f\xb7\nBVHNode getBVH(in CustomizedModel model, int i) {\n    int offset = (model.nodeOffset + i) * 4;\n    BVHNode n;\n\n    n.AA = texelFetch(bvhTex, offset).xyz;\n    n.BB = texelFetch(bvhTex, offset + 1).xyz;\n    ivec3 tmp = ivec3(texelFetch(bvhTex, offset + 2).xyz);\n    n.l = tmp.x;\n    n.r = tmp.y;\n    tmp = ivec3(texelFetch(bvhTex, offset + 3).xyz);\n    n.n = tmp.x;\n    n.index = tmp.y;\n\n    return n;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad`AABB`\xe5\x8c\x85\xe5\x9b\xb4\xe7\x9b\x92\nfloat hitAABB(Ray r, vec3 AA, vec3 BB) {\n    vec3 M = (BB - r.startPoint) / r.direction;\n    vec3 N = (AA - r.startPoint) / r.direction;\n\n    vec3 tmax = max(M, N);\n    vec3 tmin = min(M, N);\n\n    float t1 = min(tmax.x, min(tmax.y, tmax.z));\n    float t2 = max(tmin.x, max(tmin.y, tmin.z));\n\n    return t1 >= t2 && t2 > ERR ? t2 : -1.0;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCustomizedModel(Ray r, in CustomizedModel model, inout HitInfo hit) {\n    int stack[8];\n    int p = 0;\n\n    stack[p++] = 0;\n    while (p > 0) {\n        int top = stack[--p];\n        BVHNode node = getBVH(model, top);\n\n        //\xe5\x8f\xb6\xe5\xad\x90\xe7\xbb\x93\xe7\x82\xb9\n        if (node.n > 0) {\n            int m = node.index;\n            int n = m + node.n;\n            for (int i = m; i < n; i++) {\n                Quad q = getPatch(model, i);\n                if (hitQuad(r, q, hit)) {\n                    hit.material = materials[model.material];\n                    hit.material.refractRate = 0.0; //\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n                    //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n                    if (USE_TEXTURE && model.useTexture) {\n                        vec2 tex = cylinderTexCoord(hit.hitPoint, model.center, model.height);\n                        //\xe6\x8c\x89\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\xe8\xae\xa1\xe7\xae\x97\xe5\x91\xa8\xe9\x95\xbf\n                        float radius = max(length(hit.hitPoint.xz - model.center.xz), ERR);\n                        float size = sqrt(2.0 * PI * radius * model.height);\n                        vec3 color = sampleTexture(model.layer, model.uvTransform, tex, size, hit);\n                        hit.material.color = color;\n                    }\n                    return true;\n                }\n            }\n        }\n\n        //\xe4\xb8\x8e\xe5\xb7\xa6\xe5\x8f\xb3\xe7\x9b\x92\xe5\xad\x90\xe6\xb1\x82\xe4\xba\xa4\n        float t1 = -1.0, t2 = -1.0;\n        if (node.l >= 0) {\n            BVHNode l_node = getBVH(model, node.l);\n            t1 = hitAABB(r, l_node.AA, l_node.BB);\n        }\n        if (node.r >= 0) {\n            BVHNode r_node = getBVH(model, node.r);\n            t2 = hitAABB(r, r_node.AA, r_node.BB);\n        }\n\n        //\xe5\x9c\xa8\xe6\x9c\x80\xe8\xbf\x91\xe7\x9a\x84\xe7\x9b\x92\xe5\xad\x90\xe4\xb8\xad\xe6\x90\x9c\xe7\xb4\xa2\n        if (t1 > 0 && t2 > 0) {\n            if (t1 < t2) {\n                stack[p++] = node.r;\n                stack[p++] = node.l;\n            } else {\n                stack[p++] = node.l;\n                stack[p++] = node.r;\n            }\n        } else if (t1 > 0) {\n            stack[p++] = node.l;\n        } else if (t2 > 0) {\n            stack[p++] = node.r;\n        }\n    }\n\n    return false;\n}\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe5\x88\xa4\xe6\x96\xad\nbool hitModel(Ray r, out HitInfo hit) {\n    hit.distance = INF;\n    bool ret = false;\n\n    for (int i = 0; i < cylinderNum; i++) {\n        ret = hitCylinderModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < quadNum; i++) {\n        ret = hitQuadModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < sphereNum; i++) {\n        ret = hitSphereModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < customizedNum; i++) {\n        ret = hitCustomizedModel(r, customized[i], hit) || ret;\n    }\n\n    return ret;\n}\n\n/*****************************************************\n * \xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x8d\x95\xe6\xad\xa5\xe6\x93\x8d\xe4\xbd\x9c\xef\xbc\x9a\xe7\x89\x87\xe5\x85\x83\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe4\xb8\x8e\xe6\xb3\xa2\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\x85\xb1\xe7\x94\xa8\n *****************************************************/\n\n//\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\xad\xe5\xbf\x83\xe4\xbd\x8d\xe4\xba\x8eposition\xe7\x9a\x84\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x9a\xe8\xa7\x86\xe7\x82\xb9\xe6\x8c\x87\xe5\x90\x91\xe5\x83\x8f\xe7\xb4\xa0\xe7\x82\xb9\xef\xbc\x8c\xe5\x8a\xa0\xe5\x85\xa5\xe9\x9a\x8f\xe6\x9c\xba\xe5\x81\x8f\xe7\xa7\xbb\xe9\x87\x8f\xe4\xbb\xa5\xe6\x8a\x97\xe9\x94\xaf\xe9\xbd\xbf\xef\xbc\x8c\xe5\xb9\xb6\xe5\x88\x9d\xe5\xa7\x8b\xe5\x8c\x96\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\nRay cameraRay(vec3 position) {\n    Ray r;\n    r.startPoint = eyePos;\n    vec3 screen = position;\n    float d = rand(), th = rand() * (2.0 * PI);\n    screen.x += (d * sin(th) - 0.5) * (2.0 / width);\n    screen.y += (d * cos(th) - 0.5) * (2.0 / height);\n    r.direction = normalize(screen - eyePos);\n\n    //\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\x9c\xa8\xe5\xb1\x8f\xe5\xb9\x95\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\xba\xe4\xb8\x80\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\n    coneWidth = 0.0;\n    coneSpread = 2.0 / (height * length(screen - eyePos));\n    return r;\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xae\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe6\x9d\x90\xe8\xb4\xa8\xe7\x94\x9f\xe6\x88\x90\xe7\xac\xac""depth\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe8\xbf\x94\xe5\x9b\x9e\xe5\x85\x89\xe7\xba\xbf\xe7\xb1\xbb\xe5\x9e\x8b\xef\xbc\x88""0\xe4\xb8\xba\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""1\xe4\xb8\xba\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""2\xe4\xb8\xba\xe6\x8a\x98\xe5\xb0\x84\xef\xbc\x89\xe4\xb8\x8e\xe6\xb7\xb7\xe5\x90\x88\xe6\x8c\x87\xe6\x95\xb0\nint scatter(inout Ray r, in HitInfo hit, int depth, out float tint) {\n    //\xe9\x9a\x8f\xe6\x9c\xba\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\n    vec3 oldRay = r.direction;\n    r.direction = depth == 0 ? sampleSobolHemisphere(hit.normal) : sampleHemisphere(hit.normal);\n//    r.direction = sampleHemisphere(hit.normal);\n    r.startPoint = hit.hitPoint;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe7\x89\xa9\xe4\xbd\x93\xe6\x9d\x90\xe8\xb4\xa8\xe5\x86\xb3\xe5\xae\x9a\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    float p = rand();\n    tint = 0.0;\n    if (p < hit.material.specularRate) {\n        //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\n        vec3 ref = reflect(oldRay, hit.normal);\n        r.direction = normalize(mix(ref, r.direction, hit.material.specularRoughness));\n        tint = hit.material.specularTint;\n        coneSpread += hit.material.specularRoughness * CONE_ROUGH_SPREAD;\n        return 1;\n    } else if (USE_REFRACT && hit.material.specularRate <= p && p <= hit.material.specularRate + hit.material.refractRate) {\n        //\xe6\x8a\x98\xe5\xb0\x84\n        vec3 ref = refract(oldRay, hit.normal, 1.0 / hit.material.refractIndex);\n        r.direction = normalize(mix(ref, -r.direction, hit.material.refractRoughness));\n        tint = hit.material.refractTint;\n        coneSpread += hit.material.refractRoughness * CONE_ROUGH_SPREAD;\n        return 2;\n    }\n    //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\n    coneSpread += CONE_DIFFUSE_SPREAD;\n    return 0;\n}\n\n//\xe6\x9c\xac\xe5\xb1\x82\xe5\xaf\xb9\xe4\xb8\x8b\xe4\xb8\x80\xe5\xb1\x82\xe9\xa2\x9c\xe8\x89\xb2\xe7\x9a\x84\xe7\xba\xbf\xe6\x80\xa7\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9a\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe9\x80\x90\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x98\xe4\xbb\xa5\xe9\xa2\x9c\xe8\x89\xb2\xef\xbc\x9b\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x9c\xa8\xe9\xa2\x9c\xe8\x89\xb2\xe4\xb9\x98\xe4\xbb\xa5\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe4\xb8\x8e\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe4\xb9\x8b\xe9\x97\xb4\xe6\x8c\x89tint\xe6\x8f\x92\xe5\x80\xbc\xef\xbc\x8c\n//\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe5\x8f\x96\xe5\x90\x84\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x8b\xe5\x92\x8c\xe9\x99\xa4\xe4\xbb\xa5sqrt(3)\xef\xbc\x8c\xe5\xaf\xb9\xe7\x99\xbd\xe5\x85\x89\xe4\xb8\x8e\xe5\x90\x91\xe9\x87\x8f\xe9\x95\xbf\xe5\xba\xa6\xe7\x9b\xb8\xe5\x90\x8c\xef\xbc\x8c\xe4\xbd\xbf\xe5\x8f\x98\xe6\x8d\xa2\xe4\xbf\x9d\xe6\x8c\x81\xe7\xba\xbf\xe6\x80\xa7\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x8f\xaf\xe6\xb2\xbf\xe8\xb7\xaf\xe5\xbe\x84\xe5\x90\x91\xe5\x89\x8d\xe7\xb4\xaf\xe4\xb9\x98\nmat3 transfer(vec3 color, float cosine, int type, float tint) {\n    float s = sqrt(cosine);\n    if (type == 0) return mat3(color.r * s, 0.0, 0.0, 0.0, color.g * s, 0.0, 0.0, 0.0, color.b * s);\n    return s * (outerProduct(color, vec3((1.0 - tint) / sqrt(3.0))) + mat3(tint));\n}\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe7\x9a\x84\xe4\xb8\x80\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xef\xbc\x9a\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe6\x97\xb6\xe5\xb0\x86\xe5\x85\xb6\xe8\xbe\x90\xe5\xb0\x84\xe4\xba\xae\xe5\xba\xa6\xe7\xbb\x8f\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe7\xb4\xaf\xe5\x8a\xa0\xe5\x88\xb0radiance\xe5\xb9\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\xef\xbc\x8c\xe5\x90\xa6\xe5\x88\x99\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\xb9\xb6\xe6\x9b\xb4\xe6\x96\xb0\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xef\xbc\x8c\n//\xe8\xa2\xab\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe6\x97\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\nbool bounce(inout Ray r, in HitInfo hit, int depth, inout mat3 throughput, inout vec3 radiance) {\n    //\xe5\x8f\x8d\xe4\xbc\xbd\xe9\xa9\xac\xe6\xa0\xa1\xe6\xad\xa3\n    vec3 color = pow(hit.material.color, vec3(2.2));\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe4\xbc\xa0\xe6\x92\xad\xe5\x88\xb0\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\n    coneWidth += coneSpread * hit.distance;\n\n    if (hit.material.lighting) {\n        radiance += throughput * (color * 2.0);\n        return false;\n    }\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe5\xa4\xb9\xe8\xa7\x92\xe4\xbd\x99\xe5\xbc\xa6\xef\xbc\x8c\xe5\x9c\xa8\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\n    float cosine = abs(dot(hit.normal, r.direction));\n    float tint;\n    int type = scatter(r, hit, depth, tint);\n    throughput *= transfer(color, cosine, type, tint);\n\n    //\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xef\xbc\x9a\xe6\x8c\x89\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x86\xb3\xe5\xae\x9a\xe8\xb7\xaf\xe5\xbe\x84\xe6\x98\xaf\xe5\x90\xa6\xe7\xbb\xa7\xe7\xbb\xad\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe8\xb6\x8a\xe5\xb0\x8f\xe8\xb6\x8a\xe5\x8f\xaf\xe8\x83\xbd\xe7\xbb\x93\xe6\x9d\x9f\xef\xbc\x9b\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe9\x99\xa4\xe4\xbb\xa5\xe5\xad\x98\xe6\xb4\xbb\xe6\xa6\x82\xe7\x8e\x87\xef\xbc\x8c\xe6\x9c\x9f\xe6\x9c\x9b\xe4\xb8\x8d\xe5\x8f\x98\n    if (depth + 1 >= rouletteDepth) {\n        vec3 response = throughput * vec3(1.0);\n        float survive = min(max(response.r, max(response.g, response.b)), 1.0);\n        if (rand() >= survive) return false;\n        throughput /= survive;\n    }\n    return true;\n}\n\nin vec3 position;\nlayout (location = 0) out vec3 FragData;\n\n//\xe6\x9c\xac\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe4\xb8\xad\xe6\xaf\x8f\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\xe7\x9a\x84\xe6\xa0\xb7\xe6\x9c\xac\xe6\x95\xb0\nuniform int samples;\n\n//\xe4\xb9\x8b\xe5\x89\x8d\xe7\xb4\xaf\xe7\xa7\xaf\xe7\x9a\x84\xe7\xbb\x93\xe6\x9e\x9c\xef\xbc\x9a\xe5\x8f\xaa\xe5\x9c\xa8\xe4\xba\xa4\xe6\x9b\xbf\xe4\xbd\xbf\xe7\x94\xa8\xe4\xb8\xa4\xe4\xb8\xaa\xe7\xbc\x93\xe5\x86\xb2\xe7\xb4\xaf\xe7\xa7\xaf\xe6\x97\xb6\xe8\xaf\xbb\xe5\x8f\x96\xef\xbc\x8c\xe5\x8a\xa0\xe6\xb3\x95\xe6\xb7\xb7\xe5\x90\x88\xe7\xb4\xaf\xe7\xa7\xaf\xe6\x97\xb6\xe7\x94\xb1\xe6\xb7\xb7\xe5\x90\x88\xe5\xae\x8c\xe6\x88\x90\nuniform sampler2D lastFrame;\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xef\xbc\x9a\xe6\xb2\xbf\xe8\xb7\xaf\xe5\xbe\x84\xe5\x90\x91\xe5\x89\x8d\xe7\xb4\xaf\xe4\xb9\x98\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xef\xbc\x8c\xe5\x8d\x95\xe6\xac\xa1\xe9\x81\x8d\xe5\x8e\x86\xef\xbc\x8c\xe4\xb8\x8d\xe4\xbf\x9d\xe5\xad\x98\xe6\xaf\x8f\xe4\xb8\x80\xe5\xb1\x82\xe7\x9a\x84\xe4\xbf\xa1\xe6\x81\xaf\nvec3 pathTracing(Ray r) {\n    mat3 throughput = mat3(1.0);\n    vec3 radiance = vec3(0.0);\n    for (int depth = 0; depth < maxDepth; depth++) {\n        //\xe6\x9c\xaa\xe5\x87\xbb\xe4\xb8\xad\xe6\x88\x96\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe6\x97\xb6\xe7\xbb\x93\xe6\x9d\x9f\n        HitInfo hit;\n        if (!hitModel(r, hit) || !bounce(r, hit, depth, throughput, radiance)) break;\n    }\n    return radiance;\n}\n\nvoid main() {\n    //\xe4\xb8\x80\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe8\xbf\xbd\xe8\xb8\xaa\xe5\xa4\x9a\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xef\xbc\x8c\xe5\x88\x86\xe6\x91\x8a\xe8\xaf\xbb\xe5\x86\x99\xe5\xb8\xa7\xe7\xbc\x93\xe5\xad\x98\xe7\xad\x89\xe6\xaf\x8f\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe7\x9a\x84\xe5\xbc\x80\xe9\x94\x80\n    uvec2 coord = uvec2((position.xy * 0.5 + 0.5) * vec2(width, height));\n    vec3 color = vec3(0.0);\n    for (int i = 0; i < samples; i++) {\n        beginSample(coord, frame + i);\n        Ray r = cameraRay(position);\n        color += pathTracing(r);\n    }\n\n    //\xe6\x9c\xac\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe7\x9a\x84\xe6\xa0\xb7\xe6\x9c\xac\xe4\xb9\x8b\xe5\x92\x8c\xe5\x8a\xa0\xe4\xb8\x8a\xe4\xb9\x8b\xe5\x89\x8d\xe7\xb4\xaf\xe7\xa7\xaf\xe7\x9a\x84\xe9\xa2\x9c\xe8\x89\xb2\n    FragData = color * (2.0 * PI);\n    if (!ACCUMULATE_BLEND) FragData += texelFetch(lastFrame, ivec2(gl_FragCoord.xy), 0).xyz;\n}\n"
+
+#define preview_frag "#version 450 core\n\n//\xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x85\xac\xe5\x85\xb1\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe5\x9c\xba\xe6\x99\xaf\xe6\x8f\x8f\xe8\xbf\xb0\xe3\x80\x81\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xe3\x80\x81\xe9\x87\x87\xe6\xa0\xb7\xe4\xb8\x8e\xe6\xb1\x82\xe4\xba\xa4\xef\xbc\x8c\xe7\x94\xb1tracer.frag\xe4\xb8\x8ewavefront.comp\xe5\x8c\x85\xe5\x90\xab\n//\xe5\x8c\x85\xe5\x90\xab\xe5\x89\x8d\xe9\xa1\xbb\xe5\xb7\xb2\xe5\xa3\xb0\xe6\x98\x8e#version\n\n#define PI 3.1415926\n#define INF 114514.0\n#define ERR 0.0001\n#define CONE_DIFFUSE_SPREAD 0.1 //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe5\x90\x8e\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\n#define CONE_ROUGH_SPREAD 0.5   //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x90\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\xe4\xb8\x8e\xe6\xa8\xa1\xe7\xb3\x8a\xe5\xba\xa6\xe4\xb9\x8b\xe6\xaf\x94\n\n//\xe5\xb1\x8f\xe5\xb9\x95\xe5\x8f\x82\xe6\x95\xb0\nuniform int width;\nuniform int height;\n\n//\xe5\xb8\xa7\xe6\x95\xb0\xef\xbc\x9a\xe5\xb7\xb2\xe7\xb4\xaf\xe7\xa7\xaf\xe7\x9a\x84\xe6\xa0\xb7\xe6\x9c\xac\xe6\x95\xb0\xef\xbc\x8c\xe4\xb9\x9f\xe6\x98\xaf\xe6\x9c\xac\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe4\xb8\xad\xe9\xa6\x96\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe5\xba\x8f\xe5\x8f\xb7\nuniform int frame;\nuniform int maxFrame;\n\n//\xe8\xa7\x86\xe7\x82\xb9\nuniform vec3 eyePos;\n\n//\xe6\x9c\x80\xe5\xa4\xa7\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xef\xbc\x9a\xe8\xbf\x90\xe8\xa1\x8c\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\xef\xbc\x8c\xe4\xb8\x8d\xe9\x99\x90\xe5\x88\xb6\xe4\xb8\x8a\xe9\x99\x90\nuniform int maxDepth;\n//\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xe8\xbe\xbe\xe5\x88\xb0\xe5\x90\x8e\xe5\xbc\x80\xe5\xa7\x8b\xe4\xbb\xa5\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe8\xb7\xaf\xe5\xbe\x84\nuniform int rouletteDepth;\n\n//\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x85\xb1\xe7\x94\xa8\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\nuniform sampler2DArray textures;\n\n//\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\xef\xbc\x9a\xe5\x8f\x82\xe8\x80\x83material.h\nstruct Material {\n    vec3 color;\n    float specularRate;\n    float specularTint;\n    float specularRoughness;\n    float refractRate;\n    float refractTint;\n    float refractIndex;\n    float refractRoughness;\n    bool lighting;\n};\n\n//`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\nstruct BVHNode {\n    vec3 AA;\n    vec3 BB;\n    int l;\n    int r;\n    int n;\n    int index;\n};\n\n/*****************************************************\n * \xe6\xa8\xa1\xe5\x9e\x8b\xe5\xae\x9a\xe4\xb9\x89\xef\xbc\x9a\xe4\xbb\xa5std430\xe5\xb8\x83\xe5\xb1\x80\xe5\xad\x98\xe6\x94\xbe\xe5\x9c\xa8\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\xad\x98\xe5\x82\xa8\xe7\xbc\x93\xe5\x86\xb2\xe4\xb8\xad\xef\xbc\x8c\xe5\x8f\x82\xe8\x80\x83scenebuffer.h\n *****************************************************/\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nstruct Quad {\n    vec3 samples[4];\n    vec3 normal;\n};\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nstruct QuadModel {\n    Quad quad;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\nstruct Sphere {\n    vec3 center;\n    float radius;\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct SphereModel {\n    Sphere sph;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nstruct Cylinder {\n    vec3 center;\n    float radius;\n    float height;\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct CylinderModel {\n    Cylinder cyl;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xef\xbc\x9a\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe5\x90\x88\xe5\xb9\xb6\xe5\xad\x98\xe6\x94\xbe\xef\xbc\x8c\xe5\x90\x84\xe6\xa8\xa1\xe5\x9e\x8b\xe8\xae\xb0\xe5\xbd\x95\xe8\x87\xaa\xe5\xb7\xb1\xe7\x9a\x84\xe8\xb5\xb7\xe5\xa7\x8b\xe4\xb8\x8b\xe6\xa0\x87\nstruct CustomizedModel {\n    vec3 center;\n    float height;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    int nodeOffset;     //BVH\xe6\xa0\x91\xe6\xa0\xb9\xe7\xbb\x93\xe7\x82\xb9\xe5\x9c\xa8\xe7\xbb\x93\xe7\x82\xb9\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    int patchOffset;    //\xe9\xa6\x96\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe5\x9c\xa8\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n/*****************************************************/\n\n//\xe5\x85\x89\xe7\xba\xbf\nstruct Ray {\n    vec3 startPoint;\n    vec3 direction;\n};\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe4\xbf\xa1\xe6\x81\xaf\nstruct HitInfo {\n    float distance;         // \xe4\xb8\x8e\xe4\xba\xa4\xe7\x82\xb9\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\n    vec3 hitPoint;          // \xe5\x85\x89\xe7\xba\xbf\xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\n    vec3 normal;            // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\xba\xbf\n    vec3 viewDir;           // \xe5\x87\xbb\xe4\xb8\xad\xe8\xaf\xa5\xe7\x82\xb9\xe7\x9a\x84\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    Material material;      // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\n};\n\n//\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\xbd\x93\xe5\x89\x8d\xe5\x85\x89\xe7\xba\xbf\xe8\xb5\xb7\xe7\x82\xb9\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xef\xbc\x8c\xe7\x94\xa8\xe4\xba\x8e\xe9\x80\x89\xe6\x8b\xa9\xe7\xba\xb9\xe7\x90\x86\xe7\x9a\x84mipmap\xe5\xb1\x82\xe7\xba\xa7\nfloat coneWidth = 0.0;\nfloat coneSpread = 0.0;\n\n//\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbf\xa1\xe6\x81\xaf\xef\xbc\x9a\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe5\x8f\xaa\xe5\x8f\x97\xe7\xbc\x93\xe5\x86\xb2\xe5\xa4\xa7\xe5\xb0\x8f\xe9\x99\x90\xe5\x88\xb6\n//\xe5\x9c\xba\xe6\x99\xaf\xe7\x89\xb9\xe5\x8c\x96\xe7\x9a\x84\xe5\x8f\x98\xe4\xbd\x93\xe7\x94\xb1Scene\xe6\xb3\xa8\xe5\x85\xa5SPECIALIZED\xe5\x8f\x8a\xe4\xb8\x8b\xe5\x88\x97\xe5\xae\x8f\xef\xbc\x8c\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe6\x88\x90\xe4\xb8\xba\xe5\xb8\xb8\xe9\x87\x8f\xef\xbc\x8c\xe5\xbe\xaa\xe7\x8e\xaf\xe5\x8f\xaf\xe5\xb1\x95\xe5\xbc\x80\xef\xbc\x8c\xe6\x9c\xaa\xe7\x94\xa8\xe5\x88\xb0\xe7\x9a\x84\xe5\x88\x86\xe6\x94\xaf\xe5\x8f\xaf\xe6\xb6\x88\xe9\x99\xa4\n#ifdef SPECIALIZED\nconst int quadNum = QUAD_NUM;\nconst int sphereNum = SPHERE_NUM;\nconst int cylinderNum = CYLINDER_NUM;\nconst int customizedNum = CUSTOMIZED_NUM;\n#else\nuniform int quadNum;\nuniform int sphereNum;\nuniform int cylinderNum;\nuniform int customizedNum;\n#define USE_TEXTURE true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbd\xbf\xe7\x94\xa8\xe7\xba\xb9\xe7\x90\x86\n#define USE_REFRACT true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n#define ACCUMULATE_BLEND false //\xe7\xb4\xaf\xe7\xa7\xaf\xe6\x96\xb9\xe5\xbc\x8f\xef\xbc\x9a\xe5\x8a\xa0\xe6\xb3\x95\xe6\xb7\xb7\xe5\x90\x88\xef\xbc\x8c\xe6\x88\x96\xe8\xaf\xbb\xe5\x8f\x96\xe4\xb9\x8b\xe5\x89\x8d\xe7\x9a\x84\xe7\xbb\x93\xe6\x9e\x9c\xe5\x90\x8e\xe5\x86\x99\xe5\x85\xa5\xe5\x8f\xa6\xe4\xb8\x80\xe4\xb8\xaa\xe7\xbc\x93\xe5\x86\xb2\n#endif\n\nlayout (std430, binding = 0) readonly buffer MaterialBuffer {\n    Material materials[];\n};\nlayout (std430, binding = 1) readonly buffer QuadBuffer {\n    QuadModel quads[];\n};\nlayout (std430, binding = 2) readonly buffer SphereBuffer {\n    SphereModel spheres[];\n};\nlayout (std430, binding = 3) readonly buffer CylinderBuffer {\n    CylinderModel cylinders[];\n};\nlayout (std430, binding = 4) readonly buffer CustomizedBuffer {\n    CustomizedModel customized[];\n};\n\n//\xe6\x89\x80\xe6\x9c\x89\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x90\x88\xe5\xb9\xb6\xe5\x90\x8e\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe9\xa1\xb6\xe7\x82\xb9\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xef\xbc\x89\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe7\xbb\x93\xe7\x82\xb9\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe7\xbb\x93\xe7\x82\xb9\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe4\xb8\x89\xe7\xbb\xb4\xe5\x90\x91\xe9\x87\x8f\xef\xbc\x89\nuniform samplerBuffer patchTex;\nuniform samplerBuffer bvhTex;\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xef\xbc\x9a\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90+\xe5\x93\x88\xe5\xb8\x8c\n *****************************************************/\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe5\xbc\x80\xe5\xa7\x8b\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\nuint seed = 0u;\n\n//\xe5\x93\x88\xe5\xb8\x8c\xe5\x87\xbd\xe6\x95\xb0\nuint hash(inout uint seed) {\n    seed *= 0x27d4eb2du;\n    seed = seed ^ (seed >> 15);\n    return seed;\n}\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\nfloat rand() {\n    return float(hash(seed)) / 4294967296.0;\n}\n\n/*****************************************************\n * sobol\xe5\xba\x8f\xe5\x88\x97\n *****************************************************/\n\nuniform uint V[64];\n\n//\xe4\xbb\x85\xe4\xb8\x8e\xe5\x83\x8f\xe7\xb4\xa0\xe5\x9d\x90\xe6\xa0\x87\xe6\x9c\x89\xe5\x85\xb3\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\nuint pseed = 0u;\n\n//\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nint gray = 0;\n\n//\xe8\xae\xbe\xe7\xbd\xae\xe5\x83\x8f\xe7\xb4\xa0""coord\xe5\xa4\x84\xe7\xac\xaci\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xe4\xb8\x8e\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nvoid beginSample(uvec2 coord, int i) {\n    uint pixel = coord.x * 1973u + coord.y * 9277u;\n    seed = pixel + uint(i * maxFrame) * 26699u;\n    pseed = pixel + 512u * 26699u;\n    gray = i ^ (i >> 1);\n}\n\n//\xe7\x94\x9f\xe6\x88\x90`sobol`\xe6\x95\xb0\nfloat sobol(int d, int i) {\n    uint result = 0u;\n    int offset = d * 32;\n    for (int j = 0, k = i; k != 0; k >>= 1, j++) {\n        if ((k & 1) == 1) {\n            result ^= V[j + offset];\n        }\n    }\n    return float(result) / 4294967296.0;\n}\n\nfloat CranleyPattersonRotation(float p) {\n    float u = float(hash(pseed)) / 4294967296.0;\n    p += u;\n    if(p > 1.0) p -= 1.0;\n    if(p < 0.0) p += 1.0;\n    return p;\n}\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe5\x90\x91\xe9\x87\x8f\n *****************************************************/\n\n//\xe5\xb0\x86\xe5\x90\x91\xe9\x87\x8fv\xe6\x8a\x95\xe5\xbd\xb1\xe5\x88\xb0N\xe7\x9a\x84\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\nvec3 toNormalHemisphere(vec3 v, vec3 N) {\n    vec3 helper = vec3(1.0, 0.0, 0.0);\n    if(abs(N.x) >= 1.0 - ERR) helper = vec3(0.0, 0.0, 1.0);\n    vec3 tangent = normalize(cross(N, helper));\n    vec3 bitangent = normalize(cross(N, tangent));\n    return v.x * tangent + v.y * bitangent + v.z * N;\n}\n\n//\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\xe9\x9a\x8f\xe6\x9c\xba\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleHemisphere(vec3 N) {\n    float r = sqrt(rand());\n    float t = rand() * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xaesobol\xe5\xba\x8f\xe5\x88\x97\xe7\x9a\x84\xe5\x9d\x87\xe5\x8c\x80\xe5\x8d\x8a\xe7\x90\x83\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleSobolHemisphere(vec3 N) {\n    float u = CranleyPattersonRotation(sobol(0, gray));\n    float v = CranleyPattersonRotation(sobol(1, gray));\n//    float u = sobol(0, gray);\n//    float v = sobol(1, gray);\n    float r = sqrt(u);\n    float t = v * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n/*****************************************************\n * \xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\n *****************************************************/\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 quadTexCoord(in vec3 samples[4], vec3 P) {\n    vec3 m = samples[2] - samples[0];\n    vec3 n = samples[0] - samples[1];\n    vec3 q = P - samples[1];\n    if (m.x == 0.0 && n.x == 0.0 && q.x == 0) {\n        mat2 mn = mat2(m.yz, n.yz);\n        return inverse(mn) * q.yz;\n    }\n    if (m.y == 0.0 && n.y == 0.0 && q.y == 0.0) {\n        mat2 mn = mat2(m.xz, n.xz);\n        return inverse(mn) * q.xz;\n    }\n    mat2 mn = mat2(m.xy, n.xy);\n    return inverse(mn) * q.xy;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nbool hitQuad(Ray r, in Quad quad, inout HitInfo hit) {\n    //\xe6\xb1\x82\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\xb9\xb3\xe9\x9d\xa2\xe4\xba\xa4\xe7\x82\xb9\n    vec3 n1 = quad.samples[1] - quad.samples[0];\n    vec3 n2 = quad.samples[2] - quad.samples[0];\n    vec3 normal = normalize(cross(n1, n2));\n    float d = -dot(quad.samples[0], normal);\n    float m = dot(r.direction, normal);\n    if (m >= -ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe8\x83\x8c\xe5\x90\x91\xe9\x9d\xa2\n    float t = -(d + dot(r.startPoint, normal)) / m;\n    if (t <= ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    vec3 P = r.startPoint + r.direction * t;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe5\x8f\x89\xe4\xb9\x98\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\xe5\x85\xb3\xe7\xb3\xbb\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x90\xa6\xe5\x9c\xa8\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe5\x86\x85\n    vec3 n3 = P - quad.samples[0];\n    vec3 n4 = P - quad.samples[1];\n    vec3 n5 = P - quad.samples[2];\n    float f1 = dot(cross(n1, n3), normal);\n    float f2 = dot(cross(n3, n2), normal);\n    float f3 = dot(cross(n5, n1), normal);\n    float f4 = dot(cross(n2, n4), normal);\n\n    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {\n        hit.distance = t;\n        hit.hitPoint = P;\n        hit.viewDir = r.direction;\n        hit.normal = normal;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe6\x8c\x89\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe5\x9c\xa8\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa6\x86\xe7\x9b\x96\xe8\x8c\x83\xe5\x9b\xb4\xe9\x80\x89\xe6\x8b\xa9mipmap\xe5\xb1\x82\xe7\xba\xa7\xe9\x87\x87\xe6\xa0\xb7\xe7\xba\xb9\xe7\x90\x86\xef\xbc\x8cworldSize\xe4\xb8\xba\xe5\x8d\x95\xe4\xbd\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\xaf\xb9\xe5\xba\x94\xe7\x9a\x84\xe4\xb8\x96\xe7\x95\x8c\xe7\xa9\xba\xe9\x97\xb4\xe9\x95\xbf\xe5\xba\xa6\nvec3 sampleTexture(int layer, vec4 uvTransform, vec2 uv, float worldSize, in HitInfo hit) {\n    float footprint = (coneWidth + coneSpread * hit.distance) / max(abs(dot(hit.normal, hit.viewDir)), 0.01);\n    vec2 arraySize = vec2(textureSize(textures, 0).xy);\n    vec2 size = arraySize * uvTransform.xy;\n    float lod = log2(footprint * sqrt(size.x * size.y) / worldSize);\n\n    //\xe7\xba\xb9\xe7\x90\x86\xe5\x8f\xaa\xe5\x8d\xa0\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x80\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe9\x87\x8d\xe5\xa4\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xef\xbc\x8c\xe5\xb9\xb6\xe5\x9c\xa8\xe6\x89\x80\xe7\x94\xa8\xe5\xb1\x82\xe7\xba\xa7\xe4\xb8\x8a\xe7\xa6\xbb\xe5\x8c\xba\xe5\x9f\x9f\xe8\xbe\xb9\xe7\x95\x8c\xe4\xbf\x9d\xe7\x95\x99\xe5\x8d\x8a\xe4\xb8\xaa\xe7\xba\xb9\xe7\xb4\xa0\xef\xbc\x8c\xe9\x81\xbf\xe5\x85\x8d\xe9\x87\x87\xe6\xa0\xb7\xe5\x88\xb0\xe5\x8c\xba\xe5\x9f\x9f\xe5\xa4\x96\n    int level = clamp(int(ceil(lod)), 0, textureQueryLevels(textures) - 1);\n    vec2 half_texel = 0.5 / vec2(textureSize(textures, level).xy);\n    vec2 st = clamp(fract(uv) * uvTransform.xy, half_texel, uvTransform.xy - half_texel) + uvTransform.zw;\n    return textureLod(textures, vec3(st, layer), lod).xyz;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitQuadModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitQuad(r, quads[i].quad, hit);\n    if (ret) {\n        hit.material = materials[quads[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && quads[i].useTexture) {\n            vec2 tex = quadTexCoord(quads[i].quad.samples, hit.hitPoint);\n            float size = sqrt(length(quads[i].quad.samples[2] - quads[i].quad.samples[0]) *\n                              length(quads[i].quad.samples[0] - quads[i].quad.samples[1]));\n            vec3 color = sampleTexture(quads[i].layer, quads[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\nbool hitSphere(Ray r, in Sphere sphere, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe7\x90\x83\xe5\xbf\x83\xe8\xb7\x9d\xe7\xa6\xbb\n    float t = dot(sphere.center - r.startPoint, r.direction);\n    vec3 T = r.startPoint + r.direction * t;\n    vec3 CP = T - sphere.center;\n    float l_CP = length(CP);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_CP > sphere.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xba\xa4\xe7\x82\xb9\n    float delta = sqrt(sphere.radius * sphere.radius - l_CP * l_CP);\n    float t1 = t - delta;\n    float t2 = t + delta;\n\n    //\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x93\xaa\xe4\xb8\xaa\xe4\xba\xa4\xe7\x82\xb9\xef\xbc\x8c\xe5\xb9\xb6\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    if (t1 > ERR) t = t1;\n    else if (t2 > ERR) t = t2;\n    else return false;\n\n    //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n    if (t >= hit.distance - ERR) return false;\n\n    hit.distance = t;\n    hit.hitPoint = r.startPoint + r.direction * t;\n    hit.normal = normalize(hit.hitPoint - sphere.center);\n    hit.viewDir = r.direction;\n    return true;\n}\n\n//\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe5\x88\xb0\xe7\x90\x83\xe9\x9d\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 sphereTexCoord(vec3 N) {\n    float ang_x = atan(N.z, N.x);\n    float ang_y = asin(N.y);\n    vec2 uv = vec2(ang_x, ang_y);\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = 0.5 + ang_y / PI;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitSphereModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitSphere(r, spheres[i].sph, hit);\n    if (ret) {\n        hit.material = materials[spheres[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && spheres[i].useTexture) {\n            vec2 texc = sphereTexCoord(hit.normal);\n            //\xe7\xbb\x8f\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x91\xa8\xe9\x95\xbf\xef\xbc\x8c\xe7\xba\xac\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x8d\x8a\xe5\x91\xa8\xe9\x95\xbf\n            float size = sqrt(2.0) * PI * spheres[i].sph.radius;\n            vec3 color = sampleTexture(spheres[i].layer, spheres[i].uvTransform, texc, size, hit);\n            hit.material.color = color;\n        }\n        //\xe6\x8a\x98\xe5\xb0\x84\xe7\x8e\x87\xef\xbc\x9a\xe5\xb0\x84\xe5\x87\xba\xe6\x97\xb6\xe9\x9c\x80\xe8\xa6\x81\xe5\x8f\x96\xe5\x80\x92\xe6\x95\xb0\n        float ref_ang = hit.material.refractIndex;\n        if (ref_ang != 0 && dot(hit.normal, r.direction) > 0) {\n            hit.material.refractIndex = 1.0 / ref_ang;\n            hit.normal = -hit.normal;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nbool hitCylinder(Ray r, in Cylinder cyl, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe6\x9c\x80\xe7\x9f\xad\xe8\xb7\x9d\xe7\xa6\xbb\n    vec2 SF = cyl.center.xz - r.startPoint.xz;\n    vec2 d_ST = r.direction.xz;\n    float l_FT = abs(SF.y * d_ST.x - SF.x * d_ST.y) / length(d_ST);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_FT > cyl.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9a\x84\xe4\xba\xa4\xe7\x82\xb9\n    float l_SF = length(SF);\n    float t = sqrt(l_SF * l_SF - l_FT * l_FT) / length(d_ST);\n    float right = cyl.radius * cyl.radius - l_FT * l_FT;\n    float left = 1.0 - r.direction.y * r.direction.y;\n    float delta = sqrt(right / left);\n    float t1 = t - delta;\n    float t2 = t + delta;\n    vec3 M = r.startPoint + r.direction * t1;\n    vec3 N = r.startPoint + r.direction * t2;\n\n    //\xe4\xba\xa4\xe7\x82\xb9\xe6\x96\xb9\xe5\x90\x91\xe7\x9b\xb8\xe5\x8f\x8d\n    if (t2 <= ERR) return false;\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8M\n    if (M.y >= cyl.center.y && M.y <= cyl.center.y + cyl.height) {\n        if (t1 <= ERR) return false; //\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\n        if (t1 >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        vec2 nor = normalize(M.xz - cyl.center.xz);\n        hit.distance = t1;\n        hit.hitPoint = M;\n        hit.normal = vec3(nor.x, 0.0, nor.y);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8b\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y < cyl.center.y && N.y >= cyl.center.y) {\n        float m = (cyl.center.y - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, -1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8a\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y > cyl.center.y + cyl.height && N.y <= cyl.center.y + cyl.height) {\n        float m = (cyl.center.y + cyl.height - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, 1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xbe\xa7\xe9\x9d\xa2\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\nvec2 cylinderTexCoord(vec3 P, vec3 center, float height) {\n    float ang_x = atan(P.z - center.z, P.x - center.x);\n    vec2 uv;\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = (P.y - center.y) / height;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCylinderModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitCylinder(r, cylinders[i].cyl, hit);\n    if (ret) {\n        hit.material = materials[cylinders[i].material];\n        hit.material.refractRate = 0.0; //\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n        float y = hit.hitPoint.y;\n        float y_l = cylinders[i].cyl.center.y;\n        float y_h = y_l + cylinders[i].cyl.height;\n        //\xe5\x8f\xaa\xe6\x9c\x89\xe4\xbe\xa7\xe9\x9d\xa2\xe6\x9c\x89\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && cylinders[i].useTexture && y > y_l && y < y_h) {\n            vec2 tex = cylinderTexCoord(hit.hitPoint, cylinders[i].cyl.center, cylinders[i].cyl.height);\n            float size = sqrt(2.0 * PI * cylinders[i].cyl.radius * cylinders[i].cyl.height);\n            vec3 color = sampleTexture(cylinders[i].layer, cylinders[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe7\xbc\x96\xe5\x8f\xb7\nQuad getPatch(in CustomizedModel model, int i) {\n    int offset = (model.patchOffset + i) * 5;\n    Quad q;\n\n    q.samples[0] = texelFetch(patchTex, offset).xyz;\n    q.samples[1] = texelFetch(patchTex, offset + 1).xyz;\n    q.samples[2] = texelFetch(patchTex, offset + 2).xyz;\n    q.samples[3] = texelFetch(patchTex, offset + 3).xyz;\n    q.normal = texelFetch(patchTex, offset + 4).xyz;\n\n    return q;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe7\xbb\x93\xe7\x82\xb9\xe7\xbc\x96\xe5\x8f\xb7\nBVHNode getBVH(in CustomizedModel model, int i) {\n    int offset = (model.nodeOffset + i) * 4;\n    BVHNode n;\n\n    n.AA = texelFetch(bvhTex, offset).xyz;\n    n.BB = texelFetch(bvhTex, offset + 1).xyz;\n    ivec3 tmp = ivec3(texelFetch(bvhTex, offset + 2).xyz);\n    n.l = tmp.x;\n    n.r = tmp.y;\n    tmp = ivec3(texelFetch(bvhTex, offset + 3).xyz);\n    n.n = tmp.x;\n    n.index = tmp.y;\n\n    return n;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad`AABB`\xe5\x8c\x85\xe5\x9b\xb4\xe7\x9b\x92\nfloat hitAABB(Ray r, vec3 AA, vec3 BB) {\n    vec3 M = (BB - r.startPoint) / r.direction;\n    vec3 N = (AA - r.startPoint) / r.direction;\n\n    vec3 tmax = max(M, N);\n    vec3 tmin = min(M, N);\n\n    float t1 = min(tmax.x, min(tmax.y, tmax.z));\n    float t2 = max(tmin.x, max(tmin.y, tmin.z));\n\n    return t1 >= t2 && t2 > ERR ? t2 : -1.0;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCustomizedModel(Ray r, in CustomizedModel model, inout HitInfo hit) {\n    int stack[8];\n    int p = 0;\n\n    stack[p++] = 0;\n    while (p > 0) {\n        int top = stack[--p];\n        BVHNode node = getBVH(model, top);\n\n        //\xe5\x8f\xb6\xe5\xad\x90\xe7\xbb\x93\xe7\x82\xb9\n        if (node.n > 0) {\n            int m = node.index;\n            int n = m + node.n;\n            for (int i = m; i < n; i++) {\n                Quad q = getPatch(model, i);\n                if (hitQuad(r, q, hit)) {\n                    hit.material = materials[model.material];\n                    hit.material.refractRate = 0.0; //\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n                    //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n                    if (USE_TEXTURE && model.useTexture) {\n                        vec2 tex = cylinderTexCoord(hit.hitPoint, model.center, model.height);\n                        //\xe6\x8c\x89\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\xe8\xae\xa1\xe7\xae\x97\xe5\x91\xa8\xe9\x95\xbf\n                        float radius = max(length(hit.hitPoint.xz - model.center.xz), ERR);\n                        float size = sqrt(2.0 * PI * radius * model.height);\n                        vec3 color = sampleTexture(model.layer, model.uvTransform, tex, size, hit);\n                        hit.material.color = color;\n                    }\n                    return true;\n                }\n            }\n        }\n\n        //\xe4\xb8\x8e\xe5\xb7\xa6\xe5\x8f\xb3\xe7\x9b\x92\xe5\xad\x90\xe6\xb1\x82\xe4\xba\xa4\n        float t1 = -1.0, t2 = -1.0;\n        if (node.l >= 0) {\n            BVHNode l_node = getBVH(model, node.l);\n            t1 = hitAABB(r, l_node.AA, l_node.BB);\n        }\n        if (node.r >= 0) {\n            BVHNode r_node = getBVH(model, node.r);\n            t2 = hitAABB(r, r_node.AA, r_node.BB);\n        }\n\n        //\xe5\x9c\xa8\xe6\x9c\x80\xe8\xbf\x91\xe7\x9a\x84\xe7\x9b\x92\xe5\xad\x90\xe4\xb8\xad\xe6\x90\x9c\xe7\xb4\xa2\n        if (t1 > 0 && t2 > 0) {\n            if (t1 < t2) {\n                stack[p++] = node.r;\n                stack[p++] = node.l;\n            } else {\n                stack[p++] = node.l;\n                stack[p++] = node.r;\n            }\n        } else if (t1 > 0) {\n            stack[p++] = node.l;\n        } else if (t2 > 0) {\n            stack[p++] = node.r;\n        }\n    }\n\n    return false;\n}\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe5\x88\xa4\xe6\x96\xad\nbool hitModel(Ray r, out HitInfo hit) {\n    hit.distance = INF;\n    bool ret = false;\n\n    for (int i = 0; i < cylinderNum; i++) {\n        ret = hitCylinderModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < quadNum; i++) {\n        ret = hitQuadModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < sphereNum; i++) {\n        ret = hitSphereModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < customizedNum; i++) {\n        ret = hitCustomizedModel(r, customized[i], hit) || ret;\n    }\n\n    return ret;\n}\n\n/*****************************************************\n * \xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x8d\x95\xe6\xad\xa5\xe6\x93\x8d\xe4\xbd\x9c\xef\xbc\x9a\xe7\x89\x87\xe5\x85\x83\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe4\xb8\x8e\xe6\xb3\xa2\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\x85\xb1\xe7\x94\xa8\n *****************************************************/\n\n//\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\xad\xe5\xbf\x83\xe4\xbd\x8d\xe4\xba\x8eposition\xe7\x9a\x84\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x9a\xe8\xa7\x86\xe7\x82\xb9\xe6\x8c\x87\xe5\x90\x91\xe5\x83\x8f\xe7\xb4\xa0\xe7\x82\xb9\xef\xbc\x8c\xe5\x8a\xa0\xe5\x85\xa5\xe9\x9a\x8f\xe6\x9c\xba\xe5\x81\x8f\xe7\xa7\xbb\xe9\x87\x8f\xe4\xbb\xa5\xe6\x8a\x97\xe9\x94\xaf\xe9\xbd\xbf\xef\xbc\x8c\xe5\xb9\xb6\xe5\x88\x9d\xe5\xa7\x8b\xe5\x8c\x96\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\nRay cameraRay(vec3 position) {\n    Ray r;\n    r.startPoint = eyePos;\n    vec3 screen = position;\n    float d = rand(), th = rand() * (2.0 * PI);\n    screen.x += (d * sin(th) - 0.5) * (2.0 / width);\n    screen.y += (d * cos(th) - 0.5) * (2.0 / height);\n    r.direction = normalize(screen - eyePos);\n\n    //\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\x9c\xa8\xe5\xb1\x8f\xe5\xb9\x95\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\xba\xe4\xb8\x80\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\n    coneWidth = 0.0;\n    coneSpread = 2.0 / (height * length(screen - eyePos));\n    return r;\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xae\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe6\x9d\x90\xe8\xb4\xa8\xe7\x94\x9f\xe6\x88\x90\xe7\xac\xac""depth\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe8\xbf\x94\xe5\x9b\x9e\xe5\x85\x89\xe7\xba\xbf\xe7\xb1\xbb\xe5\x9e\x8b\xef\xbc\x88""0\xe4\xb8\xba\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""1\xe4\xb8\xba\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""2\xe4\xb8\xba\xe6\x8a\x98\xe5\xb0\x84\xef\xbc\x89\xe4\xb8\x8e\xe6\xb7\xb7\xe5\x90\x88\xe6\x8c\x87\xe6\x95\xb0\nint scatter(inout Ray r, in HitInfo hit, int depth, out float tint) {\n    //\xe9\x9a\x8f\xe6\x9c\xba\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\n    vec3 oldRay = r.direction;\n    r.direction = depth == 0 ? sampleSobolHemisphere(hit.normal) : sampleHemisphere(hit.normal);\n//    r.direction = sampleHemisphere(hit.normal);\n    r.startPoint = hit.hitPoint;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe7\x89\xa9\xe4\xbd\x93\xe6\x9d\x90\xe8\xb4\xa8\xe5\x86\xb3\xe5\xae\x9a\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    float p = rand();\n    tint = 0.0;\n    if (p < hit.material.specularRate) {\n        //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\n        vec3 ref = reflect(oldRay, hit.normal);\n        r.direction = normalize(mix(ref, r.direction, hit.material.specularRoughness));\n        tint = hit.material.specularTint;\n        coneSpread += hit.material.specularRoughness * CONE_ROUGH_SPREAD;\n        return 1;\n    } else if (USE_REFRACT && hit.material.specularRate <= p && p <= hit.material.specularRate + hit.material.refractRate) {\n        //\xe6\x8a\x98\xe5\xb0\x84\n        vec3 ref = refract(oldRay, hit.normal, 1.0 / hit.material.refractIndex);\n        r.direction = normalize(mix(ref, -r.direction, hit.material.refractRoughness));\n        tint = hit.material.refractTint;\n        coneSpread += hit.material.refractRoughness * CONE_ROUGH_SPREAD;\n        return 2;\n    }\n    //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\n    coneSpread += CONE_DIFFUSE_SPREAD;\n    return 0;\n}\n\n//\xe6\x9c\xac\xe5\xb1\x82\xe5\xaf\xb9\xe4\xb8\x8b\xe4\xb8\x80\xe5\xb1\x82\xe9\xa2\x9c\xe8\x89\xb2\xe7\x9a\x84\xe7\xba\xbf\xe6\x80\xa7\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9a\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe9\x80\x90\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x98\xe4\xbb\xa5\xe9\xa2\x9c\xe8\x89\xb2\xef\xbc\x9b\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x9c\xa8\xe9\xa2\x9c\xe8\x89\xb2\xe4\xb9\x98\xe4\xbb\xa5\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe4\xb8\x8e\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe4\xb9\x8b\xe9\x97\xb4\xe6\x8c\x89tint\xe6\x8f\x92\xe5\x80\xbc\xef\xbc\x8c\n//\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe5\x8f\x96\xe5\x90\x84\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x8b\xe5\x92\x8c\xe9\x99\xa4\xe4\xbb\xa5sqrt(3)\xef\xbc\x8c\xe5\xaf\xb9\xe7\x99\xbd\xe5\x85\x89\xe4\xb8\x8e\xe5\x90\x91\xe9\x87\x8f\xe9\x95\xbf\xe5\xba\xa6\xe7\x9b\xb8\xe5\x90\x8c\xef\xbc\x8c\xe4\xbd\xbf\xe5\x8f\x98\xe6\x8d\xa2\xe4\xbf\x9d\xe6\x8c\x81\xe7\xba\xbf\xe6\x80\xa7\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x8f\xaf\xe6\xb2\xbf\xe8\xb7\xaf\xe5\xbe\x84\xe5\x90\x91\xe5\x89\x8d\xe7\xb4\xaf\xe4\xb9\x98\nmat3 transfer(vec3 color, float cosine, int type, float tint) {\n    float s = sqrt(cosine);\n    if (type == 0) return mat3(color.r * s, 0.0, 0.0, 0.0, color.g * s, 0.0, 0.0, 0.0, color.b * s);\n    return s * (outerProduct(color, vec3((1.0 - tint) / sqrt(3.0))) + mat3(tint));\n}\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe7\x9a\x84\xe4\xb8\x80\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xef\xbc\x9a\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe6\x97\xb6\xe5\xb0\x86\xe5\x85\xb6\xe8\xbe\x90\xe5\xb0\x84\xe4\xba\xae\xe5\xba\xa6\xe7\xbb\x8f\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe7\xb4\xaf\xe5\x8a\xa0\xe5\x88\xb0radiance\xe5\xb9\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\xef\xbc\x8c\xe5\x90\xa6\xe5\x88\x99\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\xb9\xb6\xe6\x9b\xb4\xe6\x96\xb0\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xef\xbc\x8c\n//\xe8\xa2\xab\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe6\x97\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\nbool bounce(inout Ray r, in HitInfo hit, int depth, inout mat3 throughput, inout vec3 radiance) {\n    //\xe5\x8f\x8d\xe4\xbc\xbd\xe9\xa9\xac\xe6\xa0\xa1\xe6\xad\xa3\n    vec3 color = pow(hit.material.color, vec3(2.2));\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe4\xbc\xa0\xe6\x92\xad\xe5\x88\xb0\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\n    coneWidth += coneSpread * hit.distance;\n\n    if (hit.material.lighting) {\n        radiance += throughput * (color * 2.0);\n        return false;\n    }\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe5\xa4\xb9\xe8\xa7\x92\xe4\xbd\x99\xe5\xbc\xa6\xef\xbc\x8c\xe5\x9c\xa8\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\n    float cosine = abs(dot(hit.normal, r.direction));\n    float tint;\n    int type = scatter(r, hit, depth, tint);\n    throughput *= transfer(color, cosine, type, tint);\n\n    //\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xef\xbc\x9a\xe6\x8c\x89\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x86\xb3\xe5\xae\x9a\xe8\xb7\xaf\xe5\xbe\x84\xe6\x98\xaf\xe5\x90\xa6\xe7\xbb\xa7\xe7\xbb\xad\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe8\xb6\x8a\xe5\xb0\x8f\xe8\xb6\x8a\xe5\x8f\xaf\xe8\x83\xbd\xe7\xbb\x93\xe6\x9d\x9f\xef\xbc\x9b\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe9\x99\xa4\xe4\xbb\xa5\xe5\xad\x98\xe6\xb4\xbb\xe6\xa6\x82\xe7\x8e\x87\xef\xbc\x8c\xe6\x9c\x9f\xe6\x9c\x9b\xe4\xb8\x8d\xe5\x8f\x98\n    if (depth + 1 >= rouletteDepth) {\n        vec3 response = throughput * vec3(1.0);\n        float survive = min(max(response.r, max(response.g, response.b)), 1.0);\n        if (rand() >= survive) return false;\n        throughput /= survive;\n    }\n    return true;\n}\n\n//\xe9\xa2\x84\xe8\xa7\x88\xef\xbc\x9a\xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x8f\x98\xe4\xbd\x93\xe7\xbc\x96\xe8\xaf\x91\xe5\xae\x8c\xe6\x88\x90\xe5\x89\x8d\xe4\xbd\xbf\xe7\x94\xa8\xef\xbc\x8c\xe5\x8f\xaa\xe6\x8a\x95\xe5\xb0\x84\xe7\xbb\x8f\xe8\xbf\x87\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\xad\xe5\xbf\x83\xe7\x9a\x84\xe4\xb8\xbb\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe8\xbe\x93\xe5\x87\xba\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe5\x8f\x8d\xe7\x85\xa7\xe7\x8e\x87\n//\xe4\xb8\x8d\xe6\xb3\xa8\xe5\x85\xa5\xe5\x9c\xba\xe6\x99\xaf\xe7\x89\xb9\xe5\x8c\x96\xe7\x9a\x84\xe5\xae\x8f\xef\xbc\x8c\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe7\x94\xb1uniform\xe7\xbb\x99\xe5\x87\xba\xef\xbc\x8c\xe7\xbc\x96\xe8\xaf\x91\xe4\xb8\x80\xe6\xac\xa1\xe5\x90\x8e\xe5\x9c\xa8\xe5\x8f\x98\xe4\xbd\x93\xe5\x88\x87\xe6\x8d\xa2\xe9\x97\xb4\xe5\xa4\x8d\xe7\x94\xa8\n\nin vec3 position;\nlayout (location = 0) out vec3 FragData;\n\nvoid main() {\n    Ray r;\n    r.startPoint = eyePos;\n    r.direction = normalize(position - eyePos);\n    coneSpread = 2.0 / (height * length(position - eyePos));\n    HitInfo hit;\n    FragData = hitModel(r, hit) ? hit.material.color : vec3(0.0);\n}\n"
 
 #define render_frag "#version 450 core\n\nuniform sampler2D frameBuffer;\nuniform int maxFrame;\n\nin vec3 position;\nout vec3 FragColor;\n\nvoid main() {\n    vec2 pixel = position.xy * 0.5 + 0.5;\n    vec3 color = texture(frameBuffer, pixel).xyz;\n//    vec3 color = texture(frameBuffer, pixel).xyz / maxFrame;\n    FragColor = pow(color / maxFrame, vec3(1.0 / 2.2)); //\xe4\xbc\xbd\xe9\xa9\xac\xe6\xa0\xa1\xe6\xad\xa3\n//    FragColor = color / maxFrame;\n}"
+
+#define wavefront_comp "#version 450 core\n\n//\xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x85\xac\xe5\x85\xb1\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe5\x9c\xba\xe6\x99\xaf\xe6\x8f\x8f\xe8\xbf\xb0\xe3\x80\x81\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xe3\x80\x81\xe9\x87\x87\xe6\xa0\xb7\xe4\xb8\x8e\xe6\xb1\x82\xe4\xba\xa4\xef\xbc\x8c\xe7\x94\xb1tracer.frag\xe4\xb8\x8ewavefront.comp\xe5\x8c\x85\xe5\x90\xab\n//\xe5\x8c\x85\xe5\x90\xab\xe5\x89\x8d\xe9\xa1\xbb\xe5\xb7\xb2\xe5\xa3\xb0\xe6\x98\x8e#version\n\n#define PI 3.1415926\n#define INF 114514.0\n#define ERR 0.0001\n#define CONE_DIFFUSE_SPREAD 0.1 //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe5\x90\x8e\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\n#define CONE_ROUGH_SPREAD 0.5   //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x90\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xe7\x9a\x84\xe5\xa2\x9e\xe9\x87\x8f\xe4\xb8\x8e\xe6\xa8\xa1\xe7\xb3\x8a\xe5\xba\xa6\xe4\xb9\x8b\xe6\xaf\x94\n\n//\xe5\xb1\x8f\xe5\xb9\x95\xe5\x8f\x82\xe6\x95\xb0\nuniform int width;\nuniform int height;\n\n//\xe5\xb8\xa7\xe6\x95\xb0\xef\xbc\x9a\xe5\xb7\xb2\xe7\xb4\xaf\xe7\xa7\xaf\xe7\x9a\x84\xe6\xa0\xb7\xe6\x9c\xac\xe6\x95\xb0\xef\xbc\x8c\xe4\xb9\x9f\xe6\x98\xaf\xe6\x9c\xac\xe6\xac\xa1\xe7\xbb\x98\xe5\x88\xb6\xe4\xb8\xad\xe9\xa6\x96\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe5\xba\x8f\xe5\x8f\xb7\nuniform int frame;\nuniform int maxFrame;\n\n//\xe8\xa7\x86\xe7\x82\xb9\nuniform vec3 eyePos;\n\n//\xe6\x9c\x80\xe5\xa4\xa7\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xef\xbc\x9a\xe8\xbf\x90\xe8\xa1\x8c\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\xef\xbc\x8c\xe4\xb8\x8d\xe9\x99\x90\xe5\x88\xb6\xe4\xb8\x8a\xe9\x99\x90\nuniform int maxDepth;\n//\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xe8\xbe\xbe\xe5\x88\xb0\xe5\x90\x8e\xe5\xbc\x80\xe5\xa7\x8b\xe4\xbb\xa5\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe8\xb7\xaf\xe5\xbe\x84\nuniform int rouletteDepth;\n\n//\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x85\xb1\xe7\x94\xa8\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\nuniform sampler2DArray textures;\n\n//\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\xef\xbc\x9a\xe5\x8f\x82\xe8\x80\x83material.h\nstruct Material {\n    vec3 color;\n    float specularRate;\n    float specularTint;\n    float specularRoughness;\n    float refractRate;\n    float refractTint;\n    float refractIndex;\n    float refractRoughness;\n    bool lighting;\n};\n\n//`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\nstruct BVHNode {\n    vec3 AA;\n    vec3 BB;\n    int l;\n    int r;\n    int n;\n    int index;\n};\n\n/*****************************************************\n * \xe6\xa8\xa1\xe5\x9e\x8b\xe5\xae\x9a\xe4\xb9\x89\xef\xbc\x9a\xe4\xbb\xa5std430\xe5\xb8\x83\xe5\xb1\x80\xe5\xad\x98\xe6\x94\xbe\xe5\x9c\xa8\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\xad\x98\xe5\x82\xa8\xe7\xbc\x93\xe5\x86\xb2\xe4\xb8\xad\xef\xbc\x8c\xe5\x8f\x82\xe8\x80\x83scenebuffer.h\n *****************************************************/\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nstruct Quad {\n    vec3 samples[4];\n    vec3 normal;\n};\n\n//\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nstruct QuadModel {\n    Quad quad;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\nstruct Sphere {\n    vec3 center;\n    float radius;\n};\n\n//\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct SphereModel {\n    Sphere sph;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nstruct Cylinder {\n    vec3 center;\n    float radius;\n    float height;\n};\n\n//\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nstruct CylinderModel {\n    Cylinder cyl;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n//\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xef\xbc\x9a\xe6\x89\x80\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe5\x90\x88\xe5\xb9\xb6\xe5\xad\x98\xe6\x94\xbe\xef\xbc\x8c\xe5\x90\x84\xe6\xa8\xa1\xe5\x9e\x8b\xe8\xae\xb0\xe5\xbd\x95\xe8\x87\xaa\xe5\xb7\xb1\xe7\x9a\x84\xe8\xb5\xb7\xe5\xa7\x8b\xe4\xb8\x8b\xe6\xa0\x87\nstruct CustomizedModel {\n    vec3 center;\n    float height;\n    int material;       //\xe6\x9d\x90\xe8\xb4\xa8\xe8\xa1\xa8\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    bool useTexture;\n    int layer;          //\xe7\xba\xb9\xe7\x90\x86\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe5\xb1\x82\xe5\x8f\xb7\n    int nodeOffset;     //BVH\xe6\xa0\x91\xe6\xa0\xb9\xe7\xbb\x93\xe7\x82\xb9\xe5\x9c\xa8\xe7\xbb\x93\xe7\x82\xb9\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    int patchOffset;    //\xe9\xa6\x96\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe5\x9c\xa8\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe7\xbb\x84\xe4\xb8\xad\xe7\x9a\x84\xe4\xb8\x8b\xe6\xa0\x87\n    vec4 uvTransform;   //\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9axy\xe4\xb8\xba\xe7\xbc\xa9\xe6\x94\xbe\xef\xbc\x8czw\xe4\xb8\xba\xe5\x81\x8f\xe7\xa7\xbb\n};\n\n/*****************************************************/\n\n//\xe5\x85\x89\xe7\xba\xbf\nstruct Ray {\n    vec3 startPoint;\n    vec3 direction;\n};\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe4\xbf\xa1\xe6\x81\xaf\nstruct HitInfo {\n    float distance;         // \xe4\xb8\x8e\xe4\xba\xa4\xe7\x82\xb9\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\n    vec3 hitPoint;          // \xe5\x85\x89\xe7\xba\xbf\xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\n    vec3 normal;            // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\xba\xbf\n    vec3 viewDir;           // \xe5\x87\xbb\xe4\xb8\xad\xe8\xaf\xa5\xe7\x82\xb9\xe7\x9a\x84\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    Material material;      // \xe5\x91\xbd\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa1\xa8\xe9\x9d\xa2\xe6\x9d\x90\xe8\xb4\xa8\n};\n\n//\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\xbd\x93\xe5\x89\x8d\xe5\x85\x89\xe7\xba\xbf\xe8\xb5\xb7\xe7\x82\xb9\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\x8e\xe6\x89\xa9\xe6\x95\xa3\xe8\xa7\x92\xef\xbc\x8c\xe7\x94\xa8\xe4\xba\x8e\xe9\x80\x89\xe6\x8b\xa9\xe7\xba\xb9\xe7\x90\x86\xe7\x9a\x84mipmap\xe5\xb1\x82\xe7\xba\xa7\nfloat coneWidth = 0.0;\nfloat coneSpread = 0.0;\n\n//\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbf\xa1\xe6\x81\xaf\xef\xbc\x9a\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe5\x8f\xaa\xe5\x8f\x97\xe7\xbc\x93\xe5\x86\xb2\xe5\xa4\xa7\xe5\xb0\x8f\xe9\x99\x90\xe5\x88\xb6\n//\xe5\x9c\xba\xe6\x99\xaf\xe7\x89\xb9\xe5\x8c\x96\xe7\x9a\x84\xe5\x8f\x98\xe4\xbd\x93\xe7\x94\xb1Scene\xe6\xb3\xa8\xe5\x85\xa5SPECIALIZED\xe5\x8f\x8a\xe4\xb8\x8b\xe5\x88\x97\xe5\xae\x8f\xef\xbc\x8c\xe6\xa8\xa1\xe5\x9e\x8b\xe6\x95\xb0\xe9\x87\x8f\xe6\x88\x90\xe4\xb8\xba\xe5\xb8\xb8\xe9\x87\x8f\xef\xbc\x8c\xe5\xbe\xaa\xe7\x8e\xaf\xe5\x8f\xaf\xe5\xb1\x95\xe5\xbc\x80\xef\xbc\x8c\xe6\x9c\xaa\xe7\x94\xa8\xe5\x88\xb0\xe7\x9a\x84\xe5\x88\x86\xe6\x94\xaf\xe5\x8f\xaf\xe6\xb6\x88\xe9\x99\xa4\n#ifdef SPECIALIZED\nconst int quadNum = QUAD_NUM;\nconst int sphereNum = SPHERE_NUM;\nconst int cylinderNum = CYLINDER_NUM;\nconst int customizedNum = CUSTOMIZED_NUM;\n#else\nuniform int quadNum;\nuniform int sphereNum;\nuniform int cylinderNum;\nuniform int customizedNum;\n#define USE_TEXTURE true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xbd\xbf\xe7\x94\xa8\xe7\xba\xb9\xe7\x90\x86\n#define USE_REFRACT true       //\xe5\x9c\xba\xe6\x99\xaf\xe4\xb8\xad\xe6\x9c\x89\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n#define ACCUMULATE_BLEND false //\xe7\xb4\xaf\xe7\xa7\xaf\xe6\x96\xb9\xe5\xbc\x8f\xef\xbc\x9a\xe5\x8a\xa0\xe6\xb3\x95\xe6\xb7\xb7\xe5\x90\x88\xef\xbc\x8c\xe6\x88\x96\xe8\xaf\xbb\xe5\x8f\x96\xe4\xb9\x8b\xe5\x89\x8d\xe7\x9a\x84\xe7\xbb\x93\xe6\x9e\x9c\xe5\x90\x8e\xe5\x86\x99\xe5\x85\xa5\xe5\x8f\xa6\xe4\xb8\x80\xe4\xb8\xaa\xe7\xbc\x93\xe5\x86\xb2\n#endif\n\nlayout (std430, binding = 0) readonly buffer MaterialBuffer {\n    Material materials[];\n};\nlayout (std430, binding = 1) readonly buffer QuadBuffer {\n    QuadModel quads[];\n};\nlayout (std430, binding = 2) readonly buffer SphereBuffer {\n    SphereModel spheres[];\n};\nlayout (std430, binding = 3) readonly buffer CylinderBuffer {\n    CylinderModel cylinders[];\n};\nlayout (std430, binding = 4) readonly buffer CustomizedBuffer {\n    CustomizedModel customized[];\n};\n\n//\xe6\x89\x80\xe6\x9c\x89\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x90\x88\xe5\xb9\xb6\xe5\x90\x8e\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe9\x9d\xa2\xe7\x89\x87\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe9\xa1\xb6\xe7\x82\xb9\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xef\xbc\x89\xe4\xb8\x8e`BVH`\xe6\xa0\x91\xe7\xbb\x93\xe7\x82\xb9\xef\xbc\x88\xe6\xaf\x8f\xe4\xb8\xaa\xe7\xbb\x93\xe7\x82\xb9\xe4\xb8\xba\xe5\x9b\x9b\xe4\xb8\xaa\xe4\xb8\x89\xe7\xbb\xb4\xe5\x90\x91\xe9\x87\x8f\xef\xbc\x89\nuniform samplerBuffer patchTex;\nuniform samplerBuffer bvhTex;\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xef\xbc\x9a\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90+\xe5\x93\x88\xe5\xb8\x8c\n *****************************************************/\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe5\xbc\x80\xe5\xa7\x8b\xe6\x97\xb6\xe8\xae\xbe\xe7\xbd\xae\nuint seed = 0u;\n\n//\xe5\x93\x88\xe5\xb8\x8c\xe5\x87\xbd\xe6\x95\xb0\nuint hash(inout uint seed) {\n    seed *= 0x27d4eb2du;\n    seed = seed ^ (seed >> 15);\n    return seed;\n}\n\n//\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\nfloat rand() {\n    return float(hash(seed)) / 4294967296.0;\n}\n\n/*****************************************************\n * sobol\xe5\xba\x8f\xe5\x88\x97\n *****************************************************/\n\nuniform uint V[64];\n\n//\xe4\xbb\x85\xe4\xb8\x8e\xe5\x83\x8f\xe7\xb4\xa0\xe5\x9d\x90\xe6\xa0\x87\xe6\x9c\x89\xe5\x85\xb3\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\nuint pseed = 0u;\n\n//\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nint gray = 0;\n\n//\xe8\xae\xbe\xe7\xbd\xae\xe5\x83\x8f\xe7\xb4\xa0""coord\xe5\xa4\x84\xe7\xac\xaci\xe4\xb8\xaa\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe9\x9a\x8f\xe6\x9c\xba\xe7\xa7\x8d\xe5\xad\x90\xe4\xb8\x8e\xe6\xa0\xbc\xe6\x9e\x97\xe7\xa0\x81\nvoid beginSample(uvec2 coord, int i) {\n    uint pixel = coord.x * 1973u + coord.y * 9277u;\n    seed = pixel + uint(i * maxFrame) * 26699u;\n    pseed = pixel + 512u * 26699u;\n    gray = i ^ (i >> 1);\n}\n\n//\xe7\x94\x9f\xe6\x88\x90`sobol`\xe6\x95\xb0\nfloat sobol(int d, int i) {\n    uint result = 0u;\n    int offset = d * 32;\n    for (int j = 0, k = i; k != 0; k >>= 1, j++) {\n        if ((k & 1) == 1) {\n            result ^= V[j + offset];\n        }\n    }\n    return float(result) / 4294967296.0;\n}\n\nfloat CranleyPattersonRotation(float p) {\n    float u = float(hash(pseed)) / 4294967296.0;\n    p += u;\n    if(p > 1.0) p -= 1.0;\n    if(p < 0.0) p += 1.0;\n    return p;\n}\n\n/*****************************************************\n * \xe7\x94\x9f\xe6\x88\x90\xe9\x9a\x8f\xe6\x9c\xba\xe5\x90\x91\xe9\x87\x8f\n *****************************************************/\n\n//\xe5\xb0\x86\xe5\x90\x91\xe9\x87\x8fv\xe6\x8a\x95\xe5\xbd\xb1\xe5\x88\xb0N\xe7\x9a\x84\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\nvec3 toNormalHemisphere(vec3 v, vec3 N) {\n    vec3 helper = vec3(1.0, 0.0, 0.0);\n    if(abs(N.x) >= 1.0 - ERR) helper = vec3(0.0, 0.0, 1.0);\n    vec3 tangent = normalize(cross(N, helper));\n    vec3 bitangent = normalize(cross(N, tangent));\n    return v.x * tangent + v.y * bitangent + v.z * N;\n}\n\n//\xe6\xb3\x95\xe5\x90\x91\xe5\x8d\x8a\xe7\x90\x83\xe9\x9a\x8f\xe6\x9c\xba\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleHemisphere(vec3 N) {\n    float r = sqrt(rand());\n    float t = rand() * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xaesobol\xe5\xba\x8f\xe5\x88\x97\xe7\x9a\x84\xe5\x9d\x87\xe5\x8c\x80\xe5\x8d\x8a\xe7\x90\x83\xe9\x87\x87\xe6\xa0\xb7\nvec3 sampleSobolHemisphere(vec3 N) {\n    float u = CranleyPattersonRotation(sobol(0, gray));\n    float v = CranleyPattersonRotation(sobol(1, gray));\n//    float u = sobol(0, gray);\n//    float v = sobol(1, gray);\n    float r = sqrt(u);\n    float t = v * (2.0 * PI);\n    float x = r * cos(t);\n    float y = r * sin(t);\n    float z = sqrt(1.0 - x * x - y * y);\n    return toNormalHemisphere(vec3(x, y, z), N);\n}\n\n/*****************************************************\n * \xe5\x85\x89\xe7\xba\xbf\xe8\xbf\xbd\xe8\xb8\xaa\n *****************************************************/\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 quadTexCoord(in vec3 samples[4], vec3 P) {\n    vec3 m = samples[2] - samples[0];\n    vec3 n = samples[0] - samples[1];\n    vec3 q = P - samples[1];\n    if (m.x == 0.0 && n.x == 0.0 && q.x == 0) {\n        mat2 mn = mat2(m.yz, n.yz);\n        return inverse(mn) * q.yz;\n    }\n    if (m.y == 0.0 && n.y == 0.0 && q.y == 0.0) {\n        mat2 mn = mat2(m.xz, n.xz);\n        return inverse(mn) * q.xz;\n    }\n    mat2 mn = mat2(m.xy, n.xy);\n    return inverse(mn) * q.xy;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\nbool hitQuad(Ray r, in Quad quad, inout HitInfo hit) {\n    //\xe6\xb1\x82\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\xb9\xb3\xe9\x9d\xa2\xe4\xba\xa4\xe7\x82\xb9\n    vec3 n1 = quad.samples[1] - quad.samples[0];\n    vec3 n2 = quad.samples[2] - quad.samples[0];\n    vec3 normal = normalize(cross(n1, n2));\n    float d = -dot(quad.samples[0], normal);\n    float m = dot(r.direction, normal);\n    if (m >= -ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe8\x83\x8c\xe5\x90\x91\xe9\x9d\xa2\n    float t = -(d + dot(r.startPoint, normal)) / m;\n    if (t <= ERR) return false; //\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    vec3 P = r.startPoint + r.direction * t;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe5\x8f\x89\xe4\xb9\x98\xe4\xb8\x8e\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\xe5\x85\xb3\xe7\xb3\xbb\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x90\xa6\xe5\x9c\xa8\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe5\x86\x85\n    vec3 n3 = P - quad.samples[0];\n    vec3 n4 = P - quad.samples[1];\n    vec3 n5 = P - quad.samples[2];\n    float f1 = dot(cross(n1, n3), normal);\n    float f2 = dot(cross(n3, n2), normal);\n    float f3 = dot(cross(n5, n1), normal);\n    float f4 = dot(cross(n2, n4), normal);\n\n    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {\n        hit.distance = t;\n        hit.hitPoint = P;\n        hit.viewDir = r.direction;\n        hit.normal = normal;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe6\x8c\x89\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe5\x9c\xa8\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe8\xa6\x86\xe7\x9b\x96\xe8\x8c\x83\xe5\x9b\xb4\xe9\x80\x89\xe6\x8b\xa9mipmap\xe5\xb1\x82\xe7\xba\xa7\xe9\x87\x87\xe6\xa0\xb7\xe7\xba\xb9\xe7\x90\x86\xef\xbc\x8cworldSize\xe4\xb8\xba\xe5\x8d\x95\xe4\xbd\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe5\xaf\xb9\xe5\xba\x94\xe7\x9a\x84\xe4\xb8\x96\xe7\x95\x8c\xe7\xa9\xba\xe9\x97\xb4\xe9\x95\xbf\xe5\xba\xa6\nvec3 sampleTexture(int layer, vec4 uvTransform, vec2 uv, float worldSize, in HitInfo hit) {\n    float footprint = (coneWidth + coneSpread * hit.distance) / max(abs(dot(hit.normal, hit.viewDir)), 0.01);\n    vec2 arraySize = vec2(textureSize(textures, 0).xy);\n    vec2 size = arraySize * uvTransform.xy;\n    float lod = log2(footprint * sqrt(size.x * size.y) / worldSize);\n\n    //\xe7\xba\xb9\xe7\x90\x86\xe5\x8f\xaa\xe5\x8d\xa0\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x80\xe9\x83\xa8\xe5\x88\x86\xef\xbc\x9a\xe9\x87\x8d\xe5\xa4\x8d\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xef\xbc\x8c\xe5\xb9\xb6\xe5\x9c\xa8\xe6\x89\x80\xe7\x94\xa8\xe5\xb1\x82\xe7\xba\xa7\xe4\xb8\x8a\xe7\xa6\xbb\xe5\x8c\xba\xe5\x9f\x9f\xe8\xbe\xb9\xe7\x95\x8c\xe4\xbf\x9d\xe7\x95\x99\xe5\x8d\x8a\xe4\xb8\xaa\xe7\xba\xb9\xe7\xb4\xa0\xef\xbc\x8c\xe9\x81\xbf\xe5\x85\x8d\xe9\x87\x87\xe6\xa0\xb7\xe5\x88\xb0\xe5\x8c\xba\xe5\x9f\x9f\xe5\xa4\x96\n    int level = clamp(int(ceil(lod)), 0, textureQueryLevels(textures) - 1);\n    vec2 half_texel = 0.5 / vec2(textureSize(textures, level).xy);\n    vec2 st = clamp(fract(uv) * uvTransform.xy, half_texel, uvTransform.xy - half_texel) + uvTransform.zw;\n    return textureLod(textures, vec3(st, layer), lod).xyz;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9b\x9b\xe8\xbe\xb9\xe5\xbd\xa2\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitQuadModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitQuad(r, quads[i].quad, hit);\n    if (ret) {\n        hit.material = materials[quads[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && quads[i].useTexture) {\n            vec2 tex = quadTexCoord(quads[i].quad.samples, hit.hitPoint);\n            float size = sqrt(length(quads[i].quad.samples[2] - quads[i].quad.samples[0]) *\n                              length(quads[i].quad.samples[0] - quads[i].quad.samples[1]));\n            vec3 color = sampleTexture(quads[i].layer, quads[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\nbool hitSphere(Ray r, in Sphere sphere, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe7\x90\x83\xe5\xbf\x83\xe8\xb7\x9d\xe7\xa6\xbb\n    float t = dot(sphere.center - r.startPoint, r.direction);\n    vec3 T = r.startPoint + r.direction * t;\n    vec3 CP = T - sphere.center;\n    float l_CP = length(CP);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_CP > sphere.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xba\xa4\xe7\x82\xb9\n    float delta = sqrt(sphere.radius * sphere.radius - l_CP * l_CP);\n    float t1 = t - delta;\n    float t2 = t + delta;\n\n    //\xe5\x88\xa4\xe6\x96\xad\xe6\x98\xaf\xe5\x93\xaa\xe4\xb8\xaa\xe4\xba\xa4\xe7\x82\xb9\xef\xbc\x8c\xe5\xb9\xb6\xe5\x89\x94\xe9\x99\xa4\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\xe7\x9a\x84\xe6\x83\x85\xe5\x86\xb5\n    if (t1 > ERR) t = t1;\n    else if (t2 > ERR) t = t2;\n    else return false;\n\n    //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n    if (t >= hit.distance - ERR) return false;\n\n    hit.distance = t;\n    hit.hitPoint = r.startPoint + r.direction * t;\n    hit.normal = normalize(hit.hitPoint - sphere.center);\n    hit.viewDir = r.direction;\n    return true;\n}\n\n//\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe5\x88\xb0\xe7\x90\x83\xe9\x9d\xa2\xe7\xba\xb9\xe7\x90\x86\xe5\x9d\x90\xe6\xa0\x87\xe7\x9a\x84\xe6\x98\xa0\xe5\xb0\x84\nvec2 sphereTexCoord(vec3 N) {\n    float ang_x = atan(N.z, N.x);\n    float ang_y = asin(N.y);\n    vec2 uv = vec2(ang_x, ang_y);\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = 0.5 + ang_y / PI;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe7\x90\x83\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitSphereModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitSphere(r, spheres[i].sph, hit);\n    if (ret) {\n        hit.material = materials[spheres[i].material];\n        //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && spheres[i].useTexture) {\n            vec2 texc = sphereTexCoord(hit.normal);\n            //\xe7\xbb\x8f\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x91\xa8\xe9\x95\xbf\xef\xbc\x8c\xe7\xba\xac\xe5\xba\xa6\xe6\x96\xb9\xe5\x90\x91\xe8\xb7\xa8\xe8\xb6\x8a\xe5\x8d\x8a\xe5\x91\xa8\xe9\x95\xbf\n            float size = sqrt(2.0) * PI * spheres[i].sph.radius;\n            vec3 color = sampleTexture(spheres[i].layer, spheres[i].uvTransform, texc, size, hit);\n            hit.material.color = color;\n        }\n        //\xe6\x8a\x98\xe5\xb0\x84\xe7\x8e\x87\xef\xbc\x9a\xe5\xb0\x84\xe5\x87\xba\xe6\x97\xb6\xe9\x9c\x80\xe8\xa6\x81\xe5\x8f\x96\xe5\x80\x92\xe6\x95\xb0\n        float ref_ang = hit.material.refractIndex;\n        if (ref_ang != 0 && dot(hit.normal, r.direction) > 0) {\n            hit.material.refractIndex = 1.0 / ref_ang;\n            hit.normal = -hit.normal;\n        }\n    }\n    return ret;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\nbool hitCylinder(Ray r, in Cylinder cyl, inout HitInfo hit) {\n    //\xe8\xae\xa1\xe7\xae\x97\xe5\x85\x89\xe7\xba\xbf\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe6\x9c\x80\xe7\x9f\xad\xe8\xb7\x9d\xe7\xa6\xbb\n    vec2 SF = cyl.center.xz - r.startPoint.xz;\n    vec2 d_ST = r.direction.xz;\n    float l_FT = abs(SF.y * d_ST.x - SF.x * d_ST.y) / length(d_ST);\n\n    //\xe8\xb7\x9d\xe7\xa6\xbb\xe5\xa4\xa7\xe4\xba\x8e\xe5\x8d\x8a\xe5\xbe\x84\xe5\x88\x99\xe4\xb8\x8d\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9b\xb8\xe4\xba\xa4\n    if (l_FT > cyl.radius) return false;\n\n    //\xe8\xae\xa1\xe7\xae\x97\xe4\xb8\x8e\xe6\x97\xa0\xe9\x99\x90\xe9\x95\xbf\xe5\x9c\x86\xe6\x9f\xb1\xe9\x9d\xa2\xe7\x9a\x84\xe4\xba\xa4\xe7\x82\xb9\n    float l_SF = length(SF);\n    float t = sqrt(l_SF * l_SF - l_FT * l_FT) / length(d_ST);\n    float right = cyl.radius * cyl.radius - l_FT * l_FT;\n    float left = 1.0 - r.direction.y * r.direction.y;\n    float delta = sqrt(right / left);\n    float t1 = t - delta;\n    float t2 = t + delta;\n    vec3 M = r.startPoint + r.direction * t1;\n    vec3 N = r.startPoint + r.direction * t2;\n\n    //\xe4\xba\xa4\xe7\x82\xb9\xe6\x96\xb9\xe5\x90\x91\xe7\x9b\xb8\xe5\x8f\x8d\n    if (t2 <= ERR) return false;\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8M\n    if (M.y >= cyl.center.y && M.y <= cyl.center.y + cyl.height) {\n        if (t1 <= ERR) return false; //\xe4\xb8\x8e\xe8\x87\xaa\xe8\xba\xab\xe7\x9b\xb8\xe4\xba\xa4\n        if (t1 >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        vec2 nor = normalize(M.xz - cyl.center.xz);\n        hit.distance = t1;\n        hit.hitPoint = M;\n        hit.normal = vec3(nor.x, 0.0, nor.y);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8b\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y < cyl.center.y && N.y >= cyl.center.y) {\n        float m = (cyl.center.y - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, -1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    //\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x9c\xa8\xe4\xb8\x8a\xe5\xba\x95\xe9\x9d\xa2\n    if (M.y > cyl.center.y + cyl.height && N.y <= cyl.center.y + cyl.height) {\n        float m = (cyl.center.y + cyl.height - r.startPoint.y) / r.direction.y;\n        if (m >= hit.distance - ERR) return false; //\xe5\xad\x98\xe5\x9c\xa8\xe9\x81\xae\xe6\x8c\xa1\n        hit.distance = m;\n        hit.hitPoint = r.startPoint + r.direction * m;\n        hit.normal = vec3(0.0, 1.0, 0.0);\n        hit.viewDir = r.direction;\n        return true;\n    }\n\n    return false;\n}\n\n//\xe7\x82\xb9\xe5\x9d\x90\xe6\xa0\x87\xe5\x88\xb0\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xbe\xa7\xe9\x9d\xa2\xe7\x9a\x84\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\nvec2 cylinderTexCoord(vec3 P, vec3 center, float height) {\n    float ang_x = atan(P.z - center.z, P.x - center.x);\n    vec2 uv;\n    uv.x = 1.0 - ang_x / (2.0 * PI);\n    uv.y = (P.y - center.y) / height;\n    return uv;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCylinderModel(Ray r, int i, inout HitInfo hit) {\n    bool ret = hitCylinder(r, cylinders[i].cyl, hit);\n    if (ret) {\n        hit.material = materials[cylinders[i].material];\n        hit.material.refractRate = 0.0; //\xe5\x9c\x86\xe6\x9f\xb1\xe4\xbd\x93\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n        float y = hit.hitPoint.y;\n        float y_l = cylinders[i].cyl.center.y;\n        float y_h = y_l + cylinders[i].cyl.height;\n        //\xe5\x8f\xaa\xe6\x9c\x89\xe4\xbe\xa7\xe9\x9d\xa2\xe6\x9c\x89\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n        if (USE_TEXTURE && cylinders[i].useTexture && y > y_l && y < y_h) {\n            vec2 tex = cylinderTexCoord(hit.hitPoint, cylinders[i].cyl.center, cylinders[i].cyl.height);\n            float size = sqrt(2.0 * PI * cylinders[i].cyl.radius * cylinders[i].cyl.height);\n            vec3 color = sampleTexture(cylinders[i].layer, cylinders[i].uvTransform, tex, size, hit);\n            hit.material.color = color;\n        }\n    }\n    return ret;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe9\x9d\xa2\xe7\x89\x87\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe9\x9d\xa2\xe7\x89\x87\xe7\xbc\x96\xe5\x8f\xb7\nQuad getPatch(in CustomizedModel model, int i) {\n    int offset = (model.patchOffset + i) * 5;\n    Quad q;\n\n    q.samples[0] = texelFetch(patchTex, offset).xyz;\n    q.samples[1] = texelFetch(patchTex, offset + 1).xyz;\n    q.samples[2] = texelFetch(patchTex, offset + 2).xyz;\n    q.samples[3] = texelFetch(patchTex, offset + 3).xyz;\n    q.normal = texelFetch(patchTex, offset + 4).xyz;\n\n    return q;\n}\n\n//\xe8\x8e\xb7\xe5\x8f\x96\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b`BVH`\xe6\xa0\x91\xe8\x8a\x82\xe7\x82\xb9\xe6\x95\xb0\xe6\x8d\xae\xef\xbc\x8ci\xe4\xb8\xba\xe6\xa8\xa1\xe5\x9e\x8b\xe5\x86\x85\xe7\x9a\x84\xe7\xbb\x93\xe7\x82\xb9\xe7\xbc\x96\xe5\x8f\xb7\nBVHNode getBVH(in CustomizedModel model, int i) {\n    int offset = (model.nodeOffset + i) * 4;\n    BVHNode n;\n\n    n.AA = texelFetch(bvhTex, offset).xyz;\n    n.BB = texelFetch(bvhTex, offset + 1).xyz;\n    ivec3 tmp = ivec3(texelFetch(bvhTex, offset + 2).xyz);\n    n.l = tmp.x;\n    n.r = tmp.y;\n    tmp = ivec3(texelFetch(bvhTex, offset + 3).xyz);\n    n.n = tmp.x;\n    n.index = tmp.y;\n\n    return n;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad`AABB`\xe5\x8c\x85\xe5\x9b\xb4\xe7\x9b\x92\nfloat hitAABB(Ray r, vec3 AA, vec3 BB) {\n    vec3 M = (BB - r.startPoint) / r.direction;\n    vec3 N = (AA - r.startPoint) / r.direction;\n\n    vec3 tmax = max(M, N);\n    vec3 tmin = min(M, N);\n\n    float t1 = min(tmax.x, min(tmax.y, tmax.z));\n    float t2 = max(tmin.x, max(tmin.y, tmin.z));\n\n    return t1 >= t2 && t2 > ERR ? t2 : -1.0;\n}\n\n//\xe5\x85\x89\xe7\xba\xbf\xe6\x98\xaf\xe5\x90\xa6\xe5\x87\xbb\xe4\xb8\xad\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\nbool hitCustomizedModel(Ray r, in CustomizedModel model, inout HitInfo hit) {\n    int stack[8];\n    int p = 0;\n\n    stack[p++] = 0;\n    while (p > 0) {\n        int top = stack[--p];\n        BVHNode node = getBVH(model, top);\n\n        //\xe5\x8f\xb6\xe5\xad\x90\xe7\xbb\x93\xe7\x82\xb9\n        if (node.n > 0) {\n            int m = node.index;\n            int n = m + node.n;\n            for (int i = m; i < n; i++) {\n                Quad q = getPatch(model, i);\n                if (hitQuad(r, q, hit)) {\n                    hit.material = materials[model.material];\n                    hit.material.refractRate = 0.0; //\xe8\x87\xaa\xe5\xae\x9a\xe4\xb9\x89\xe6\xa8\xa1\xe5\x9e\x8b\xe4\xb8\x8d\xe6\x94\xaf\xe6\x8c\x81\xe9\x80\x8f\xe6\x98\x8e\xe6\x9d\x90\xe8\xb4\xa8\n                    //\xe7\xba\xb9\xe7\x90\x86\xe6\x98\xa0\xe5\xb0\x84\n                    if (USE_TEXTURE && model.useTexture) {\n                        vec2 tex = cylinderTexCoord(hit.hitPoint, model.center, model.height);\n                        //\xe6\x8c\x89\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe5\x88\xb0\xe4\xb8\xad\xe8\xbd\xb4\xe7\x9a\x84\xe8\xb7\x9d\xe7\xa6\xbb\xe8\xae\xa1\xe7\xae\x97\xe5\x91\xa8\xe9\x95\xbf\n                        float radius = max(length(hit.hitPoint.xz - model.center.xz), ERR);\n                        float size = sqrt(2.0 * PI * radius * model.height);\n                        vec3 color = sampleTexture(model.layer, model.uvTransform, tex, size, hit);\n                        hit.material.color = color;\n                    }\n                    return true;\n                }\n            }\n        }\n\n        //\xe4\xb8\x8e\xe5\xb7\xa6\xe5\x8f\xb3\xe7\x9b\x92\xe5\xad\x90\xe6\xb1\x82\xe4\xba\xa4\n        float t1 = -1.0, t2 = -1.0;\n        if (node.l >= 0) {\n            BVHNode l_node = getBVH(model, node.l);\n            t1 = hitAABB(r, l_node.AA, l_node.BB);\n        }\n        if (node.r >= 0) {\n            BVHNode r_node = getBVH(model, node.r);\n            t2 = hitAABB(r, r_node.AA, r_node.BB);\n        }\n\n        //\xe5\x9c\xa8\xe6\x9c\x80\xe8\xbf\x91\xe7\x9a\x84\xe7\x9b\x92\xe5\xad\x90\xe4\xb8\xad\xe6\x90\x9c\xe7\xb4\xa2\n        if (t1 > 0 && t2 > 0) {\n            if (t1 < t2) {\n                stack[p++] = node.r;\n                stack[p++] = node.l;\n            } else {\n                stack[p++] = node.l;\n                stack[p++] = node.r;\n            }\n        } else if (t1 > 0) {\n            stack[p++] = node.l;\n        } else if (t2 > 0) {\n            stack[p++] = node.r;\n        }\n    }\n\n    return false;\n}\n\n//\xe5\x87\xbb\xe4\xb8\xad\xe5\x88\xa4\xe6\x96\xad\nbool hitModel(Ray r, out HitInfo hit) {\n    hit.distance = INF;\n    bool ret = false;\n\n    for (int i = 0; i < cylinderNum; i++) {\n        ret = hitCylinderModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < quadNum; i++) {\n        ret = hitQuadModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < sphereNum; i++) {\n        ret = hitSphereModel(r, i, hit) || ret;\n    }\n    for (int i = 0; i < customizedNum; i++) {\n        ret = hitCustomizedModel(r, customized[i], hit) || ret;\n    }\n\n    return ret;\n}\n\n/*****************************************************\n * \xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xe7\x9a\x84\xe5\x8d\x95\xe6\xad\xa5\xe6\x93\x8d\xe4\xbd\x9c\xef\xbc\x9a\xe7\x89\x87\xe5\x85\x83\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe4\xb8\x8e\xe6\xb3\xa2\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe5\x85\xb1\xe7\x94\xa8\n *****************************************************/\n\n//\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\xad\xe5\xbf\x83\xe4\xbd\x8d\xe4\xba\x8eposition\xe7\x9a\x84\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x9a\xe8\xa7\x86\xe7\x82\xb9\xe6\x8c\x87\xe5\x90\x91\xe5\x83\x8f\xe7\xb4\xa0\xe7\x82\xb9\xef\xbc\x8c\xe5\x8a\xa0\xe5\x85\xa5\xe9\x9a\x8f\xe6\x9c\xba\xe5\x81\x8f\xe7\xa7\xbb\xe9\x87\x8f\xe4\xbb\xa5\xe6\x8a\x97\xe9\x94\xaf\xe9\xbd\xbf\xef\xbc\x8c\xe5\xb9\xb6\xe5\x88\x9d\xe5\xa7\x8b\xe5\x8c\x96\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\nRay cameraRay(vec3 position) {\n    Ray r;\n    r.startPoint = eyePos;\n    vec3 screen = position;\n    float d = rand(), th = rand() * (2.0 * PI);\n    screen.x += (d * sin(th) - 0.5) * (2.0 / width);\n    screen.y += (d * cos(th) - 0.5) * (2.0 / height);\n    r.direction = normalize(screen - eyePos);\n\n    //\xe5\x88\x9d\xe5\xa7\x8b\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xef\xbc\x9a\xe5\x9c\xa8\xe5\xb1\x8f\xe5\xb9\x95\xe5\xa4\x84\xe7\x9a\x84\xe5\xae\xbd\xe5\xba\xa6\xe4\xb8\xba\xe4\xb8\x80\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\n    coneWidth = 0.0;\n    coneSpread = 2.0 / (height * length(screen - eyePos));\n    return r;\n}\n\n//\xe6\xa0\xb9\xe6\x8d\xae\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe7\x9a\x84\xe6\x9d\x90\xe8\xb4\xa8\xe7\x94\x9f\xe6\x88\x90\xe7\xac\xac""depth\xe5\xb1\x82\xe7\x9a\x84\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe8\xbf\x94\xe5\x9b\x9e\xe5\x85\x89\xe7\xba\xbf\xe7\xb1\xbb\xe5\x9e\x8b\xef\xbc\x88""0\xe4\xb8\xba\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""1\xe4\xb8\xba\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xef\xbc\x8c""2\xe4\xb8\xba\xe6\x8a\x98\xe5\xb0\x84\xef\xbc\x89\xe4\xb8\x8e\xe6\xb7\xb7\xe5\x90\x88\xe6\x8c\x87\xe6\x95\xb0\nint scatter(inout Ray r, in HitInfo hit, int depth, out float tint) {\n    //\xe9\x9a\x8f\xe6\x9c\xba\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\n    vec3 oldRay = r.direction;\n    r.direction = depth == 0 ? sampleSobolHemisphere(hit.normal) : sampleHemisphere(hit.normal);\n//    r.direction = sampleHemisphere(hit.normal);\n    r.startPoint = hit.hitPoint;\n\n    //\xe6\xa0\xb9\xe6\x8d\xae\xe7\x89\xa9\xe4\xbd\x93\xe6\x9d\x90\xe8\xb4\xa8\xe5\x86\xb3\xe5\xae\x9a\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe7\x9a\x84\xe6\x96\xb9\xe5\x90\x91\n    float p = rand();\n    tint = 0.0;\n    if (p < hit.material.specularRate) {\n        //\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\n        vec3 ref = reflect(oldRay, hit.normal);\n        r.direction = normalize(mix(ref, r.direction, hit.material.specularRoughness));\n        tint = hit.material.specularTint;\n        coneSpread += hit.material.specularRoughness * CONE_ROUGH_SPREAD;\n        return 1;\n    } else if (USE_REFRACT && hit.material.specularRate <= p && p <= hit.material.specularRate + hit.material.refractRate) {\n        //\xe6\x8a\x98\xe5\xb0\x84\n        vec3 ref = refract(oldRay, hit.normal, 1.0 / hit.material.refractIndex);\n        r.direction = normalize(mix(ref, -r.direction, hit.material.refractRoughness));\n        tint = hit.material.refractTint;\n        coneSpread += hit.material.refractRoughness * CONE_ROUGH_SPREAD;\n        return 2;\n    }\n    //\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\n    coneSpread += CONE_DIFFUSE_SPREAD;\n    return 0;\n}\n\n//\xe6\x9c\xac\xe5\xb1\x82\xe5\xaf\xb9\xe4\xb8\x8b\xe4\xb8\x80\xe5\xb1\x82\xe9\xa2\x9c\xe8\x89\xb2\xe7\x9a\x84\xe7\xba\xbf\xe6\x80\xa7\xe5\x8f\x98\xe6\x8d\xa2\xef\xbc\x9a\xe6\xbc\xab\xe5\x8f\x8d\xe5\xb0\x84\xe9\x80\x90\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x98\xe4\xbb\xa5\xe9\xa2\x9c\xe8\x89\xb2\xef\xbc\x9b\xe9\x95\x9c\xe9\x9d\xa2\xe5\x8f\x8d\xe5\xb0\x84\xe4\xb8\x8e\xe6\x8a\x98\xe5\xb0\x84\xe5\x9c\xa8\xe9\xa2\x9c\xe8\x89\xb2\xe4\xb9\x98\xe4\xbb\xa5\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe4\xb8\x8e\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe4\xb9\x8b\xe9\x97\xb4\xe6\x8c\x89tint\xe6\x8f\x92\xe5\x80\xbc\xef\xbc\x8c\n//\xe5\x85\xa5\xe5\xb0\x84\xe5\x85\x89\xe5\xbc\xba\xe5\x8f\x96\xe5\x90\x84\xe9\x80\x9a\xe9\x81\x93\xe4\xb9\x8b\xe5\x92\x8c\xe9\x99\xa4\xe4\xbb\xa5sqrt(3)\xef\xbc\x8c\xe5\xaf\xb9\xe7\x99\xbd\xe5\x85\x89\xe4\xb8\x8e\xe5\x90\x91\xe9\x87\x8f\xe9\x95\xbf\xe5\xba\xa6\xe7\x9b\xb8\xe5\x90\x8c\xef\xbc\x8c\xe4\xbd\xbf\xe5\x8f\x98\xe6\x8d\xa2\xe4\xbf\x9d\xe6\x8c\x81\xe7\xba\xbf\xe6\x80\xa7\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x8f\xaf\xe6\xb2\xbf\xe8\xb7\xaf\xe5\xbe\x84\xe5\x90\x91\xe5\x89\x8d\xe7\xb4\xaf\xe4\xb9\x98\nmat3 transfer(vec3 color, float cosine, int type, float tint) {\n    float s = sqrt(cosine);\n    if (type == 0) return mat3(color.r * s, 0.0, 0.0, 0.0, color.g * s, 0.0, 0.0, 0.0, color.b * s);\n    return s * (outerProduct(color, vec3((1.0 - tint) / sqrt(3.0))) + mat3(tint));\n}\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe7\x9a\x84\xe4\xb8\x80\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xef\xbc\x9a\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe6\x97\xb6\xe5\xb0\x86\xe5\x85\xb6\xe8\xbe\x90\xe5\xb0\x84\xe4\xba\xae\xe5\xba\xa6\xe7\xbb\x8f\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe7\xb4\xaf\xe5\x8a\xa0\xe5\x88\xb0radiance\xe5\xb9\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\xef\xbc\x8c\xe5\x90\xa6\xe5\x88\x99\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\xb9\xb6\xe6\x9b\xb4\xe6\x96\xb0\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xef\xbc\x8c\n//\xe8\xa2\xab\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe6\x97\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\nbool bounce(inout Ray r, in HitInfo hit, int depth, inout mat3 throughput, inout vec3 radiance) {\n    //\xe5\x8f\x8d\xe4\xbc\xbd\xe9\xa9\xac\xe6\xa0\xa1\xe6\xad\xa3\n    vec3 color = pow(hit.material.color, vec3(2.2));\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe4\xbc\xa0\xe6\x92\xad\xe5\x88\xb0\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\n    coneWidth += coneSpread * hit.distance;\n\n    if (hit.material.lighting) {\n        radiance += throughput * (color * 2.0);\n        return false;\n    }\n\n    //\xe5\x85\x89\xe7\xba\xbf\xe4\xb8\x8e\xe5\x87\xbb\xe4\xb8\xad\xe7\x82\xb9\xe6\xb3\x95\xe7\x9f\xa2\xe9\x87\x8f\xe7\x9a\x84\xe5\xa4\xb9\xe8\xa7\x92\xe4\xbd\x99\xe5\xbc\xa6\xef\xbc\x8c\xe5\x9c\xa8\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xe5\x89\x8d\xe8\xae\xa1\xe7\xae\x97\n    float cosine = abs(dot(hit.normal, r.direction));\n    float tint;\n    int type = scatter(r, hit, depth, tint);\n    throughput *= transfer(color, cosine, type, tint);\n\n    //\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xef\xbc\x9a\xe6\x8c\x89\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\x86\xb3\xe5\xae\x9a\xe8\xb7\xaf\xe5\xbe\x84\xe6\x98\xaf\xe5\x90\xa6\xe7\xbb\xa7\xe7\xbb\xad\xef\xbc\x8c\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe8\xb6\x8a\xe5\xb0\x8f\xe8\xb6\x8a\xe5\x8f\xaf\xe8\x83\xbd\xe7\xbb\x93\xe6\x9d\x9f\xef\xbc\x9b\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe9\x99\xa4\xe4\xbb\xa5\xe5\xad\x98\xe6\xb4\xbb\xe6\xa6\x82\xe7\x8e\x87\xef\xbc\x8c\xe6\x9c\x9f\xe6\x9c\x9b\xe4\xb8\x8d\xe5\x8f\x98\n    if (depth + 1 >= rouletteDepth) {\n        vec3 response = throughput * vec3(1.0);\n        float survive = min(max(response.r, max(response.g, response.b)), 1.0);\n        if (rand() >= survive) return false;\n        throughput /= survive;\n    }\n    return true;\n}\n\n//\xe6\xb3\xa2\xe5\x89\x8d\xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\xbd\xe8\xb8\xaa\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\x80\xe6\x9d\xa1\xe8\xb7\xaf\xe5\xbe\x84\xef\xbc\x8c\xe6\x8c\x89\xe9\x98\xb6\xe6\xae\xb5\xe6\x8b\x86\xe5\x88\x86\xe4\xb8\xba\xe7\x94\x9f\xe6\x88\x90\xe3\x80\x81\xe6\xb1\x82\xe4\xba\xa4\xe3\x80\x81\xe7\x9d\x80\xe8\x89\xb2\xe4\xb8\x8e\xe7\xb4\xaf\xe7\xa7\xaf\xe5\x87\xa0\xe4\xb8\xaa\xe8\xae\xa1\xe7\xae\x97\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\n//\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe5\x9c\xa8\xe6\xaf\x8f\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xe5\x90\x8e\xe5\x8e\x8b\xe7\xbc\xa9\xe5\x88\xb0\xe5\x8f\xa6\xe4\xb8\x80\xe4\xb8\xaa\xe9\x98\x9f\xe5\x88\x97\xef\xbc\x8c\xe4\xb9\x8b\xe5\x90\x8e\xe7\x9a\x84\xe9\x98\xb6\xe6\xae\xb5\xe5\x8f\xaa\xe4\xb8\xba\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe5\x90\xaf\xe5\x8a\xa8\xe7\xba\xbf\xe7\xa8\x8b\n//\xe7\x94\xb1Wavefront\xe6\xb3\xa8\xe5\x85\xa5KERNEL_*\xe5\xae\x8f\xe9\x80\x89\xe6\x8b\xa9\xe9\x98\xb6\xe6\xae\xb5\xef\xbc\x8c\xe4\xb8\x8etracer.frag\xe5\x85\xb1\xe7\x94\xa8""common.glsl\xe4\xb8\xad\xe7\x9a\x84\xe5\x8d\x95\xe6\xad\xa5\xe6\x93\x8d\xe4\xbd\x9c\n\n#define GROUP_SIZE 64 //\xe4\xb8\x8ewavefront.h\xe4\xb8\x80\xe8\x87\xb4\nlayout (local_size_x = GROUP_SIZE) in;\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe7\x8a\xb6\xe6\x80\x81\xef\xbc\x9a\xe5\xbd\x93\xe5\x89\x8d\xe5\x85\x89\xe7\xba\xbf\xe3\x80\x81\xe5\x85\x89\xe7\xba\xbf\xe9\x94\xa5\xe3\x80\x81\xe9\x9a\x8f\xe6\x9c\xba\xe6\x95\xb0\xe7\x8a\xb6\xe6\x80\x81\xe3\x80\x81\xe5\xb7\xb2\xe5\x8f\x8d\xe5\xbc\xb9\xe7\x9a\x84\xe6\xac\xa1\xe6\x95\xb0\xef\xbc\x8c\xe4\xbb\xa5\xe5\x8f\x8a\xe7\xb4\xaf\xe4\xb9\x98\xe7\x9a\x84\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe4\xb8\x8e\xe7\xb4\xaf\xe5\x8a\xa0\xe7\x9a\x84\xe8\xbe\x90\xe5\xb0\x84\xe4\xba\xae\xe5\xba\xa6\nstruct Path {\n    vec3 startPoint;\n    float coneWidth;\n    vec3 direction;\n    float coneSpread;\n    uint seed;\n    uint pseed;\n    int gray;\n    int depth;\n    mat3 throughput;\n    vec3 radiance;\n};\n\nlayout (std430, binding = 5) buffer PathBuffer {\n    Path paths[];\n};\nlayout (std430, binding = 6) buffer HitBuffer {\n    HitInfo hits[];\n};\n\n//\xe4\xb8\xa4\xe4\xb8\xaa\xe8\xb7\xaf\xe5\xbe\x84\xe9\x98\x9f\xe5\x88\x97\xe4\xba\xa4\xe6\x9b\xbf\xe4\xbd\x9c\xe4\xb8\xba\xe8\xbe\x93\xe5\x85\xa5\xe4\xb8\x8e\xe8\xbe\x93\xe5\x87\xba\xef\xbc\x8c""dispatch\xe4\xb8\xba\xe6\x8c\x89\xe9\x98\x9f\xe5\x88\x97\xe9\x95\xbf\xe5\xba\xa6\xe8\xae\xa1\xe7\xae\x97\xe7\x9a\x84\xe9\x97\xb4\xe6\x8e\xa5\xe5\x90\xaf\xe5\x8a\xa8\xe5\x8f\x82\xe6\x95\xb0\nlayout (std430, binding = 7) buffer QueueBuffer {\n    uvec4 dispatch[2];\n    uint count[2];\n    uint queue[]; //\xe7\xac\xaci\xe4\xb8\xaa\xe9\x98\x9f\xe5\x88\x97\xe4\xbd\x8d\xe4\xba\x8ei * pathNum()\xe5\xbc\x80\xe5\xa7\x8b\n};\n\n//\xe6\x9c\xac\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xe7\x9a\x84\xe8\xbe\x93\xe5\x85\xa5\xe9\x98\x9f\xe5\x88\x97\nuniform int queueIn;\n\n//\xe7\xb4\xaf\xe7\xa7\xaf\xe7\xbb\x93\xe6\x9e\x9c\xef\xbc\x9a\xe4\xb8\x8e\xe7\x89\x87\xe5\x85\x83\xe7\x9d\x80\xe8\x89\xb2\xe5\x99\xa8\xe7\x9a\x84\xe5\xb8\xa7\xe7\xbc\x93\xe5\xad\x98\xe4\xb8\xba\xe5\x90\x8c\xe4\xb8\x80\xe7\xba\xb9\xe7\x90\x86\nlayout (rgba32f, binding = 0) uniform image2D accumulation;\n\n//\xe8\xb7\xaf\xe5\xbe\x84\xe6\x95\xb0\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\xe4\xb8\x80\xe6\x9d\xa1\nuint pathNum() {\n    return uint(width * height);\n}\n\nuint groups(uint n) {\n    return (n + GROUP_SIZE - 1u) / GROUP_SIZE;\n}\n\n//\xe5\xbd\x93\xe5\x89\x8d\xe7\xba\xbf\xe7\xa8\x8b\xe5\xa4\x84\xe7\x90\x86\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xef\xbc\x8c\xe8\xb6\x85\xe5\x87\xba\xe8\xbe\x93\xe5\x85\xa5\xe9\x98\x9f\xe5\x88\x97\xe9\x95\xbf\xe5\xba\xa6\xe6\x97\xb6\xe8\xbf\x94\xe5\x9b\x9e""false\nbool queuedPath(out uint p) {\n    uint i = gl_GlobalInvocationID.x;\n    if (i >= count[queueIn]) return false;\n    p = queue[uint(queueIn) * pathNum() + i];\n    return true;\n}\n\nvoid loadPath(uint p, out Ray r) {\n    r.startPoint = paths[p].startPoint;\n    r.direction = paths[p].direction;\n    coneWidth = paths[p].coneWidth;\n    coneSpread = paths[p].coneSpread;\n    seed = paths[p].seed;\n    pseed = paths[p].pseed;\n    gray = paths[p].gray;\n}\n\nvoid storePath(uint p, in Ray r) {\n    paths[p].startPoint = r.startPoint;\n    paths[p].direction = r.direction;\n    paths[p].coneWidth = coneWidth;\n    paths[p].coneSpread = coneSpread;\n    paths[p].seed = seed;\n    paths[p].pseed = pseed;\n}\n\n#if defined(KERNEL_GENERATE)\n//\xe7\x94\x9f\xe6\x88\x90\xef\xbc\x9a\xe6\xaf\x8f\xe4\xb8\xaa\xe5\x83\x8f\xe7\xb4\xa0\xe4\xbb\x8e\xe8\xa7\x86\xe7\x82\xb9\xe5\x8f\x91\xe5\x87\xba\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe6\x89\x80\xe6\x9c\x89\xe8\xb7\xaf\xe5\xbe\x84\xe8\xbf\x9b\xe5\x85\xa5""0\xe5\x8f\xb7\xe9\x98\x9f\xe5\x88\x97\nvoid main() {\n    uint p = gl_GlobalInvocationID.x;\n    if (p == 0u) {\n        count[0] = pathNum();\n        count[1] = 0u;\n        dispatch[0] = uvec4(groups(pathNum()), 1u, 1u, 0u);\n    }\n    if (p >= pathNum()) return;\n\n    uvec2 coord = uvec2(p % uint(width), p / uint(width));\n    beginSample(coord, frame);\n    vec3 position = vec3((vec2(coord) + 0.5) / vec2(width, height) * 2.0 - 1.0, 0.0);\n    Ray r = cameraRay(position);\n    storePath(p, r);\n    paths[p].gray = gray;\n    paths[p].depth = 0;\n    paths[p].throughput = mat3(1.0);\n    paths[p].radiance = vec3(0.0);\n    queue[p] = p;\n}\n#elif defined(KERNEL_EXTEND)\n//\xe6\xb1\x82\xe4\xba\xa4\xef\xbc\x9a\xe9\x98\x9f\xe5\x88\x97\xe4\xb8\xad\xe7\x9a\x84\xe6\xaf\x8f\xe6\x9d\xa1\xe8\xb7\xaf\xe5\xbe\x84\xe6\xb1\x82\xe6\x9c\x80\xe8\xbf\x91\xe4\xba\xa4\xe7\x82\xb9\xef\xbc\x8c\xe6\x9c\xaa\xe5\x87\xbb\xe4\xb8\xad\xe6\x97\xb6\xe8\xb7\x9d\xe7\xa6\xbb\xe4\xb8\xbaINF\nvoid main() {\n    uint p;\n    if (!queuedPath(p)) return;\n    Ray r;\n    loadPath(p, r);\n    HitInfo hit;\n    hitModel(r, hit);\n    hits[p] = hit;\n}\n#elif defined(KERNEL_SHADE)\n//\xe7\x9d\x80\xe8\x89\xb2\xef\xbc\x9a\xe6\x9b\xb4\xe6\x96\xb0\xe5\x90\x9e\xe5\x90\x90\xe9\x87\x8f\xe5\xb9\xb6\xe7\x94\x9f\xe6\x88\x90\xe4\xb8\x8b\xe4\xb8\x80\xe6\x9d\xa1\xe5\x85\x89\xe7\xba\xbf\xef\xbc\x8c\xe5\xad\x98\xe6\xb4\xbb\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe5\x8e\x8b\xe7\xbc\xa9\xe5\x88\xb0\xe8\xbe\x93\xe5\x87\xba\xe9\x98\x9f\xe5\x88\x97\nvoid main() {\n    uint p;\n    if (!queuedPath(p)) return;\n    Ray r;\n    loadPath(p, r);\n    HitInfo hit = hits[p];\n    int depth = paths[p].depth;\n    mat3 throughput = paths[p].throughput;\n    vec3 radiance = paths[p].radiance;\n\n    //\xe6\x9c\xaa\xe5\x87\xbb\xe4\xb8\xad\xe3\x80\x81\xe5\x87\xbb\xe4\xb8\xad\xe5\x85\x89\xe6\xba\x90\xe3\x80\x81\xe8\xa2\xab\xe4\xbf\x84\xe7\xbd\x97\xe6\x96\xaf\xe8\xbd\xae\xe7\x9b\x98\xe7\xbb\x93\xe6\x9d\x9f\xe6\x88\x96\xe8\xbe\xbe\xe5\x88\xb0\xe6\x9c\x80\xe5\xa4\xa7\xe5\x8f\x8d\xe5\xbc\xb9\xe6\xac\xa1\xe6\x95\xb0\xe6\x97\xb6\xe7\xbb\x93\xe6\x9d\x9f\xef\xbc\x8c\xe7\xbb\x93\xe6\x9d\x9f\xe7\x9a\x84\xe8\xb7\xaf\xe5\xbe\x84\xe5\x8f\xaa\xe4\xbf\x9d\xe7\x95\x99\xe8\xbe\x90\xe5\xb0\x84\xe4\xba\xae\xe5\xba\xa6\n    bool alive = hit.distance < INF && bounce(r, hit, depth, throughput, radiance) && depth + 1 < maxDepth;\n    if (!alive) {\n        paths[p].radiance = radiance;\n        return;\n    }\n\n    storePath(p, r);\n    paths[p].depth = depth + 1;\n    paths[p].throughput = throughput;\n    uint out_queue = 1u - uint(queueIn);\n    queue[out_queue * pathNum() + atomicAdd(count[out_queue], 1u)] = p;\n}\n#elif defined(KERNEL_PREPARE)\n//\xe5\x87\x86\xe5\xa4\x87\xe4\xb8\x8b\xe4\xb8\x80\xe6\xac\xa1\xe5\x8f\x8d\xe5\xbc\xb9\xef\xbc\x9a\xe6\x8c\x89\xe8\xbe\x93\xe5\x87\xba\xe9\x98\x9f\xe5\x88\x97\xe7\x9a\x84\xe9\x95\xbf\xe5\xba\xa6\xe8\xae\xbe\xe7\xbd\xae\xe5\x90\xaf\xe5\x8a\xa8\xe5\x8f\x82\xe6\x95\xb0\xef\xbc\x8c\xe5\xb9\xb6\xe6\xb8\x85\xe7\xa9\xba\xe8\xbe\x93\xe5\x85\xa5\xe9\x98\x9f\xe5\x88\x97\nvoid main() {\n    if (gl_GlobalInvocationID.x != 0u) return;\n    uint out_queue = 1u - uint(queueIn);\n    dispatch[out_queue] = uvec4(groups(count[out_queue]), 1u, 1u, 0u);\n    count[queueIn] = 0u;\n}\n#elif defined(KERNEL_ACCUMULATE)\n//\xe7\xb4\xaf\xe7\xa7\xaf\xef\xbc\x9a\xe6\x89\x80\xe6\x9c\x89\xe8\xb7\xaf\xe5\xbe\x84\xe7\xbb\x93\xe6\x9d\x9f\xe5\x90\x8e\xef\xbc\x8c\xe5\xb0\x86\xe6\x9c\xac\xe6\xa0\xb7\xe6\x9c\xac\xe7\x9a\x84\xe7\xbb\x93\xe6\x9e\x9c\xe5\x8a\xa0\xe5\x88\xb0\xe7\xb4\xaf\xe7\xa7\xaf\xe7\xba\xb9\xe7\x90\x86\nvoid main() {\n    uint p = gl_GlobalInvocationID.x;\n    if (p >= pathNum()) return;\n    ivec2 coord = ivec2(p % uint(width), p / uint(width));\n    vec4 color = imageLoad(accumulation, coord);\n    imageStore(accumulation, coord, vec4(color.xyz + paths[p].radiance * (2.0 * PI), color.w));\n}\n#endif\n"
@@ -0,0 +1,135 @@
+/********************************************
+ * 此文件定义了八通道浮点数及三维向量的SoA批量运算
+ * 具体实现取决于编译时的指令集，因此只能在simd/kernel_impl.h中
+ * 被包含于各指令集的命名空间内，不得在其他位置包含
+ * 依赖的intrinsics头文件需在命名空间外预先包含
+ *******************************************/
+
+#pragma once
+
+/*****************************************************
+ * 八通道浮点数：启用AVX时使用256位寄存器，否则由两个128位寄存器组成
+ *****************************************************/
+
+struct Floatx8 {
+#ifdef __AVX__
+    __m256 v;
+
+    Floatx8() = default;
+    Floatx8(__m256 v): v(v) {}
+    Floatx8(GLfloat f): v(_mm256_set1_ps(f)) {}
+
+    static Floatx8 load(const GLfloat *p) {return _mm256_loadu_ps(p);}
+    void store(GLfloat *p) const {_mm256_storeu_ps(p, v);}
+#else
+    __m128 lo, hi;
+
+    Floatx8() = default;
+    Floatx8(__m128 lo, __m128 hi): lo(lo), hi(hi) {}
+    Floatx8(GLfloat f): lo(_mm_set1_ps(f)), hi(_mm_set1_ps(f)) {}
+
+    static Floatx8 load(const GLfloat *p) {return {_mm_loadu_ps(p), _mm_loadu_ps(p + 4)};}
+    void store(GLfloat *p) const {_mm_storeu_ps(p, lo); _mm_storeu_ps(p + 4, hi);}
+#endif
+};
+
+#ifdef __AVX__
+#define FLOATX8_OP(name, op256, op128) \
+    inline Floatx8 name(const Floatx8 &a, const Floatx8 &b) {return op256(a.v, b.v);}
+#define FLOATX8_CMP(name, imm, op128) \
+    inline Floatx8 name(const Floatx8 &a, const Floatx8 &b) {return _mm256_cmp_ps(a.v, b.v, imm);}
+#else
+#define FLOATX8_OP(name, op256, op128) \
+    inline Floatx8 name(const Floatx8 &a, const Floatx8 &b) {return {op128(a.lo, b.lo), op128(a.hi, b.hi)};}
+#define FLOATX8_CMP(name, imm, op128) FLOATX8_OP(name, , op128)
+#endif
+
+FLOATX8_OP(operator+, _mm256_add_ps, _mm_add_ps)
+FLOATX8_OP(operator-, _mm256_sub_ps, _mm_sub_ps)
+FLOATX8_OP(operator*, _mm256_mul_ps, _mm_mul_ps)
+FLOATX8_OP(operator/, _mm256_div_ps, _mm_div_ps)
+FLOATX8_OP(min, _mm256_min_ps, _mm_min_ps)
+FLOATX8_OP(max, _mm256_max_ps, _mm_max_ps)
+//掩码运算：比较结果的每个通道为全1或全0
+FLOATX8_OP(operator&, _mm256_and_ps, _mm_and_ps)
+FLOATX8_OP(operator|, _mm256_or_ps, _mm_or_ps)
+FLOATX8_OP(andNot, _mm256_andnot_ps, _mm_andnot_ps)
+FLOATX8_CMP(operator<, _CMP_LT_OQ, _mm_cmplt_ps)
+FLOATX8_CMP(operator<=, _CMP_LE_OQ, _mm_cmple_ps)
+FLOATX8_CMP(operator>, _CMP_GT_OQ, _mm_cmpgt_ps)
+FLOATX8_CMP(operator>=, _CMP_GE_OQ, _mm_cmpge_ps)
+
+#undef FLOATX8_OP
+#undef FLOATX8_CMP
+
+inline Floatx8 sqrt(const Floatx8 &a) {
+#ifdef __AVX__
+    return _mm256_sqrt_ps(a.v);
+#else
+    return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)};
+#endif
+}
+
+inline Floatx8 abs(const Floatx8 &a) {
+    return andNot(Floatx8(-0.0f), a);
+}
+
+//按掩码选择：掩码为真的通道取a，否则取b
+inline Floatx8 select(const Floatx8 &mask, const Floatx8 &a, const Floatx8 &b) {
+#ifdef __AVX__
+    return _mm256_blendv_ps(b.v, a.v, mask.v);
+#else
+    return {_mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)),
+            _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi))};
+#endif
+}
+
+//掩码的各通道符号位组成的整数
+inline int movemask(const Floatx8 &mask) {
+#ifdef __AVX__
+    return _mm256_movemask_ps(mask.v);
+#else
+    return _mm_movemask_ps(mask.lo) | _mm_movemask_ps(mask.hi) << 4;
+#endif
+}
+
+struct Vector3fx8 {
+    Floatx8 x, y, z;
+
+    Vector3fx8() = default;
+    Vector3fx8(const Floatx8 &x, const Floatx8 &y, const Floatx8 &z): x(x), y(y), z(z) {}
+    explicit Vector3fx8(const Vector3f &v): x(v.x), y(v.y), z(v.z) {}
+};
+
+inline Vector3fx8 operator+(const Vector3fx8 &a, const Vector3fx8 &b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline Vector3fx8 operator-(const Vector3fx8 &a, const Vector3fx8 &b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline Vector3fx8 operator*(const Vector3fx8 &a, const Floatx8 &b) {
+    return {a.x * b, a.y * b, a.z * b};
+}
+
+//点积
+inline Floatx8 operator*(const Vector3fx8 &a, const Vector3fx8 &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//叉积
+inline Vector3fx8 operator&(const Vector3fx8 &a, const Vector3fx8 &b) {
+    return {a.y * b.z - a.z * b.y,
+            a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x};
+}
+
+inline Floatx8 length(const Vector3fx8 &a) {
+    return sqrt(a * a);
+}
+
+inline Vector3fx8 normalize(const Vector3fx8 &a) {
+    Floatx8 len = length(a);
+    return {a.x / len, a.y / len, a.z / len};
+}
@@ -0,0 +1,194 @@
+#include "kernel.h"
+#include "simd.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+//各指令集的实现，按从高到低排列
+static const KernelTable *const tables[] = {&avx512::table, &avx2::table, &sse4::table};
+
+static bool supports(const KernelTable *table) {
+    __builtin_cpu_init();
+    if (table == &avx512::table) return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+    if (table == &avx2::table) return __builtin_cpu_supports("avx2");
+    return __builtin_cpu_supports("sse4.1");
+}
+
+//按CPU特性选择可用的最高指令集，SSE4为最低要求
+static const KernelTable *detectKernel() {
+    for (auto table : tables)
+        if (supports(table)) return table;
+    return &sse4::table;
+}
+
+static const KernelTable *kernel = detectKernel();
+
+const char *kernelISA() {
+    return kernel->isa;
+}
+
+bool setKernelISA(const char *isa) {
+    for (auto table : tables) {
+        if (strcmp(isa, table->isa) != 0) continue;
+        if (!supports(table)) return false;
+        kernel = table;
+        return true;
+    }
+    return false;
+}
+
+void RayBatch::set(const Ray *rays, int n) {
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        const Ray &r = rays[i < n ? i : n - 1];
+        ox[i] = r.startPoint.x;
+        oy[i] = r.startPoint.y;
+        oz[i] = r.startPoint.z;
+        dx[i] = r.direction.x;
+        dy[i] = r.direction.y;
+        dz[i] = r.direction.z;
+    }
+}
+
+void HitBatch::clear() {
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        distance[i] = INF;
+        nx[i] = ny[i] = nz[i] = 0.0f;
+    }
+}
+
+void QuadBlock::set(const Patch *patches, int num) {
+    n = num;
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        const Vector3f *samples = patches[i < num ? i : num - 1].samples;
+        //与hitQuad中的计算方式一致
+        Vector3f e1 = samples[1] - samples[0];
+        Vector3f e2 = samples[2] - samples[0];
+        Vector3f nor = normalize(e1 & e2);
+        const Vector3f *v[] = {&samples[0], &samples[1], &samples[2], &e1, &e2, &nor};
+        GLfloat (*dst[])[KERNEL_WIDTH] = {s0, s1, s2, n1, n2, normal};
+        for (int k = 0; k < 6; k++) {
+            dst[k][0][i] = v[k]->x;
+            dst[k][1][i] = v[k]->y;
+            dst[k][2][i] = v[k]->z;
+        }
+        d[i] = -(samples[0] * nor);
+    }
+}
+
+
+int hitQuad8(const RayBatch &r, const Vector3f *samples, HitBatch &hit) {
+    return kernel->quad8(r, samples, hit);
+}
+
+int hitSphere8(const RayBatch &r, const Vector3f &center, GLfloat radius, HitBatch &hit) {
+    return kernel->sphere8(r, center, radius, hit);
+}
+
+int hitCylinder8(const RayBatch &r, const Vector3f &center, GLfloat radius, GLfloat height, HitBatch &hit) {
+    return kernel->cylinder8(r, center, radius, height, hit);
+}
+
+bool hitQuadBlock(const Ray &r, const QuadBlock &block, HitInfo &hit) {
+    return kernel->quadBlock(r, block, hit);
+}
+
+int hitQuad4(const RayPacket &p, const Vector3f *samples, int index, __m128 &t, __m128i &idx) {
+    return kernel->quad4(p, samples, index, t, idx);
+}
+
+bool hitBVH(const LinearNode *list, const Patch *patches, const Ray &r, HitInfo &hit) {
+    return kernel->bvh(list, patches, r, hit);
+}
+
+bool hitBVHBlocks(const LinearNode *list, const QuadBlock *blocks, const Ray &r, HitInfo &hit) {
+    return kernel->bvhBlocks(list, blocks, r, hit);
+}
+
+int hitBVH4(const LinearNode *list, const Patch *patches, const RayPacket &p, __m128 &t, __m128i &idx) {
+    return kernel->bvh4(list, patches, p, t, idx);
+}
+
+void benchmarkKernels() {
+    const int batches = 1 << 14, rounds = 64;
+    std::mt19937 gen(2023);
+    std::uniform_real_distribution<GLfloat> dis(-1.0f, 1.0f);
+
+    //从视点射向屏幕的随机光线
+    std::vector<RayBatch> rays(batches);
+    const Vector3f eye = {0.0f, 0.0f, 4.0f};
+    for (auto &batch : rays) {
+        Ray r[KERNEL_WIDTH];
+        for (auto &ray : r) ray = {normalize(Vector3f{dis(gen), dis(gen), 0.0f} - eye), eye};
+        batch.set(r, KERNEL_WIDTH);
+    }
+
+    auto run = [&](const char *name, int (*kernel)(const RayBatch &, HitBatch &)) {
+        HitBatch hit{};
+        long long hits = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int k = 0; k < rounds; k++) {
+            for (auto &batch : rays) {
+                hit.clear();
+                hits += __builtin_popcount(kernel(batch, hit));
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        double rate = (double)batches * rounds * KERNEL_WIDTH / sec;
+        std::cout << name << ": " << rate / 1e6 << " M intersections/s, hit rate "
+                  << (double)hits / ((double)batches * rounds * KERNEL_WIDTH) << std::endl;
+    };
+
+    std::cout << "kernel isa: " << kernelISA() << ", width: " << KERNEL_WIDTH << std::endl;
+    run("quad", [](const RayBatch &r, HitBatch &h) {
+        static const Vector3f s[4] = {{-1.0f, 1.0f, -2.0f}, {-1.0f, -1.0f, -2.0f},
+                                      {1.0f, 1.0f, -2.0f}, {1.0f, -1.0f, -2.0f}};
+        return hitQuad8(r, s, h);
+    });
+    run("sphere", [](const RayBatch &r, HitBatch &h) {
+        return hitSphere8(r, {0.6f, -0.1f, -0.7f}, 0.25f, h);
+    });
+    run("cylinder", [](const RayBatch &r, HitBatch &h) {
+        return hitCylinder8(r, {0.6f, -1.0f, -0.7f}, 0.15f, 0.65f, h);
+    });
+
+    //单条光线与一个叶子中的八个四边形求交：逐个求交与SoA块求交
+    Patch leaf[KERNEL_WIDTH];
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        GLfloat x = -1.0f + 0.5f * GLfloat(i % 4), y = i < 4 ? 1.0f : 0.0f;
+        leaf[i].samples[0] = {x, y, -2.0f};
+        leaf[i].samples[1] = {x, y - 1.0f, -2.0f};
+        leaf[i].samples[2] = {x + 0.5f, y, -2.0f};
+        leaf[i].samples[3] = {x + 0.5f, y - 1.0f, -2.0f};
+    }
+    QuadBlock block{};
+    block.set(leaf, KERNEL_WIDTH);
+    std::vector<Ray> single(batches);
+    for (auto &ray : single) ray = {normalize(Vector3f{dis(gen), dis(gen), 0.0f} - eye), eye};
+
+    auto runLeaf = [&](const char *name, bool (*kernel)(const Ray &, const Patch *, const QuadBlock &, HitInfo &)) {
+        long long hits = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int k = 0; k < rounds; k++) {
+            for (auto &ray : single) {
+                HitInfo hit{};
+                hit.distance = INF;
+                hits += kernel(ray, leaf, block, hit);
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        double rate = (double)batches * rounds / sec;
+        std::cout << name << ": " << rate / 1e6 << " M rays/s, hit rate "
+                  << (double)hits / ((double)batches * rounds) << std::endl;
+    };
+
+    runLeaf("leaf (scalar)", [](const Ray &r, const Patch *p, const QuadBlock &, HitInfo &h) {
+        bool ret = false;
+        for (int i = 0; i < KERNEL_WIDTH; i++) ret = hitQuad(r, p[i].samples, h) || ret;
+        return ret;
+    });
+    runLeaf("leaf (block)", [](const Ray &r, const Patch *, const QuadBlock &b, HitInfo &h) {
+        return hitQuadBlock(r, b, h);
+    });
+}
@@ -0,0 +1,82 @@
+/********************************************
+ * 此文件定义了CPU端八路光线的求交核函数
+ * 求交公式及运算顺序与tracer.frag中的同名函数一致
+ * 核函数与BVH遍历按多种指令集分别编译，启动时根据CPU特性选择
+ *******************************************/
+
+#pragma once
+
+#include "config/config.h"
+
+#define KERNEL_WIDTH 8
+
+struct LinearNode; //见bvh/bvh.h
+struct RayPacket;  //见simd/simd.h
+
+//八条光线（SoA布局）
+struct RayBatch {
+    GLfloat ox[KERNEL_WIDTH], oy[KERNEL_WIDTH], oz[KERNEL_WIDTH]; //起点
+    GLfloat dx[KERNEL_WIDTH], dy[KERNEL_WIDTH], dz[KERNEL_WIDTH]; //方向
+
+    //由AoS布局的光线填充，不足八条时以最后一条补齐
+    void set(const Ray *rays, int n);
+};
+
+//八条光线的击中信息（SoA布局），distance初始应为INF
+struct HitBatch {
+    GLfloat distance[KERNEL_WIDTH];
+    GLfloat nx[KERNEL_WIDTH], ny[KERNEL_WIDTH], nz[KERNEL_WIDTH]; //命中点法线
+
+    void clear();
+};
+
+//BVH叶子中至多八个四边形（SoA布局），预先计算好求交所需的边向量、法线与平面常数
+struct QuadBlock {
+    GLfloat s0[3][KERNEL_WIDTH], s1[3][KERNEL_WIDTH], s2[3][KERNEL_WIDTH]; //前三个顶点
+    GLfloat n1[3][KERNEL_WIDTH], n2[3][KERNEL_WIDTH];                      //边向量
+    GLfloat normal[3][KERNEL_WIDTH];
+    GLfloat d[KERNEL_WIDTH];
+    int n;
+
+    //由连续的n个面片填充，不足八个时以最后一个补齐
+    void set(const Patch *patches, int n);
+};
+
+//以下函数仅更新交点比已有记录更近的光线，返回被更新的光线掩码
+int hitQuad8(const RayBatch &r, const Vector3f *samples, HitBatch &hit);
+int hitSphere8(const RayBatch &r, const Vector3f &center, GLfloat radius, HitBatch &hit);
+int hitCylinder8(const RayBatch &r, const Vector3f &center, GLfloat radius, GLfloat height, HitBatch &hit);
+
+//单条光线与一组四边形求交，按面片顺序依次更新hit，结果与逐个调用hitQuad一致
+bool hitQuadBlock(const Ray &r, const QuadBlock &block, HitInfo &hit);
+
+//BVH树的遍历同样按指令集编译，接口与用法见BVH::hit、BVH::hitBlocks与BVH::hit4
+bool hitBVH(const LinearNode *list, const Patch *patches, const Ray &r, HitInfo &hit);
+bool hitBVHBlocks(const LinearNode *list, const QuadBlock *blocks, const Ray &r, HitInfo &hit);
+int hitBVH4(const LinearNode *list, const Patch *patches, const RayPacket &p, __m128 &t, __m128i &idx);
+
+//一种指令集下编译的全部核函数
+struct KernelTable {
+    const char *isa;
+    int (*quad8)(const RayBatch &, const Vector3f *, HitBatch &);
+    int (*sphere8)(const RayBatch &, const Vector3f &, GLfloat, HitBatch &);
+    int (*cylinder8)(const RayBatch &, const Vector3f &, GLfloat, GLfloat, HitBatch &);
+    bool (*quadBlock)(const Ray &, const QuadBlock &, HitInfo &);
+    int (*quad4)(const RayPacket &, const Vector3f *, int, __m128 &, __m128i &);
+    bool (*bvh)(const LinearNode *, const Patch *, const Ray &, HitInfo &);
+    bool (*bvhBlocks)(const LinearNode *, const QuadBlock *, const Ray &, HitInfo &);
+    int (*bvh4)(const LinearNode *, const Patch *, const RayPacket &, __m128 &, __m128i &);
+};
+
+//各指令集的实现，见simd/kernel_*.cpp
+namespace sse4 {extern const KernelTable table;}
+namespace avx2 {extern const KernelTable table;}
+namespace avx512 {extern const KernelTable table;}
+
+//当前使用的指令集名称，默认为CPU支持的最高指令集
+const char *kernelISA();
+//指定使用的指令集（sse4、avx2、avx512），名称无效或CPU不支持时返回false
+bool setKernelISA(const char *isa);
+
+//求交核函数的性能测试，输出每秒求交次数
+void benchmarkKernels();
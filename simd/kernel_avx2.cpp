@@ -0,0 +1,3 @@
+//AVX2版本的求交核函数，编译选项见CMakeLists.txt
+#define KERNEL_ISA avx2
+#include "kernel_impl.h"
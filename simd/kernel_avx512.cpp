@@ -0,0 +1,3 @@
+//AVX-512（AVX512F与AVX512VL）版本的求交核函数，编译选项见CMakeLists.txt
+#define KERNEL_ISA avx512
+#include "kernel_impl.h"
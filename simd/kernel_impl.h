@@ -0,0 +1,457 @@
+/********************************************
+ * 此文件是CPU端求交核函数与BVH遍历的实现，由simd/kernel_*.cpp以不同的指令集选项分别编译
+ * 包含前需定义KERNEL_ISA为命名空间名，所有依赖编译指令集的代码都位于该命名空间内，
+ * 且不调用config/vecmath.h中的内联函数，以免不同指令集的同名函数在链接时混用
+ *******************************************/
+
+#include <immintrin.h>
+
+#include "kernel.h"
+#include "simd.h"
+#include "bvh/bvh.h"
+
+#ifndef KERNEL_ISA
+#error "KERNEL_ISA must be defined before including kernel_impl.h"
+#endif
+
+#define KERNEL_STR(x) KERNEL_STR_(x)
+#define KERNEL_STR_(x) #x
+
+namespace KERNEL_ISA {
+
+#include "floatx8.h"
+
+//光线与击中信息的SoA读写
+struct RayLanes {
+    Vector3fx8 o, d;
+
+    explicit RayLanes(const RayBatch &r):
+            o(Floatx8::load(r.ox), Floatx8::load(r.oy), Floatx8::load(r.oz)),
+            d(Floatx8::load(r.dx), Floatx8::load(r.dy), Floatx8::load(r.dz)) {}
+};
+
+static Vector3fx8 load3(const GLfloat (&v)[3][KERNEL_WIDTH]) {
+    return {Floatx8::load(v[0]), Floatx8::load(v[1]), Floatx8::load(v[2])};
+}
+
+//将mask为真的通道写入击中信息
+static int writeHits(HitBatch &hit, const Floatx8 &mask, const Floatx8 &t, const Vector3fx8 &normal) {
+    int bits = movemask(mask);
+    if (bits == 0) return 0;
+    select(mask, t, Floatx8::load(hit.distance)).store(hit.distance);
+    select(mask, normal.x, Floatx8::load(hit.nx)).store(hit.nx);
+    select(mask, normal.y, Floatx8::load(hit.ny)).store(hit.ny);
+    select(mask, normal.z, Floatx8::load(hit.nz)).store(hit.nz);
+    return bits;
+}
+
+static bool hitQuadBlock(const Ray &r, const QuadBlock &block, HitInfo &hit) {
+    Vector3fx8 O(r.startPoint), D(r.direction);
+
+    //求光线与各平面交点
+    Vector3fx8 N = load3(block.normal);
+    Floatx8 m = D * N;
+    Floatx8 mask = m < Floatx8(-ERR); //剔除背向面
+    Floatx8 t = (Floatx8(0.0f) - (Floatx8::load(block.d) + O * N)) / m;
+    mask = mask & (t > Floatx8(ERR)); //剔除与自身相交的情况
+    int bits = movemask(mask) & ((1 << block.n) - 1);
+    if (bits == 0) return false;
+    Vector3fx8 P = O + D * t;
+
+    //根据叉乘与法矢量的方向关系判断是否在四边形内
+    Vector3fx8 n1 = load3(block.n1), n2 = load3(block.n2);
+    Vector3fx8 n3 = P - load3(block.s0);
+    Vector3fx8 n4 = P - load3(block.s1);
+    Vector3fx8 n5 = P - load3(block.s2);
+    Floatx8 f1 = (n1 & n3) * N;
+    Floatx8 f2 = (n3 & n2) * N;
+    Floatx8 f3 = (n5 & n1) * N;
+    Floatx8 f4 = (n2 & n4) * N;
+    Floatx8 nerr(-ERR);
+    bits &= movemask((f1 > nerr) & (f2 > nerr) & (f3 > nerr) & (f4 > nerr));
+    if (bits == 0) return false;
+
+    //按面片顺序比较距离，保证与逐个求交的结果一致
+    GLfloat dist[KERNEL_WIDTH];
+    t.store(dist);
+    bool ret = false;
+    for (; bits != 0; bits &= bits - 1) {
+        int i = __builtin_ctz(bits);
+        if (dist[i] >= hit.distance - ERR) continue;
+        hit.distance = dist[i];
+        hit.hitPoint = {r.startPoint.x + r.direction.x * dist[i],
+                        r.startPoint.y + r.direction.y * dist[i],
+                        r.startPoint.z + r.direction.z * dist[i]};
+        hit.normal = {block.normal[0][i], block.normal[1][i], block.normal[2][i]};
+        ret = true;
+    }
+    return ret;
+}
+
+static int hitQuad8(const RayBatch &r, const Vector3f *samples, HitBatch &hit) {
+    RayLanes ray(r);
+    Floatx8 dist = Floatx8::load(hit.distance);
+
+    //求光线与平面交点，面片参数在各通道上重复计算
+    Vector3fx8 s0(samples[0]), s1(samples[1]), s2(samples[2]);
+    Vector3fx8 n1 = s1 - s0;
+    Vector3fx8 n2 = s2 - s0;
+    Vector3fx8 N = normalize(n1 & n2);
+    Floatx8 d = Floatx8(0.0f) - s0 * N;
+    Floatx8 m = ray.d * N;
+    Floatx8 mask = m < Floatx8(-ERR); //剔除背向面
+    Floatx8 t = (Floatx8(0.0f) - (d + ray.o * N)) / m;
+    mask = mask & (t > Floatx8(ERR)); //剔除与自身相交的情况
+    if (movemask(mask) == 0) return 0;
+    Vector3fx8 P = ray.o + ray.d * t;
+
+    //根据叉乘与法矢量的方向关系判断是否在四边形内
+    Vector3fx8 n3 = P - s0;
+    Vector3fx8 n4 = P - s1;
+    Vector3fx8 n5 = P - s2;
+    Floatx8 f1 = (n1 & n3) * N;
+    Floatx8 f2 = (n3 & n2) * N;
+    Floatx8 f3 = (n5 & n1) * N;
+    Floatx8 f4 = (n2 & n4) * N;
+    Floatx8 nerr(-ERR);
+    mask = mask & (f1 > nerr) & (f2 > nerr) & (f3 > nerr) & (f4 > nerr);
+    mask = mask & (t < dist - Floatx8(ERR));
+
+    return writeHits(hit, mask, t, N);
+}
+
+static int hitSphere8(const RayBatch &r, const Vector3f &center, GLfloat radius, HitBatch &hit) {
+    RayLanes ray(r);
+    Floatx8 dist = Floatx8::load(hit.distance);
+    Vector3fx8 C(center);
+    Floatx8 R(radius);
+
+    //计算光线与球心距离，距离大于半径则不相交
+    Floatx8 t = (C - ray.o) * ray.d;
+    Vector3fx8 T = ray.o + ray.d * t;
+    Vector3fx8 CP = T - C;
+    Floatx8 l_CP = length(CP);
+    Floatx8 mask = l_CP <= R;
+    if (movemask(mask) == 0) return 0;
+
+    //计算交点，判断是哪个交点，并剔除与自身相交的情况
+    Floatx8 delta = sqrt(R * R - l_CP * l_CP);
+    Floatx8 t1 = t - delta;
+    Floatx8 t2 = t + delta;
+    Floatx8 err(ERR);
+    t = select(t1 > err, t1, t2);
+    mask = mask & (t > err);
+
+    //存在遮挡
+    mask = mask & (t < dist - err);
+
+    Vector3fx8 P = ray.o + ray.d * t;
+    return writeHits(hit, mask, t, normalize(P - C));
+}
+
+static int hitCylinder8(const RayBatch &r, const Vector3f &center, GLfloat radius, GLfloat height, HitBatch &hit) {
+    RayLanes ray(r);
+    Floatx8 dist = Floatx8::load(hit.distance);
+    Floatx8 err(ERR), R(radius), zero(0.0f);
+    Floatx8 bottom(center.y), top(center.y + height);
+
+    //计算光线到中轴的最短距离
+    Floatx8 SFx = Floatx8(center.x) - ray.o.x, SFy = Floatx8(center.z) - ray.o.z;
+    Floatx8 dx = ray.d.x, dy = ray.d.z;
+    Floatx8 l_dST = sqrt(dx * dx + dy * dy);
+    Floatx8 l_FT = abs(SFy * dx - SFx * dy) / l_dST;
+
+    //距离大于半径则不与无限长圆柱面相交
+    Floatx8 valid = l_FT <= R;
+    if (movemask(valid) == 0) return 0;
+
+    //计算与无限长圆柱面的交点
+    Floatx8 l_SF = sqrt(SFx * SFx + SFy * SFy);
+    Floatx8 t = sqrt(l_SF * l_SF - l_FT * l_FT) / l_dST;
+    Floatx8 right = R * R - l_FT * l_FT;
+    Floatx8 left = Floatx8(1.0f) - ray.d.y * ray.d.y;
+    Floatx8 delta = sqrt(right / left);
+    Floatx8 t1 = t - delta;
+    Floatx8 t2 = t + delta;
+    Floatx8 My = ray.o.y + ray.d.y * t1;
+    Floatx8 Ny = ray.o.y + ray.d.y * t2;
+
+    //交点方向相反
+    valid = valid & (t2 > err);
+
+    //击中点在侧面
+    Floatx8 side = valid & (My >= bottom) & (My <= top);
+    Floatx8 sideHit = side & (t1 > err) & (t1 < dist - err);
+
+    //击中点在下底面或上底面
+    Floatx8 rest = andNot(side, valid);
+    Floatx8 low = rest & (My < bottom) & (Ny >= bottom);
+    Floatx8 high = andNot(low, rest) & (My > top) & (Ny <= top);
+    Floatx8 m = (select(low, bottom, top) - ray.o.y) / ray.d.y;
+    Floatx8 capHit = (low | high) & (m < dist - err);
+
+    Floatx8 tt = select(side, t1, m);
+    Vector3fx8 P = ray.o + ray.d * tt;
+    Floatx8 nx = P.x - Floatx8(center.x), nz = P.z - Floatx8(center.z);
+    Floatx8 len = sqrt(nx * nx + nz * nz);
+    Vector3fx8 normal(select(side, nx / len, zero),
+                      select(side, zero, select(low, Floatx8(-1.0f), Floatx8(1.0f))),
+                      select(side, nz / len, zero));
+    return writeHits(hit, sideHit | capHit, tt, normal);
+}
+
+/*****************************************************
+ * 单条光线与光线包遍历BVH树：求交与config.cpp、simd.cpp中的原实现一致，
+ * 向量运算逐分量展开；与全局函数同名的函数调用时加命名空间限定，避免实参相关查找
+ *****************************************************/
+
+static GLfloat dot3(const Vector3f &a, const Vector3f &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static Vector3f sub3(const Vector3f &a, const Vector3f &b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static Vector3f cross3(const Vector3f &a, const Vector3f &b) {
+    return {a.y * b.z - a.z * b.y,
+            a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x};
+}
+
+static Vector3f normalize3(const Vector3f &a) {
+    GLfloat len = __builtin_sqrtf(dot3(a, a));
+    return {a.x / len, a.y / len, a.z / len};
+}
+
+static GLfloat hitAABB(const Ray &r, const Vector3f &AA, const Vector3f &BB) {
+    GLfloat t1 = INF, t2 = -INF;
+    const GLfloat *o = &r.startPoint.x, *d = &r.direction.x, *a = &AA.x, *b = &BB.x;
+    for (int i = 0; i < 3; i++) {
+        GLfloat m = (b[i] - o[i]) / d[i];
+        GLfloat n = (a[i] - o[i]) / d[i];
+        t1 = __builtin_fminf(t1, __builtin_fmaxf(m, n));
+        t2 = __builtin_fmaxf(t2, __builtin_fminf(m, n));
+    }
+    //起点位于盒内时进入距离记为0
+    if (t1 < t2 || t1 <= ERR) return -1.0f;
+    return t2 > 0.0f ? t2 : 0.0f;
+}
+
+static bool hitQuad(const Ray &r, const Vector3f *samples, HitInfo &hit) {
+    //求光线与平面交点
+    Vector3f n1 = sub3(samples[1], samples[0]);
+    Vector3f n2 = sub3(samples[2], samples[0]);
+    Vector3f normal = normalize3(cross3(n1, n2));
+    GLfloat d = -dot3(samples[0], normal);
+    GLfloat m = dot3(r.direction, normal);
+    if (m >= -ERR) return false; //剔除背向面
+    GLfloat t = -(d + dot3(r.startPoint, normal)) / m;
+    if (t <= ERR) return false; //剔除与自身相交的情况
+    Vector3f P = {r.startPoint.x + r.direction.x * t,
+                  r.startPoint.y + r.direction.y * t,
+                  r.startPoint.z + r.direction.z * t};
+
+    //根据叉乘与法矢量的方向关系判断是否在四边形内
+    Vector3f n3 = sub3(P, samples[0]);
+    Vector3f n4 = sub3(P, samples[1]);
+    Vector3f n5 = sub3(P, samples[2]);
+    GLfloat f1 = dot3(cross3(n1, n3), normal);
+    GLfloat f2 = dot3(cross3(n3, n2), normal);
+    GLfloat f3 = dot3(cross3(n5, n1), normal);
+    GLfloat f4 = dot3(cross3(n2, n4), normal);
+
+    if (f1 > -ERR && f2 > -ERR && f3 > -ERR && f4 > -ERR && t < hit.distance - ERR) {
+        hit.distance = t;
+        hit.hitPoint = P;
+        hit.normal = normal;
+        return true;
+    }
+    return false;
+}
+
+//光线包中各光线的向量与四个通道上广播的向量求点积
+static __m128 dot4(__m128 x, __m128 y, __m128 z, const Vector3f &v) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(v.x)), _mm_mul_ps(y, _mm_set1_ps(v.y))),
+                      _mm_mul_ps(z, _mm_set1_ps(v.z)));
+}
+
+//光线包与AABB包围盒求交，返回被击中且进入距离小于t的光线掩码
+static int hitAABB4(const RayPacket &p, const Vector3f &AA, const Vector3f &BB, __m128 t) {
+    __m128 mx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(BB.x), p.o.x), p.inv.x);
+    __m128 my = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(BB.y), p.o.y), p.inv.y);
+    __m128 mz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(BB.z), p.o.z), p.inv.z);
+    __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(AA.x), p.o.x), p.inv.x);
+    __m128 ny = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(AA.y), p.o.y), p.inv.y);
+    __m128 nz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(AA.z), p.o.z), p.inv.z);
+
+    __m128 t1 = _mm_min_ps(_mm_max_ps(mx, nx), _mm_min_ps(_mm_max_ps(my, ny), _mm_max_ps(mz, nz)));
+    __m128 t2 = _mm_max_ps(_mm_min_ps(mx, nx), _mm_max_ps(_mm_min_ps(my, ny), _mm_min_ps(mz, nz)));
+
+    //进入距离不大于离开距离，离开点在起点之后，且进入点不比已有交点远
+    __m128 mask = _mm_and_ps(_mm_cmpge_ps(t1, t2), _mm_cmpgt_ps(t1, _mm_set1_ps(ERR)));
+    mask = _mm_and_ps(mask, _mm_cmplt_ps(t2, t));
+    return _mm_movemask_ps(mask);
+}
+
+static int hitQuad4(const RayPacket &p, const Vector3f *samples, int index, __m128 &t, __m128i &idx) {
+    //每个四边形只计算一次法矢量及边界判定向量
+    Vector3f n1 = sub3(samples[1], samples[0]);
+    Vector3f n2 = sub3(samples[2], samples[0]);
+    Vector3f normal = normalize3(cross3(n1, n2));
+    Vector3f e1 = cross3(normal, n1), e2 = cross3(n2, normal), e3 = cross3(n1, normal), e4 = cross3(normal, n2);
+    __m128 err = _mm_set1_ps(ERR), nerr = _mm_set1_ps(-ERR);
+
+    //求光线与平面交点，剔除背向面与自身相交的情况
+    __m128 m = dot4(p.d.x, p.d.y, p.d.z, normal);
+    __m128 d = _mm_set1_ps(-dot3(samples[0], normal));
+    __m128 tt = _mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(d, dot4(p.o.x, p.o.y, p.o.z, normal))), m);
+    __m128 mask = _mm_and_ps(_mm_cmplt_ps(m, nerr), _mm_cmpgt_ps(tt, err));
+    mask = _mm_and_ps(mask, _mm_cmplt_ps(tt, _mm_sub_ps(t, err)));
+    if (_mm_movemask_ps(mask) == 0) return 0;
+
+    __m128 px = _mm_add_ps(p.o.x, _mm_mul_ps(p.d.x, tt));
+    __m128 py = _mm_add_ps(p.o.y, _mm_mul_ps(p.d.y, tt));
+    __m128 pz = _mm_add_ps(p.o.z, _mm_mul_ps(p.d.z, tt));
+
+    //与hitQuad中的四个叉乘判定等价：dot(cross(a, b), N) = dot(b, cross(N, a))
+    auto inside = [&](const Vector3f &s, const Vector3f &e) {
+        __m128 x = _mm_sub_ps(px, _mm_set1_ps(s.x));
+        __m128 y = _mm_sub_ps(py, _mm_set1_ps(s.y));
+        __m128 z = _mm_sub_ps(pz, _mm_set1_ps(s.z));
+        return _mm_cmpgt_ps(dot4(x, y, z, e), nerr);
+    };
+    mask = _mm_and_ps(mask, _mm_and_ps(inside(samples[0], e1), inside(samples[0], e2)));
+    mask = _mm_and_ps(mask, _mm_and_ps(inside(samples[2], e3), inside(samples[1], e4)));
+
+    t = _mm_or_ps(_mm_and_ps(mask, tt), _mm_andnot_ps(mask, t));
+    __m128i imask = _mm_castps_si128(mask);
+    idx = _mm_or_si128(_mm_and_si128(imask, _mm_set1_epi32(index)), _mm_andnot_si128(imask, idx));
+    return _mm_movemask_ps(mask);
+}
+
+//单条光线遍历BVH树，叶子结点的求交由leaf完成，返回是否更新了hit
+template <typename F>
+static bool traverse(const LinearNode *list, const Ray &r, HitInfo &hit, F &&leaf) {
+    if (list == nullptr) return false;
+    if (KERNEL_ISA::hitAABB(r, list[0].AA, list[0].BB) < 0.0f) return false;
+
+    int stack[64];
+    int p = 0;
+    bool ret = false;
+
+    stack[p++] = 0;
+    while (p > 0) {
+        const LinearNode &node = list[stack[--p]];
+
+        //叶子结点
+        if (node.ni.x > 0.0f) {
+            ret = leaf(node) || ret;
+            continue;
+        }
+
+        //与左右盒子求交，剔除比当前交点更远的盒子
+        int l = (int)node.lr.x, rr = (int)node.lr.y;
+        GLfloat t1 = -1.0f, t2 = -1.0f;
+        if (l >= 0) t1 = KERNEL_ISA::hitAABB(r, list[l].AA, list[l].BB);
+        if (rr >= 0) t2 = KERNEL_ISA::hitAABB(r, list[rr].AA, list[rr].BB);
+        if (t1 >= hit.distance) t1 = -1.0f;
+        if (t2 >= hit.distance) t2 = -1.0f;
+
+        //先搜索较近的盒子
+        if (t1 >= 0.0f && t2 >= 0.0f) {
+            if (t1 < t2) {
+                stack[p++] = rr;
+                stack[p++] = l;
+            } else {
+                stack[p++] = l;
+                stack[p++] = rr;
+            }
+        } else if (t1 >= 0.0f) {
+            stack[p++] = l;
+        } else if (t2 >= 0.0f) {
+            stack[p++] = rr;
+        }
+    }
+
+    return ret;
+}
+
+static bool hitBVH(const LinearNode *list, const Patch *patches, const Ray &r, HitInfo &hit) {
+    return traverse(list, r, hit, [&](const LinearNode &node) {
+        int n = (int)node.ni.x, m = (int)node.ni.y;
+        bool ret = false;
+        for (int i = m; i < m + n; i++)
+            ret = KERNEL_ISA::hitQuad(r, patches[i].samples, hit) || ret;
+        return ret;
+    });
+}
+
+static bool hitBVHBlocks(const LinearNode *list, const QuadBlock *blocks, const Ray &r, HitInfo &hit) {
+    return traverse(list, r, hit, [&](const LinearNode &node) {
+        int n = (int)node.ni.x, k = (int)node.ni.z;
+        bool ret = false;
+        for (int j = 0; j < n; j += KERNEL_WIDTH)
+            ret = KERNEL_ISA::hitQuadBlock(r, blocks[k++], hit) || ret;
+        return ret;
+    });
+}
+
+static int hitBVH4(const LinearNode *list, const Patch *patches, const RayPacket &p, __m128 &t, __m128i &idx) {
+    if (list == nullptr) return 0;
+
+    int stack[64];
+    int sp = 0, ret = 0;
+    const Vector3f &d = p.rays[0].direction;
+
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const LinearNode &node = list[stack[--sp]];
+
+        //包内所有光线都未击中该盒子时剪枝
+        if (hitAABB4(p, node.AA, node.BB, t) == 0) continue;
+
+        //叶子结点
+        int n = (int)node.ni.x;
+        if (n > 0) {
+            int m = (int)node.ni.y;
+            for (int i = m; i < m + n; i++)
+                ret |= KERNEL_ISA::hitQuad4(p, patches[i].samples, i, t, idx);
+            continue;
+        }
+
+        //光线包方向一致，按首条光线的方向先搜索较近的盒子
+        int l = (int)node.lr.x, r = (int)node.lr.y;
+        if (l >= 0 && r >= 0) {
+            Vector3f dist = sub3({list[l].AA.x + list[l].BB.x, list[l].AA.y + list[l].BB.y, list[l].AA.z + list[l].BB.z},
+                                 {list[r].AA.x + list[r].BB.x, list[r].AA.y + list[r].BB.y, list[r].AA.z + list[r].BB.z});
+            if (dot3(dist, d) > 0.0f) {
+                int tmp = l;
+                l = r;
+                r = tmp;
+            }
+            stack[sp++] = r;
+            stack[sp++] = l;
+        } else if (l >= 0) {
+            stack[sp++] = l;
+        } else if (r >= 0) {
+            stack[sp++] = r;
+        }
+    }
+
+    return ret;
+}
+
+extern const KernelTable table = {
+        KERNEL_STR(KERNEL_ISA),
+        hitQuad8,
+        hitSphere8,
+        hitCylinder8,
+        hitQuadBlock,
+        hitQuad4,
+        hitBVH,
+        hitBVHBlocks,
+        hitBVH4
+};
+
+}
@@ -0,0 +1,3 @@
+//SSE4.1版本的求交核函数，编译选项见CMakeLists.txt
+#define KERNEL_ISA sse4
+#include "kernel_impl.h"
@@ -0,0 +1,20 @@
+#include "simd.h"
+
+RayPacket::RayPacket(const Ray *r):
+        o(r[0].startPoint, r[1].startPoint, r[2].startPoint, r[3].startPoint),
+        d(r[0].direction, r[1].direction, r[2].direction, r[3].direction) {
+    for (int i = 0; i < PACKET_SIZE; i++) rays[i] = r[i];
+    __m128 one = _mm_set1_ps(1.0f);
+    inv = {_mm_div_ps(one, d.x), _mm_div_ps(one, d.y), _mm_div_ps(one, d.z)};
+}
+
+static inline int signs(const Vector3f &d) {
+    return (d.x < 0.0f) | (d.y < 0.0f) << 1 | (d.z < 0.0f) << 2;
+}
+
+bool coherent(const Ray *r) {
+    int s = signs(r[0].direction);
+    for (int i = 1; i < PACKET_SIZE; i++)
+        if (signs(r[i].direction) != s) return false;
+    return true;
+}
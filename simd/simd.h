@@ -0,0 +1,28 @@
+/********************************************
+ * 此文件定义了CPU端的SIMD光线包与求交函数
+ *******************************************/
+
+#pragma once
+
+#include <emmintrin.h>
+
+#include "config/config.h"
+
+#define PACKET_SIZE 4
+
+//四条光线组成的光线包（SoA布局）
+struct RayPacket {
+    Ray rays[PACKET_SIZE];
+    Vector3fx4 o;   //起点
+    Vector3fx4 d;   //方向
+    Vector3fx4 inv; //方向的倒数
+
+    explicit RayPacket(const Ray *r);
+};
+
+//光线包内各光线方向的符号是否一致（一致时适合整包遍历）
+bool coherent(const Ray *r);
+
+//光线包与四边形求交，与hitQuad一致；t与idx按光线记录最近交点及其编号，返回更新的光线掩码
+//按当前指令集调用simd/kernel_impl.h中的实现
+int hitQuad4(const RayPacket &p, const Vector3f *samples, int index, __m128 &t, __m128i &idx);
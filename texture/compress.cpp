@@ -0,0 +1,119 @@
+#include "compress.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+size_t bc1Size(GLsizei w, GLsizei h) {
+    return (size_t)((w + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE) *
+           ((h + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE) * BC1_BLOCK_BYTES;
+}
+
+//量化为RGB565，四舍五入
+static uint16_t pack565(const float c[3]) {
+    int r = (int)(std::min(std::max(c[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+    int g = (int)(std::min(std::max(c[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+    int b = (int)(std::min(std::max(c[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+//RGB565还原为8位颜色，与解码器一致
+static void unpack565(uint16_t c, int out[3]) {
+    int r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+    out[0] = r << 3 | r >> 2;
+    out[1] = g << 2 | g >> 4;
+    out[2] = b << 3 | b >> 2;
+}
+
+//编码一个块：沿颜色主轴取端点，再为每个像素选择最近的调色板颜色
+static void encodeBlock(const unsigned char px[16][3], unsigned char *dst) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++) mean[c] += px[i][c];
+    for (float &m : mean) m /= 16.0f;
+
+    //协方差矩阵：xx xy xz yy yz zz
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        float r = px[i][0] - mean[0], g = px[i][1] - mean[1], b = px[i][2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    //幂迭代求主轴
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int k = 0; k < 8; k++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (len < 1e-6f) break;
+        axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+    }
+    float norm = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    //像素在主轴上投影的范围确定两个端点
+    float t0 = 0.0f, t1 = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = ((px[i][0] - mean[0]) * axis[0] + (px[i][1] - mean[1]) * axis[1] +
+                   (px[i][2] - mean[2]) * axis[2]) / norm;
+        t0 = std::max(t0, t);
+        t1 = std::min(t1, t);
+    }
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; c++) {
+        e0[c] = mean[c] + axis[c] * t0;
+        e1[c] = mean[c] + axis[c] * t1;
+    }
+    uint16_t c0 = pack565(e0), c1 = pack565(e1);
+    //c0 > c1时为四色模式，相等时只能使用三色模式，全部取索引0
+    if (c0 < c1) std::swap(c0, c1);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][3];
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, best_dist = 1 << 30;
+            for (int j = 0; j < 4; j++) {
+                int dr = px[i][0] - palette[j][0], dg = px[i][1] - palette[j][1], db = px[i][2] - palette[j][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = j;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    //小端序：两个端点后跟按行排列的索引，每行一个字节
+    dst[0] = (unsigned char)(c0 & 0xFF);
+    dst[1] = (unsigned char)(c0 >> 8);
+    dst[2] = (unsigned char)(c1 & 0xFF);
+    dst[3] = (unsigned char)(c1 >> 8);
+    for (int i = 0; i < 4; i++) dst[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+void encodeBC1(const unsigned char *rgb, GLsizei w, GLsizei h, int y0, int y1, unsigned char *dst) {
+    int bw = (w + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE;
+    unsigned char px[16][3];
+    for (int by = y0; by < y1; by++) {
+        for (int bx = 0; bx < bw; bx++) {
+            for (int i = 0; i < 16; i++) {
+                int x = std::min(bx * BC1_BLOCK_SIZE + i % 4, w - 1);
+                int y = std::min(by * BC1_BLOCK_SIZE + i / 4, h - 1);
+                const unsigned char *p = rgb + ((size_t)y * w + x) * 3;
+                px[i][0] = p[0];
+                px[i][1] = p[1];
+                px[i][2] = p[2];
+            }
+            encodeBlock(px, dst + ((size_t)by * bw + bx) * BC1_BLOCK_BYTES);
+        }
+    }
+}
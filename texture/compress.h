@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include "GL/glew.h"
+
+//BC1（DXT1）块压缩：每个4×4像素块编码为两个RGB565端点与16个2位索引，共8字节
+#define BC1_BLOCK_SIZE 4
+#define BC1_BLOCK_BYTES 8
+
+//w×h图像压缩后的字节数，不足4像素的边缘按整块计算
+size_t bc1Size(GLsizei w, GLsizei h);
+
+//编码w×h的RGB图像（每像素3字节，紧密排列）中第y0至y1-1行的块，写入整幅图像的压缩数据dst
+//边缘不足4像素的块重复最后一行（列）像素，不同行的块可由多个线程并行编码
+void encodeBC1(const unsigned char *rgb, GLsizei w, GLsizei h, int y0, int y1, unsigned char *dst);
@@ -1,25 +1,306 @@
 #include "texture.h"
+#include "compress.h"
 
-Texture::Texture(const char *buf) {
-    FileLoader file(buf);
-    BmpLoader bl(file.buf);
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
 
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+//压缩缓存文件头，源文件的大小或修改时间变化后缓存失效
+#define CACHE_MAGIC 0x54314342 //"BC1T"
+#define CACHE_VERSION 1
+//并行压缩时每个任务编码的块行数
+#define ENCODE_BAND 16
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width, height;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+};
+
+static GLsizei levelCount(GLsizei w, GLsizei h) {
+    GLsizei n = 1;
+    while ((w | h) >> n) n++;
+    return n;
+}
+
+static GLsizei levelSize(GLsizei size, int level) {
+    return std::max(1, size >> level);
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, bl.format, bl.width, bl.height,
-                 0, bl.format, GL_UNSIGNED_BYTE, bl.textureData);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+//向上取整到块边界
+static GLsizei blockAlign(GLsizei size) {
+    return (size + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE * BC1_BLOCK_SIZE;
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+//w×h纹理的完整mipmap链中各层级压缩数据的偏移，末尾为总大小
+static std::vector<size_t> levelOffsets(GLsizei w, GLsizei h) {
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (int k = 0; k < levelCount(w, h); k++) {
+        offsets.push_back(offset);
+        offset += bc1Size(levelSize(w, k), levelSize(h, k));
+    }
+    offsets.push_back(offset);
+    return offsets;
+}
+
+TextureArray::~TextureArray() {
+    glDeleteTextures(1, &texture_id);
+    for (Layer &l : layers) glDeleteBuffers(1, &l.pbo);
 }
 
-Texture::~Texture() {
+void TextureArray::resize(GLsizei w, GLsizei h, GLsizei n) {
     glDeleteTextures(1, &texture_id);
+    width = w;
+    height = h;
+    levels = levelCount(w, h);
+    capacity = n;
+    glGenTextures(1, &texture_id);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, width, height, n);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TextureArray::upload(int i) {
+    const Layer &l = layers[i];
+    auto own = (int)l.offsets.size() - 1;
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, l.pbo);
+    //压缩纹理的子区域须按块对齐，或延伸到层级的边缘；纹理自身的mipmap链之后的层级重复最后一层
+    for (int k = 0; k < levels; k++) {
+        int src = std::min(k, own - 1);
+        GLsizei w = std::min(blockAlign(levelSize(l.width, k)), levelSize(width, k));
+        GLsizei h = std::min(blockAlign(levelSize(l.height, k)), levelSize(height, k));
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, k, 0, 0, i, w, h, 1, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                  (GLsizei)(l.offsets[src + 1] - l.offsets[src]), (const void *)l.offsets[src]);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+int TextureArray::addLayer(GLsizei w, GLsizei h, GLuint pbo, std::vector<size_t> &&offsets) {
+    layers.push_back({w, h, pbo, std::move(offsets)});
+    //层数按2的幂增长，尺寸取最大值，重新分配后上传所有层
+    auto n = (GLsizei)layers.size();
+    if (w > width || h > height || n > capacity) {
+        GLsizei count = std::max(capacity, 1);
+        while (count < n) count *= 2;
+        resize(std::max(w, width), std::max(h, height), count);
+        for (int i = 0; i < n; i++) upload(i);
+    } else {
+        upload(n - 1);
+    }
+    return n - 1;
+}
+
+Vector4f Texture::getUVTransform() const {
+    return {GLfloat(width) / GLfloat(array->getWidth()), GLfloat(height) / GLfloat(array->getHeight()), 0.0f, 0.0f};
+}
+
+//加载过程中在线程间传递的数据
+struct TextureUpload {
+    std::string path;
+    CacheHeader header{};
+    std::vector<std::vector<unsigned char>> pixels; //各mipmap层级的RGB像素，使用缓存时为空
+    std::vector<size_t> offsets;                    //压缩后的mipmap链中各层级的偏移
+    GLuint pbo{};
+    unsigned char *dst{};                           //映射的像素缓冲，压缩数据直接写入
+    std::atomic<int> remaining{};                   //未完成的压缩任务数
+};
+
+//检查压缩缓存是否与源文件匹配且完整，匹配时设置尺寸与各层级的偏移
+static bool checkCache(TextureUpload &upload) {
+    std::ifstream in(upload.path + ".bc1", std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    auto size = (size_t)in.tellg();
+    CacheHeader header{};
+    in.seekg(0);
+    if (!in.read((char *)&header, sizeof(header))) return false;
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        header.sourceSize != upload.header.sourceSize || header.sourceTime != upload.header.sourceTime)
+        return false;
+    std::vector<size_t> offsets = levelOffsets((GLsizei)header.width, (GLsizei)header.height);
+    if (size != sizeof(header) + offsets.back()) return false;
+
+    upload.header = header;
+    upload.offsets = std::move(offsets);
+    return true;
+}
+
+//将压缩缓存中的mipmap链读入像素缓冲
+static bool readCache(const TextureUpload &upload) {
+    std::ifstream in(upload.path + ".bc1", std::ios::binary);
+    in.seekg(sizeof(CacheHeader));
+    return (bool)in.read((char *)upload.dst, (std::streamsize)upload.offsets.back());
+}
+
+//写入压缩缓存：先写临时文件再改名，避免中断时留下不完整的缓存
+//数据从像素缓冲中读取，写合并内存读取较慢，但只顺序读一次
+static void writeCache(const TextureUpload &upload) {
+    std::string name = upload.path + ".bc1", tmp = name + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write((const char *)&upload.header, sizeof(upload.header));
+        out.write((const char *)upload.dst, (std::streamsize)upload.offsets.back());
+        if (!out) return;
+    }
+    std::remove(name.c_str());
+    std::rename(tmp.c_str(), name.c_str());
+}
+
+//2×2盒式滤波生成下一层mipmap，只在纹理自身的区域内取样，避免纹理数组中的空白区域混入
+static void downsample(const unsigned char *src, GLsizei w, GLsizei h, unsigned char *dst) {
+    GLsizei dw = levelSize(w, 1), dh = levelSize(h, 1);
+    for (int y = 0; y < dh; y++) {
+        const unsigned char *r0 = src + (size_t)w * 3 * std::min(2 * y, h - 1);
+        const unsigned char *r1 = src + (size_t)w * 3 * std::min(2 * y + 1, h - 1);
+        unsigned char *out = dst + (size_t)dw * 3 * y;
+        for (int x = 0; x < dw; x++) {
+            int x0 = std::min(2 * x, w - 1) * 3, x1 = std::min(2 * x + 1, w - 1) * 3;
+            for (int c = 0; c < 3; c++)
+                out[x * 3 + c] = (unsigned char)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) / 4);
+        }
+    }
 }
 
-void Texture::bind(int texture) const {
-    glActiveTexture(texture);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+//解析BMP文件，生成自下而上的紧密RGB像素及其mipmap链，失败时返回原因
+static const char *buildLevels(TextureUpload &upload) {
+    FileLoader file(upload.path.c_str());
+    BmpLoader bl(file);
+    if (bl.error != nullptr) return bl.error;
+    int channel = bl.format == GL_BGRA ? 4 : 3;
+    upload.header.width = (uint32_t)bl.width;
+    upload.header.height = (uint32_t)bl.height;
+    upload.offsets = levelOffsets(bl.width, bl.height);
+
+    auto levels = (int)upload.offsets.size() - 1;
+    upload.pixels.resize(levels);
+    std::vector<unsigned char> &base = upload.pixels[0];
+    base.resize((size_t)bl.width * bl.height * 3);
+    for (int y = 0; y < bl.height; y++) {
+        const char *row = bl.textureData + (size_t)(bl.topDown ? bl.height - 1 - y : y) * bl.stride;
+        unsigned char *out = base.data() + (size_t)y * bl.width * 3;
+        for (int x = 0; x < bl.width; x++) {
+            out[x * 3] = (unsigned char)row[x * channel + 2];
+            out[x * 3 + 1] = (unsigned char)row[x * channel + 1];
+            out[x * 3 + 2] = (unsigned char)row[x * channel];
+        }
+    }
+    for (int k = 1; k < levels; k++) {
+        upload.pixels[k].resize((size_t)levelSize(bl.width, k) * levelSize(bl.height, k) * 3);
+        downsample(upload.pixels[k - 1].data(), levelSize(bl.width, k - 1), levelSize(bl.height, k - 1),
+                   upload.pixels[k].data());
+    }
+    return nullptr;
+}
+
+//加载失败时在GL线程报告并释放已创建的像素缓冲，纹理保持未就绪，模型按无纹理绘制
+//工作线程中的失败同样投递到GL线程处理，不在工作线程中退出程序
+static void reportFailure(ThreadPool &pool, const std::shared_ptr<TextureUpload> &upload, const char *msg) {
+    pool.post([upload, msg]() {
+        std::cout << msg << " " << upload->path << std::endl;
+        if (upload->pbo != 0) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo);
+            if (upload->dst != nullptr) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &upload->pbo);
+        }
+        return false;
+    });
+}
+
+void Texture::load(ThreadPool &pool, TextureArray &textures, const std::string &path) {
+    auto upload = std::make_shared<TextureUpload>();
+    upload->path = path;
+    array = &textures;
+
+    //GL线程：解除映射，由像素缓冲上传到纹理数组
+    auto finish = [this, upload]() {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        width = (GLsizei)upload->header.width;
+        height = (GLsizei)upload->header.height;
+        layer = array->addLayer(width, height, upload->pbo, std::move(upload->offsets));
+        ready = true;
+        return true;
+    };
+
+    //工作线程：缓存有效时只读取尺寸，否则解析BMP文件并生成mipmap
+    pool.submit([&pool, upload, finish]() {
+        struct stat st{};
+        if (stat(upload->path.c_str(), &st) != 0) {
+            reportFailure(pool, upload, "Failed to open file!");
+            return;
+        }
+        upload->header = {CACHE_MAGIC, CACHE_VERSION, 0, 0, (uint64_t)st.st_size, (int64_t)st.st_mtime};
+        if (!checkCache(*upload)) {
+            const char *error = buildLevels(*upload);
+            if (error != nullptr) {
+                reportFailure(pool, upload, error);
+                return;
+            }
+        }
+
+        //GL线程：创建像素缓冲并映射
+        pool.post([&pool, upload, finish]() {
+            auto size = (GLsizeiptr)upload->offsets.back();
+            glGenBuffers(1, &upload->pbo);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STATIC_DRAW);
+            upload->dst = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            if (upload->dst == nullptr) {
+                reportFailure(pool, upload, "Failed to map pixel buffer!");
+                return false;
+            }
+
+            //工作线程：缓存直接读入像素缓冲
+            if (upload->pixels.empty()) {
+                pool.submit([&pool, upload, finish]() {
+                    if (!readCache(*upload)) {
+                        reportFailure(pool, upload, "Failed to read texture cache!");
+                        return;
+                    }
+                    pool.post(finish);
+                });
+                return false;
+            }
+
+            //工作线程：各层级按块行分段并行压缩到像素缓冲，最后完成的任务写入缓存并提交上传
+            std::vector<std::pair<int, int>> bands;
+            auto levels = (int)upload->offsets.size() - 1;
+            for (int k = 0; k < levels; k++) {
+                int rows = (levelSize((GLsizei)upload->header.height, k) + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE;
+                for (int y = 0; y < rows; y += ENCODE_BAND) bands.emplace_back(k, y);
+            }
+            upload->remaining = (int)bands.size();
+            for (auto band : bands) {
+                pool.submit([&pool, upload, finish, band]() {
+                    int k = band.first;
+                    auto w = (GLsizei)levelSize((GLsizei)upload->header.width, k);
+                    auto h = (GLsizei)levelSize((GLsizei)upload->header.height, k);
+                    int rows = (h + BC1_BLOCK_SIZE - 1) / BC1_BLOCK_SIZE;
+                    encodeBC1(upload->pixels[k].data(), w, h, band.second, std::min(band.second + ENCODE_BAND, rows),
+                              upload->dst + upload->offsets[k]);
+                    if (--upload->remaining > 0) return;
+
+                    upload->pixels.clear();
+                    writeCache(*upload);
+                    pool.post(finish);
+                });
+            }
+            return false;
+        });
+    });
 }
@@ -1,16 +1,65 @@
 #pragma once
 
+#include <vector>
+
 #include "GL/glew.h"
 
 #include "loader/loader.h"
+#include "loader/threadpool.h"
 
-class Texture {
+//纹理数组固定绑定的纹理单元，前18个纹理单元已被占用
+#define TEXTURE_ARRAY_UNIT 18
+
+//场景中所有纹理共用的二维纹理数组：每个纹理占一层，从层的左下角开始存放
+//纹理以BC1格式压缩存储，尺寸取所有纹理的最大值，加入更大的纹理时重新分配并重新上传已有的层
+class TextureArray {
 private:
+    //一层纹理的压缩数据，保留在像素缓冲中以便重新分配时由GL直接上传
+    struct Layer {
+        GLsizei width, height;
+        GLuint pbo;
+        std::vector<size_t> offsets; //各mipmap层级在像素缓冲中的偏移，末尾为总大小
+    };
+
     GLuint texture_id{};
+    GLsizei width{}, height{}, levels{}, capacity{};
+    std::vector<Layer> layers;
+
+    void resize(GLsizei w, GLsizei h, GLsizei n);
+    void upload(int i);
+
+public:
+    TextureArray() = default;
+    TextureArray(const TextureArray &) = delete;
+    ~TextureArray();
+
+    //加入w×h的纹理，由已解除映射的像素缓冲pbo上传其压缩的mipmap链，返回层号；之后pbo归纹理数组所有
+    int addLayer(GLsizei w, GLsizei h, GLuint pbo, std::vector<size_t> &&offsets);
+    GLuint getId() const {return texture_id;}
+    GLsizei getWidth() const {return width;}
+    GLsizei getHeight() const {return height;}
+    GLsizei getLevels() const {return levels;}
+};
+
+//纹理数组中的一层
+class Texture {
+private:
+    TextureArray *array{};
+    int layer = -1;
+    GLsizei width{}, height{};
+    bool ready = false;
 
 public:
-    explicit Texture(const char *buf);
-    ~Texture();
+    Texture() = default;
+    Texture(const Texture &) = delete;
+
+    //异步加载BMP文件：GL线程映射像素缓冲，工作线程将磁盘上的压缩缓存（path.bc1）读入其中，
+    //或生成mipmap并行压缩到其中并写入缓存，最后由GL线程从像素缓冲上传到纹理数组
+    void load(ThreadPool &pool, TextureArray &textures, const std::string &path);
+    //纹理数据是否已上传
+    bool isReady() const {return ready;}
 
-    void bind(int texture) const;
-};
\ No newline at end of file
+    int getLayer() const {return layer;}
+    //纹理坐标到纹理数组坐标的变换：xy为缩放，zw为偏移
+    Vector4f getUVTransform() const;
+};
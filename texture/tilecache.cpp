@@ -0,0 +1,219 @@
+#include "tilecache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+//分块文件头，源文件的大小或修改时间变化后重新生成
+#define TILES_MAGIC 0x454C4954 //"TILE"
+#define TILES_VERSION 1
+
+struct TilesHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width, height, tileSize;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+};
+
+//交错x、y的二进制位得到Morton码，相邻的分块在文件中也相邻
+static uint32_t morton(uint32_t x, uint32_t y) {
+    uint32_t code = 0;
+    for (int i = 0; i < 16; i++)
+        code |= (x >> i & 1u) << (2 * i) | (y >> i & 1u) << (2 * i + 1);
+    return code;
+}
+
+//按Morton码排序分块，得到每个分块在文件中的序号
+static std::vector<uint32_t> tileSlots(int tiles_x, int tiles_y) {
+    std::vector<uint32_t> order(tiles_x * tiles_y), slots(tiles_x * tiles_y);
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [tiles_x](uint32_t a, uint32_t b) {
+        return morton(a % tiles_x, a / tiles_x) < morton(b % tiles_x, b / tiles_x);
+    });
+    for (uint32_t i = 0; i < order.size(); i++) slots[order[i]] = i;
+    return slots;
+}
+
+//检查分块文件是否与源文件匹配
+static bool validTiles(const std::string &name, const TilesHeader &source) {
+    std::ifstream in(name, std::ios::binary);
+    TilesHeader header{};
+    if (!in || !in.read((char *)&header, sizeof(header))) return false;
+    return header.magic == TILES_MAGIC && header.version == TILES_VERSION && header.tileSize == TILE_SIZE &&
+           header.sourceSize == source.sourceSize && header.sourceTime == source.sourceTime;
+}
+
+//将BMP图像转换为分块文件：行自下而上，边缘不足一块的部分重复最后一行（列）像素
+//每次只生成一行分块并写到各自的Morton位置，内存占用与图像宽度成正比；失败时返回原因
+static const char *writeTiles(const std::string &path, const std::string &name, TilesHeader header) {
+    FileLoader file(path.c_str());
+    BmpLoader bl(file);
+    if (bl.error != nullptr) return bl.error;
+    int channel = bl.format == GL_BGRA ? 4 : 3;
+    header.width = (uint32_t)bl.width;
+    header.height = (uint32_t)bl.height;
+    int tiles_x = (bl.width + TILE_SIZE - 1) / TILE_SIZE, tiles_y = (bl.height + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<uint32_t> slots = tileSlots(tiles_x, tiles_y);
+
+    //先写临时文件再改名，避免中断时留下不完整的文件；多个线程可能同时转换同一图像，临时文件名各不相同
+    static std::atomic<unsigned> counter{};
+    std::string tmp = name + "." + std::to_string(counter++) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write((const char *)&header, sizeof(header));
+        std::vector<unsigned char> row((size_t)tiles_x * TILE_BYTES);
+        for (int ty = 0; ty < tiles_y && out; ty++) {
+            for (int tx = 0; tx < tiles_x; tx++) {
+                unsigned char *tile = row.data() + (size_t)tx * TILE_BYTES;
+                for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++) {
+                    int x = std::min(tx * TILE_SIZE + i % TILE_SIZE, bl.width - 1);
+                    int y = std::min(ty * TILE_SIZE + i / TILE_SIZE, bl.height - 1);
+                    const char *p = bl.textureData + (size_t)(bl.topDown ? bl.height - 1 - y : y) * bl.stride
+                                    + (size_t)x * channel;
+                    tile[i * 3] = (unsigned char)p[2];
+                    tile[i * 3 + 1] = (unsigned char)p[1];
+                    tile[i * 3 + 2] = (unsigned char)p[0];
+                }
+                out.seekp((std::streamoff)(sizeof(header) + (size_t)slots[ty * tiles_x + tx] * TILE_BYTES));
+                out.write((const char *)tile, TILE_BYTES);
+            }
+        }
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return "Failed to write tiled texture!";
+        }
+    }
+    std::remove(name.c_str());
+    if (std::rename(tmp.c_str(), name.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        //其他线程同时转换了同一图像时，已就位的文件同样可用
+        if (!validTiles(name, header)) return "Failed to rename tiled texture!";
+    }
+    return nullptr;
+}
+
+TileCache::TileCache(size_t budget): budget(std::max(budget, (size_t)TILE_BYTES)) {}
+
+TileCache::~TileCache() {
+    for (TiledImage &image : images) delete image.file;
+}
+
+int TileCache::open(const std::string &path, const char **error) {
+    //失败时不退出程序，由调用者（可能是工作线程）决定如何处理
+    auto fail = [error](const char *msg) {
+        if (error != nullptr) *error = msg;
+        return -1;
+    };
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) return fail("Failed to open file!");
+    TilesHeader header = {TILES_MAGIC, TILES_VERSION, 0, 0, TILE_SIZE, (uint64_t)st.st_size, (int64_t)st.st_mtime};
+    std::string name = path + ".tiles";
+
+    //转换耗时较长，不持有锁，其他线程的采样不受影响
+    if (!validTiles(name, header)) {
+        const char *msg = writeTiles(path, name, header);
+        if (msg != nullptr) return fail(msg);
+    }
+
+    //分块文件只映射不读入，分块在采样时才复制到缓存中
+    TiledImage image{};
+    image.file = new FileLoader(name.c_str());
+    if (image.file->error != nullptr || image.file->getSize() < sizeof(TilesHeader)) {
+        const char *msg = image.file->error != nullptr ? image.file->error : "Invalid tiled texture!";
+        delete image.file;
+        return fail(msg);
+    }
+    header = *(const TilesHeader *)image.file->buf;
+    image.data = image.file->buf + sizeof(TilesHeader);
+    image.width = (GLsizei)header.width;
+    image.height = (GLsizei)header.height;
+    image.tilesX = (image.width + TILE_SIZE - 1) / TILE_SIZE;
+    image.tilesY = (image.height + TILE_SIZE - 1) / TILE_SIZE;
+    image.slots = tileSlots(image.tilesX, image.tilesY);
+    if (image.file->getSize() < sizeof(TilesHeader) + (size_t)image.tilesX * image.tilesY * TILE_BYTES) {
+        delete image.file;
+        return fail("Invalid tiled texture!");
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    images.push_back(std::move(image));
+    return (int)images.size() - 1;
+}
+
+const unsigned char *TileCache::tile(int image, int tx, int ty) {
+    const TiledImage &img = images[image];
+    uint32_t slot = img.slots[ty * img.tilesX + tx];
+    uint64_t key = (uint64_t)image << 32 | slot;
+
+    auto it = tiles.find(key);
+    if (it != tiles.end()) {
+        hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->texels.data();
+    }
+    misses++;
+
+    //超出预算时复用最久未使用的分块
+    if (used + TILE_BYTES > budget && !lru.empty()) {
+        lru.splice(lru.begin(), lru, std::prev(lru.end()));
+        tiles.erase(lru.front().key);
+    } else {
+        lru.push_front({0, std::vector<unsigned char>(TILE_BYTES)});
+        used += TILE_BYTES;
+    }
+    Tile &t = lru.front();
+    t.key = key;
+    memcpy(t.texels.data(), img.data + (size_t)slot * TILE_BYTES, TILE_BYTES);
+    tiles[key] = lru.begin();
+    return t.texels.data();
+}
+
+Vector3f TileCache::texel(int image, int x, int y) {
+    const unsigned char *p = tile(image, x / TILE_SIZE, y / TILE_SIZE)
+                             + ((y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE) * 3;
+    return {p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f};
+}
+
+Vector3f TileCache::fetch(int image, int x, int y) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const TiledImage &img = images[image];
+    return texel(image, std::min(std::max(x, 0), img.width - 1), std::min(std::max(y, 0), img.height - 1));
+}
+
+Vector3f TileCache::sample(int image, Vector2f uv) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const TiledImage &img = images[image];
+    GLfloat x = (uv.x - std::floor(uv.x)) * GLfloat(img.width) - 0.5f;
+    GLfloat y = (uv.y - std::floor(uv.y)) * GLfloat(img.height) - 0.5f;
+    GLfloat fx = x - std::floor(x), fy = y - std::floor(y);
+    int x0 = ((int)std::floor(x) + img.width) % img.width, x1 = (x0 + 1) % img.width;
+    int y0 = ((int)std::floor(y) + img.height) % img.height, y1 = (y0 + 1) % img.height;
+
+    Vector3f c00 = texel(image, x0, y0), c10 = texel(image, x1, y0);
+    Vector3f c01 = texel(image, x0, y1), c11 = texel(image, x1, y1);
+    return (c00 * (1.0f - fx) + c10 * fx) * (1.0f - fy) + (c01 * (1.0f - fx) + c11 * fx) * fy;
+}
+
+GLsizei TileCache::getWidth(int image) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return images[image].width;
+}
+
+GLsizei TileCache::getHeight(int image) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return images[image].height;
+}
+
+void TileCache::resetStats() {
+    hits = 0;
+    misses = 0;
+}
+
+size_t TileCache::getUsed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
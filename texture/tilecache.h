@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "loader/loader.h"
+
+//分块边长（像素），每块按RGB紧密存放
+#define TILE_SIZE 32
+#define TILE_BYTES (TILE_SIZE * TILE_SIZE * 3)
+
+//CPU端采样纹理使用的分块缓存：图像转换为按Morton序存放分块的磁盘文件（path.tiles），
+//采样时按需读入分块，所有图像共用一个内存预算，超出时淘汰最久未使用的分块，可多线程访问
+class TileCache {
+private:
+    struct TiledImage {
+        FileLoader *file;
+        const char *data;          //第一个分块在文件映射中的位置
+        GLsizei width, height;
+        int tilesX, tilesY;
+        std::vector<uint32_t> slots; //按行排列的分块在文件中的序号
+    };
+
+    struct Tile {
+        uint64_t key;
+        std::vector<unsigned char> texels;
+    };
+
+    size_t budget, used{};
+    mutable std::mutex mutex; //保护images与分块缓存，open()可能在其他线程中扩充images
+    std::vector<TiledImage> images;
+    std::list<Tile> lru; //表头为最近使用的分块
+    std::unordered_map<uint64_t, std::list<Tile>::iterator> tiles;
+    std::atomic<uint64_t> hits{}, misses{};
+
+    //取得分块的像素，未命中时从文件读入，调用时须持有锁
+    const unsigned char *tile(int image, int tx, int ty);
+    //读取一个像素，坐标已限制在图像内，调用时须持有锁
+    Vector3f texel(int image, int x, int y);
+
+public:
+    //budget为分块占用内存的上限（字节）
+    explicit TileCache(size_t budget);
+    TileCache(const TileCache &) = delete;
+    ~TileCache();
+
+    //打开BMP图像，分块文件不存在或已过期时重新生成，返回图像编号
+    //失败时返回-1，error不为空时写入原因
+    int open(const std::string &path, const char **error = nullptr);
+    //读取一个像素，坐标超出范围时取边缘，颜色范围为0到1
+    Vector3f fetch(int image, int x, int y);
+    //双线性采样，纹理坐标按重复方式环绕，与着色器一致
+    Vector3f sample(int image, Vector2f uv);
+
+    GLsizei getWidth(int image) const;
+    GLsizei getHeight(int image) const;
+    //命中与未命中次数
+    uint64_t getHits() const {return hits;}
+    uint64_t getMisses() const {return misses;}
+    void resetStats();
+    //当前驻留分块占用的内存
+    size_t getUsed();
+};